@@ -0,0 +1,343 @@
+/**
+ * @file    compact_decoder.c
+ * @brief   下位机侧上位机数据接收参考实现:V2分帧 + 压缩编码协商与解码
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    线上格式: | 0x00 | COBS( 消息ID | 序号 | 长度 | 数据 | CRC16(CCITT-FALSE,小端) ) | 0x00 |,多字节字段均为小端
+ */
+
+#include "compact_decoder.h"
+
+#include <string.h>
+
+/* CRC-16/CCITT-FALSE,按位计算,下位机有查表或硬件CRC时可替换 */
+static uint16_t Crc16(const uint8_t* data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+    size_t   i;
+    int      bit;
+
+    for (i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)((uint16_t)data[i] << 8);
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/* COBS原地解码,数据不合法时返回0 */
+static size_t CobsDecode(uint8_t* data, size_t len)
+{
+    size_t pos = 0;
+    size_t n   = 0;
+
+    while (pos < len)
+    {
+        size_t code = data[pos];
+        if (code == 0 || pos + code > len)
+        {
+            return 0;
+        }
+
+        memmove(&data[n], &data[pos + 1], code - 1);
+        n += code - 1;
+        pos += code;
+
+        if (code != 0xFF && pos < len)
+        {
+            data[n++] = 0;
+        }
+    }
+
+    return n;
+}
+
+static size_t CobsEncode(const uint8_t* in, size_t len, uint8_t* out)
+{
+    size_t code = 0;
+    size_t pos  = 1;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code] = (uint8_t)(pos - code);
+            code      = pos++;
+            continue;
+        }
+
+        out[pos++] = in[i];
+        if (pos - code == 0xFF)
+        {
+            out[code] = 0xFF;
+            code      = pos++;
+        }
+    }
+    out[code] = (uint8_t)(pos - code);
+
+    return pos;
+}
+
+static float ReadFloat(const uint8_t* p)
+{
+    uint32_t raw = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    float    value;
+    memcpy(&value, &raw, sizeof(value));
+    return value;
+}
+
+static void WriteFloat(uint8_t* p, float value)
+{
+    uint32_t raw;
+    memcpy(&raw, &value, sizeof(raw));
+    p[0] = (uint8_t)raw;
+    p[1] = (uint8_t)(raw >> 8);
+    p[2] = (uint8_t)(raw >> 16);
+    p[3] = (uint8_t)(raw >> 24);
+}
+
+static void Dequantize(const CompactRx* rx, CompactTarget* target)
+{
+    target->pitch    = (float)rx->pitch * rx->angle_step;
+    target->yaw      = (float)rx->yaw * rx->angle_step;
+    target->distance = (float)rx->distance * rx->distance_step;
+}
+
+/* 处理一条校验通过的消息 */
+static CompactEvent Handle(CompactRx* rx, uint8_t id, const uint8_t* payload, uint8_t length, CompactTarget* target)
+{
+    switch (id)
+    {
+    case COMPACT_MSG_HOST:
+        if (length < 12)
+        {
+            return COMPACT_EVENT_NONE;
+        }
+        target->pitch    = ReadFloat(&payload[0]);
+        target->yaw      = ReadFloat(&payload[4]);
+        target->distance = ReadFloat(&payload[8]);
+        return COMPACT_EVENT_TARGET;
+
+    case COMPACT_MSG_OFFER:
+        if (length < 10 || payload[0] != COMPACT_VERSION)
+        {
+            rx->reply_version = 0;
+            return COMPACT_EVENT_REPLY;
+        }
+        rx->angle_step        = ReadFloat(&payload[1]);
+        rx->distance_step     = ReadFloat(&payload[5]);
+        rx->keyframe_interval = payload[9];
+        rx->negotiated        = 1;
+        rx->valid             = 0;
+        rx->reply_version     = COMPACT_VERSION;
+        return COMPACT_EVENT_REPLY;
+
+    case COMPACT_MSG_KEY:
+        if (!rx->negotiated)
+        {
+            rx->reply_version = 0;
+            return COMPACT_EVENT_REPLY;
+        }
+        if (length < 6)
+        {
+            return COMPACT_EVENT_NONE;
+        }
+        rx->pitch    = (int16_t)(payload[0] | (payload[1] << 8));
+        rx->yaw      = (int16_t)(payload[2] | (payload[3] << 8));
+        rx->distance = (uint16_t)(payload[4] | (payload[5] << 8));
+        rx->valid    = 1;
+        Dequantize(rx, target);
+        return COMPACT_EVENT_TARGET;
+
+    case COMPACT_MSG_DELTA:
+        if (!rx->negotiated)
+        {
+            rx->reply_version = 0;
+            return COMPACT_EVENT_REPLY;
+        }
+        if (length < 3)
+        {
+            return COMPACT_EVENT_NONE;
+        }
+        /* 没有基准或中间丢过帧(在Compact_FeedByte中检查):等待下一个关键帧 */
+        if (!rx->valid)
+        {
+            rx->rejected++;
+            return COMPACT_EVENT_NONE;
+        }
+        rx->pitch    = (int16_t)(rx->pitch + (int8_t)payload[0]);
+        rx->yaw      = (int16_t)(rx->yaw + (int8_t)payload[1]);
+        rx->distance = (uint16_t)(rx->distance + (int8_t)payload[2]);
+        Dequantize(rx, target);
+        return COMPACT_EVENT_TARGET;
+
+    case COMPACT_MSG_PING:
+        if (length < 8 || rx->clock_us == NULL)
+        {
+            return COMPACT_EVENT_NONE;
+        }
+        memcpy(rx->ping_host, payload, 8);
+        return COMPACT_EVENT_PING;
+
+    default:
+        return COMPACT_EVENT_NONE;
+    }
+}
+
+/**
+ * @brief Compact_Init 初始化,上电后未协商,只接受完整帧
+ */
+void Compact_Init(CompactRx* rx)
+{
+    memset(rx, 0, sizeof(*rx));
+}
+
+/**
+ * @brief Compact_SetClock 设置时钟,之后响应上位机的时钟同步请求
+ * @param clock_us         返回32位微秒计数(如定时器计数),可在中断中调用
+ */
+void Compact_SetClock(CompactRx* rx, uint32_t (*clock_us)(void))
+{
+    rx->clock_us = clock_us;
+}
+
+/**
+ * @brief Compact_BuildReply 组协商回复 | 版本 | angle_step | distance_step | keyframe_interval |,版本为0时表示拒绝
+ * @param seq                发送序号,取下位机V2发送计数器的当前值(与数据帧共用)
+ * @param reply              至少COMPACT_REPLY_MAX字节
+ * @return                   回复帧长度
+ * @note                     在Compact_FeedByte返回COMPACT_EVENT_REPLY后调用
+ */
+size_t Compact_BuildReply(const CompactRx* rx, uint8_t seq, uint8_t* reply)
+{
+    uint8_t  raw[3 + 10 + 2];
+    uint16_t crc;
+    size_t   n;
+
+    raw[0] = COMPACT_MSG_ACCEPT;
+    raw[1] = seq;
+    raw[2] = 10;
+    raw[3] = rx->reply_version;
+    WriteFloat(&raw[4], rx->angle_step);
+    WriteFloat(&raw[8], rx->distance_step);
+    raw[12] = rx->keyframe_interval;
+
+    crc     = Crc16(raw, 13);
+    raw[13] = (uint8_t)crc;
+    raw[14] = (uint8_t)(crc >> 8);
+
+    n            = CobsEncode(raw, sizeof(raw), &reply[1]);
+    reply[0]     = 0x00;
+    reply[n + 1] = 0x00;
+
+    return n + 2;
+}
+
+/**
+ * @brief Compact_BuildPong 组时钟同步回复 | 主机时刻 | t2 | t3 |,t3取调用时刻
+ * @param seq               发送序号,取下位机V2发送计数器的当前值(与数据帧共用)
+ * @param reply             至少COMPACT_REPLY_MAX字节
+ * @return                  回复帧长度
+ * @note                    在Compact_FeedByte返回COMPACT_EVENT_PING后、真正发送之前调用,
+ *                          调用与发出之间的时间会被上位机算作下行延迟
+ */
+size_t Compact_BuildPong(const CompactRx* rx, uint8_t seq, uint8_t* reply)
+{
+    uint8_t  raw[3 + 16 + 2];
+    uint32_t tx_us = rx->clock_us();
+    uint16_t crc;
+    size_t   n;
+
+    raw[0] = COMPACT_MSG_PONG;
+    raw[1] = seq;
+    raw[2] = 16;
+    memcpy(&raw[3], rx->ping_host, 8);
+    raw[11] = (uint8_t)rx->ping_rx_us;
+    raw[12] = (uint8_t)(rx->ping_rx_us >> 8);
+    raw[13] = (uint8_t)(rx->ping_rx_us >> 16);
+    raw[14] = (uint8_t)(rx->ping_rx_us >> 24);
+    raw[15] = (uint8_t)tx_us;
+    raw[16] = (uint8_t)(tx_us >> 8);
+    raw[17] = (uint8_t)(tx_us >> 16);
+    raw[18] = (uint8_t)(tx_us >> 24);
+
+    crc     = Crc16(raw, 19);
+    raw[19] = (uint8_t)crc;
+    raw[20] = (uint8_t)(crc >> 8);
+
+    n            = CobsEncode(raw, sizeof(raw), &reply[1]);
+    reply[0]     = 0x00;
+    reply[n + 1] = 0x00;
+
+    return n + 2;
+}
+
+/**
+ * @brief Compact_FeedByte 输入一个接收到的字节
+ * @param target           返回COMPACT_EVENT_TARGET时为新目标
+ * @return                 事件
+ * @note                   只在收到帧边界0x00时做解码与校验,其余字节只是存入缓冲区,可在接收中断中调用
+ */
+CompactEvent Compact_FeedByte(CompactRx* rx, uint8_t byte, CompactTarget* target)
+{
+    size_t   n;
+    uint16_t crc;
+
+    if (byte != 0x00)
+    {
+        if (rx->len < COMPACT_RX_BUF_SIZE)
+        {
+            rx->buf[rx->len++] = byte;
+        }
+        else
+        {
+            rx->overflow = 1;
+        }
+        return COMPACT_EVENT_NONE;
+    }
+
+    /* 帧边界:两个帧边界之间为空(相邻两帧)或超长时直接丢弃 */
+    if (rx->len == 0 || rx->overflow)
+    {
+        rx->len      = 0;
+        rx->overflow = 0;
+        return COMPACT_EVENT_NONE;
+    }
+
+    n       = CobsDecode(rx->buf, rx->len);
+    rx->len = 0;
+    if (n < 5 || n != (size_t)rx->buf[2] + 5)
+    {
+        rx->crc_errors++;
+        return COMPACT_EVENT_NONE;
+    }
+
+    crc = (uint16_t)(rx->buf[n - 2] | (rx->buf[n - 1] << 8));
+    if (crc != Crc16(rx->buf, n - 2))
+    {
+        rx->crc_errors++;
+        return COMPACT_EVENT_NONE;
+    }
+
+    rx->frames++;
+
+    /* 与上一条消息序号不连续:中间丢过帧,差分基准失效 */
+    if (rx->buf[1] != (uint8_t)(rx->last_seq + 1))
+    {
+        rx->valid = 0;
+    }
+    rx->last_seq = rx->buf[1];
+
+    if (rx->buf[0] == COMPACT_MSG_PING && rx->clock_us != NULL)
+    {
+        rx->ping_rx_us = rx->clock_us();
+    }
+
+    return Handle(rx, rx->buf[0], &rx->buf[3], rx->buf[2], target);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file    compact_decoder.h
+ * @brief   下位机侧上位机数据接收参考实现:V2分帧 + 压缩编码协商与解码(C99,无动态内存,无外部依赖)
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    与上位机 串口/SerialPort/CompactCodec.h 对应,移植到下位机时只需把串口接收到的每个字节交给Compact_FeedByte:
+ *          - 收到V2_MSG_HOST(完整帧)、V2_MSG_HOST_KEY(关键帧)、可用的V2_MSG_HOST_DELTA(差分帧)时输出新目标;
+ *          - 收到V2_MSG_COMPACT_OFFER时记下参数,调用者用Compact_BuildReply组同意回复并通过串口发出;
+ *          - 未协商(如刚上电)却收到差分/关键帧时同样要求回复(拒绝),上位机据此退回完整帧并重新协商;
+ *          - 收到V2_MSG_PING时记下请求与收到的时刻,调用者在真正发送前用Compact_BuildPong组回复(t3取发送时刻)。
+ *          差分帧只在序号与上一条消息(任何类型)连续时应用,否则丢弃并等待下一个关键帧。
+ *          上位机的时钟同步请求夹在压缩帧之间并占用同一个序号,因此连续性按全部消息判断。
+ *          回复帧不自带发送序号,由调用者传入下位机V2发送计数器的当前值(与数据帧共用),
+ *          否则上位机按序号统计丢帧时会把每条回复算成一段很长的缺口
+ */
+
+#ifndef COMPACT_DECODER_H
+#define COMPACT_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define COMPACT_RX_BUF_SIZE 64  /* 两个帧边界之间最多保留的字节数,更长的帧不是上位机数据,直接丢弃 */
+#define COMPACT_REPLY_MAX   24  /* 回复帧(协商/时钟同步)的最大长度 */
+
+#define COMPACT_MSG_HOST   0x02
+#define COMPACT_MSG_OFFER  0x03
+#define COMPACT_MSG_ACCEPT 0x04
+#define COMPACT_MSG_KEY    0x05
+#define COMPACT_MSG_DELTA  0x06
+#define COMPACT_MSG_PING   0x07
+#define COMPACT_MSG_PONG   0x08
+
+#define COMPACT_VERSION 1
+
+typedef enum
+{
+    COMPACT_EVENT_NONE   = 0, /* 没有新结果 */
+    COMPACT_EVENT_TARGET = 1, /* target已更新 */
+    COMPACT_EVENT_REPLY  = 2, /* 需要回复协商结果,调用Compact_BuildReply并发送 */
+    COMPACT_EVENT_PING   = 3  /* 收到时钟同步请求,尽快调用Compact_BuildPong并发送 */
+} CompactEvent;
+
+typedef struct
+{
+    float pitch;
+    float yaw;
+    float distance; /* mm */
+} CompactTarget;
+
+typedef struct
+{
+    /* 分帧 */
+    uint8_t buf[COMPACT_RX_BUF_SIZE];
+    size_t  len;
+    uint8_t overflow;
+
+    /* 协商结果 */
+    uint8_t negotiated;
+    float   angle_step;
+    float   distance_step;
+    uint8_t keyframe_interval;
+
+    /* 差分基准 */
+    uint8_t  valid;
+    uint8_t  last_seq;
+    int16_t  pitch;
+    int16_t  yaw;
+    uint16_t distance;
+
+    /* 时钟同步 */
+    uint32_t (*clock_us)(void); /* 32位微秒计数,为NULL时忽略请求 */
+    uint8_t  ping_host[8];      /* 请求中的主机时刻,原样返回 */
+    uint32_t ping_rx_us;        /* 收到请求(帧边界)的时刻 */
+
+    uint8_t reply_version; /* 待回复的协商结果,0表示拒绝 */
+
+    /* 统计 */
+    uint32_t frames;
+    uint32_t crc_errors;
+    uint32_t rejected;
+} CompactRx;
+
+void         Compact_Init(CompactRx* rx);
+void         Compact_SetClock(CompactRx* rx, uint32_t (*clock_us)(void));
+CompactEvent Compact_FeedByte(CompactRx* rx, uint8_t byte, CompactTarget* target);
+size_t       Compact_BuildReply(const CompactRx* rx, uint8_t seq, uint8_t* reply);
+size_t       Compact_BuildPong(const CompactRx* rx, uint8_t seq, uint8_t* reply);
+
+#endif /* COMPACT_DECODER_H */
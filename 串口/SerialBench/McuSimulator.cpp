@@ -0,0 +1,434 @@
+/**
+ * @file    McuSimulator.cpp
+ * @brief   基于伪终端(openpty)的下位机模拟器
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "McuSimulator.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <random>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SIM_SPLIT_GAP_NS 50000    ///拆分写入时两段之间的间隔
+#define SIM_STALL_NS     20000000  ///接收线程暂停读取的时长
+
+static std::atomic<int64_t> simClockOffsetUs(0);  ///<DeviceClockUs的偏差,下位机参考实现的时钟回调没有上下文参数
+
+McuSimulator::McuSimulator(const McuSimConfig& config)
+    : config(config), master(-1), slave(-1), running(false), finished(false), sentTime(config.frames), framesSent(0), framesCorrupted(0), hostFramesOk(0), hostFramesBad(0), pongsSent(0), txSeq(0), compactRejected(0)
+{
+    Compact_Init(&compactRx);
+    Compact_SetClock(&compactRx, DeviceClockUs);
+    simClockOffsetUs.store(config.clockOffsetUs);
+    for (size_t i = 0; i < sentTime.size(); i++)
+    {
+        sentTime[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+McuSimulator::~McuSimulator()
+{
+    Stop();
+
+    if (slave != -1)
+    {
+        close(slave);
+    }
+    if (master != -1)
+    {
+        close(master);
+    }
+}
+
+/**
+ * @brief Open 创建伪终端
+ * @return     是否成功
+ */
+bool McuSimulator::Open()
+{
+    char name[128];
+    if (openpty(&master, &slave, name, NULL, NULL) == -1)
+    {
+        return false;
+    }
+    slaveName = name;
+
+    ///主端原始模式,字节不做任何转换
+    struct termios options;
+    tcgetattr(master, &options);
+    cfmakeraw(&options);
+    tcsetattr(master, TCSANOW, &options);
+
+    return true;
+}
+
+const char* McuSimulator::SlaveName() const
+{
+    return slaveName.c_str();
+}
+
+void McuSimulator::Start()
+{
+    running.store(true);
+    txThread = std::thread(&McuSimulator::TxLoop, this);
+    rxThread = std::thread(&McuSimulator::RxLoop, this);
+}
+
+void McuSimulator::Stop()
+{
+    running.store(false);
+
+    if (txThread.joinable())
+    {
+        txThread.join();
+    }
+    if (rxThread.joinable())
+    {
+        rxThread.join();
+    }
+}
+
+/**
+ * @brief Finished 是否已发送完全部帧
+ */
+bool McuSimulator::Finished() const
+{
+    return finished.load();
+}
+
+/**
+ * @brief SentTime 帧序号对应的发送时刻
+ * @param seq      帧序号
+ * @return         CLOCK_MONOTONIC时间(ns),未发送时返回0
+ */
+int64_t McuSimulator::SentTime(uint32_t seq) const
+{
+    if (seq >= sentTime.size())
+    {
+        return 0;
+    }
+    return sentTime[seq].load(std::memory_order_acquire);
+}
+
+uint32_t McuSimulator::FramesSent() const
+{
+    return framesSent.load();
+}
+
+uint32_t McuSimulator::FramesCorrupted() const
+{
+    return framesCorrupted.load();
+}
+
+uint32_t McuSimulator::HostFramesOk() const
+{
+    return hostFramesOk.load();
+}
+
+uint32_t McuSimulator::HostFramesBad() const
+{
+    return hostFramesBad.load();
+}
+
+uint32_t McuSimulator::CompactRejected() const
+{
+    return compactRejected.load();
+}
+
+uint32_t McuSimulator::PongsSent() const
+{
+    return pongsSent.load();
+}
+
+int64_t McuSimulator::NowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief DeviceClockUs 模拟的下位机32位微秒时钟
+ */
+uint32_t McuSimulator::DeviceClockUs()
+{
+    return static_cast<uint32_t>(NowNs() / 1000 + simClockOffsetUs.load(std::memory_order_relaxed));
+}
+
+void McuSimulator::WriteAll(const unsigned char* data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = write(master, data, len);
+        if (n > 0)
+        {
+            data += n;
+            len -= static_cast<size_t>(n);
+        }
+        else if (n == -1 && errno != EINTR && errno != EAGAIN)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief TxLoop 按绝对时刻定时发送下位机数据帧
+ */
+void McuSimulator::TxLoop()
+{
+    std::mt19937                           rng(config.seed);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    int64_t period = static_cast<int64_t>(1e9 / config.rateHz);
+    int64_t next   = NowNs();
+
+    for (uint32_t seq = 0; seq < config.frames && running.load(); seq++)
+    {
+        next += period;
+        struct timespec ts;
+        ts.tv_sec  = next / 1000000000LL;
+        ts.tv_nsec = next % 1000000000LL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+        std::lock_guard<std::mutex> lock(writeLock);
+
+        ///噪声
+        if (chance(rng) < config.noiseRatio && config.noiseBytes > 0)
+        {
+            unsigned char noise[64];
+            int           n = 1 + static_cast<int>(rng() % static_cast<uint32_t>(config.noiseBytes < 64 ? config.noiseBytes : 64));
+            for (int i = 0; i < n; i++)
+            {
+                noise[i] = static_cast<unsigned char>(rng());
+            }
+            WriteAll(noise, static_cast<size_t>(n));
+        }
+
+        ///组帧,gain_yaw写入帧序号
+        GroundChassisData data;
+        memset(&data, 0, sizeof(data));
+        data.gain_yaw.f   = static_cast<float>(seq);
+        data.gain_pitch.f = static_cast<float>(seq % 360) * 0.5f;
+        data.mode         = static_cast<unsigned char>(seq % 4);
+        data.color        = static_cast<unsigned char>(seq % 2);
+        data.speed        = 15;
+
+        unsigned char frame[V2_MAX_FRAME];
+        size_t        len = RX_FRAME_LEN;
+        if (config.protocol == PROTOCOL_V2)
+        {
+            len = EncodeMessageV2<ChassisPayloadV2>(V2_MSG_CHASSIS, txSeq++, data, frame);
+        }
+        else
+        {
+            ChassisFrame::Encode(data, frame);
+        }
+
+        ///篡改(不改动首尾的帧头/帧边界)
+        if (chance(rng) < config.corruptRatio)
+        {
+            frame[1 + rng() % (len - 2)] ^= static_cast<unsigned char>(1 + rng() % 255);
+            framesCorrupted.fetch_add(1);
+        }
+
+        ///拆分写入
+        if (chance(rng) < config.splitRatio)
+        {
+            size_t cut = 1 + rng() % (len - 1);
+            WriteAll(frame, cut);
+
+            struct timespec gap = {0, SIM_SPLIT_GAP_NS};
+            nanosleep(&gap, NULL);
+
+            sentTime[seq].store(NowNs(), std::memory_order_release);
+            WriteAll(&frame[cut], len - cut);
+        }
+        else
+        {
+            sentTime[seq].store(NowNs(), std::memory_order_release);
+            WriteAll(frame, len);
+        }
+
+        framesSent.fetch_add(1);
+    }
+
+    finished.store(true);
+}
+
+/**
+ * @brief RxLoop 接收并校验上位机发来的数据帧
+ */
+void McuSimulator::RxLoop()
+{
+    std::vector<unsigned char>             pending;
+    unsigned char                          buf[1024];
+    std::mt19937                           rng(config.seed + 1);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    while (running.load())
+    {
+        if (config.stallRatio > 0 && chance(rng) < config.stallRatio)
+        {
+            struct timespec stall = {0, SIM_STALL_NS};
+            nanosleep(&stall, NULL);
+        }
+
+        struct pollfd pfd;
+        pfd.fd     = master;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 20) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t n = read(master, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            continue;
+        }
+        if (config.protocol == PROTOCOL_V2 && config.compact)
+        {
+            CheckHostCompact(buf, static_cast<size_t>(n));
+            continue;
+        }
+        pending.insert(pending.end(), buf, buf + n);
+
+        if (config.protocol == PROTOCOL_V2)
+        {
+            CheckHostV2(pending);
+        }
+        else
+        {
+            CheckHostV1(pending);
+        }
+    }
+}
+
+/**
+ * @brief CheckHostV1 校验定长帧,处理过的字节从pending中移除
+ */
+void McuSimulator::CheckHostV1(std::vector<unsigned char>& pending)
+{
+    size_t pos = 0;
+    while (pos + TX_FRAME_LEN <= pending.size())
+    {
+        if (pending[pos] != TX_FRAME_HEAD)
+        {
+            pos++;
+            continue;
+        }
+
+        if (HostFrame::Check(&pending[pos]))
+        {
+            hostFramesOk.fetch_add(1);
+            pos += TX_FRAME_LEN;
+        }
+        else
+        {
+            hostFramesBad.fetch_add(1);
+            pos++;
+        }
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<long>(pos));
+}
+
+/**
+ * @brief CheckHostV2 按帧边界切分并校验V2消息,处理过的字节从pending中移除
+ */
+void McuSimulator::CheckHostV2(std::vector<unsigned char>& pending)
+{
+    unsigned char scratch[V2_MAX_ENCODED];
+    size_t        start = 0;
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        if (pending[i] != V2_DELIMITER)
+        {
+            continue;
+        }
+
+        if (i > start)
+        {
+            MessageV2 msg;
+            bool      ok = DecodeMessageV2(&pending[start], i - start, scratch, msg);
+            if (ok && msg.id == V2_MSG_PING && msg.length >= PingPayload::SIZE)
+            {
+                PingMessage ping;
+                PingPayload::Decode(msg.payload, ping);
+
+                PongMessage pong;
+                pong.hostNs = ping.hostNs;
+                pong.rxUs   = DeviceClockUs();
+                SendPong(pong);
+            }
+            else if (ok && msg.id == V2_MSG_HOST && msg.length >= HostPayloadV2::SIZE)
+            {
+                hostFramesOk.fetch_add(1);
+            }
+            else
+            {
+                hostFramesBad.fetch_add(1);
+            }
+        }
+        start = i + 1;
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<long>(start));
+}
+
+/**
+ * @brief CheckHostCompact 用下位机参考实现逐字节接收,回复与数据帧共用发送序号
+ */
+void McuSimulator::CheckHostCompact(const unsigned char* data, size_t len)
+{
+    uint32_t crcErrors = compactRx.crc_errors;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        CompactTarget target;
+        CompactEvent  event = Compact_FeedByte(&compactRx, data[i], &target);
+        if (event == COMPACT_EVENT_TARGET)
+        {
+            hostFramesOk.fetch_add(1);
+        }
+        else if (event == COMPACT_EVENT_REPLY || event == COMPACT_EVENT_PING)
+        {
+            ///与真实下位机一样在发送前一刻组回复,持有writeLock时不会插进数据帧中间
+            uint8_t                     reply[COMPACT_REPLY_MAX];
+            std::lock_guard<std::mutex> lock(writeLock);
+            size_t replyLen = event == COMPACT_EVENT_REPLY ? Compact_BuildReply(&compactRx, txSeq++, reply) : Compact_BuildPong(&compactRx, txSeq++, reply);
+            WriteAll(reply, replyLen);
+            if (event == COMPACT_EVENT_PING)
+            {
+                pongsSent.fetch_add(1);
+            }
+        }
+    }
+
+    hostFramesBad.fetch_add(compactRx.crc_errors - crcErrors);
+    compactRejected.store(compactRx.rejected);
+}
+
+/**
+ * @brief SendPong 立即发出时钟同步回复,t3取发送时刻
+ */
+void McuSimulator::SendPong(const PongMessage& pong)
+{
+    std::lock_guard<std::mutex> lock(writeLock);
+
+    PongMessage   out = pong;
+    unsigned char frame[V2_MAX_FRAME];
+    out.txUs   = DeviceClockUs();
+    size_t len = EncodeMessageV2<PongPayload>(V2_MSG_PONG, txSeq++, out, frame);
+    WriteAll(frame, len);
+    pongsSent.fetch_add(1);
+}
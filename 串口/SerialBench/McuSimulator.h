@@ -0,0 +1,102 @@
+/**
+ * @file    McuSimulator.h
+ * @brief   基于伪终端(openpty)的下位机模拟器
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    模拟器持有伪终端主端,上位机程序像打开真实串口一样打开从端(SlaveName())。
+ *          发送:按设定帧率发送GroundChassisData帧(0x5a ... CRC8,或V2_MSG_CHASSIS消息),可插入噪声、拆分写入、篡改字节;
+ *          接收:解析上位机发来的HostComputerData帧(0xA5 ... CRC8,或V2_MSG_HOST消息)并计数;
+ *          compact时改用下位机参考实现(McuReference/compact_decoder.c)逐字节接收,回复压缩编码协商并解码压缩帧,回复与数据帧共用发送序号。
+ *          V2下回复时钟同步请求(V2_MSG_PING),设备时钟为CLOCK_MONOTONIC的微秒数加clockOffsetUs,取低32位。
+ *          每帧的gain_yaw字段写入帧序号,接收端据此查到发送时刻,计算端到端延迟
+ */
+
+#ifndef MCUSIMULATOR_H
+#define MCUSIMULATOR_H
+
+#include "ClockSync.h"
+#include "ProtocolV2.h"
+extern "C" {
+#include "compact_decoder.h"
+}
+
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct
+{
+    double          rateHz;         ///<发送帧率
+    uint32_t        frames;         ///<发送总帧数
+    double          noiseRatio;     ///<帧前插入随机垃圾字节的概率
+    int             noiseBytes;     ///<每次插入的最大垃圾字节数
+    double          splitRatio;     ///<一帧被拆成两次write的概率
+    double          corruptRatio;   ///<一帧中随机一个字节被篡改的概率
+    uint32_t        seed;           ///<随机数种子,保证结果可复现
+    ProtocolVersion protocol;       ///<收发使用的协议版本
+    bool            compact;        ///<V2下是否同意压缩编码
+    int64_t         clockOffsetUs;  ///<模拟的设备时钟相对主机时钟的偏差(us)
+    double          stallRatio;     ///<接收线程每次读取前暂停SIM_STALL_NS的概率,用于让上位机的发送缓冲区写满
+} McuSimConfig;
+
+class McuSimulator
+{
+public:
+    explicit McuSimulator(const McuSimConfig& config);
+    ~McuSimulator();
+
+    bool        Open();
+    const char* SlaveName() const;
+    void        Start();
+    void        Stop();
+    bool        Finished() const;
+
+    int64_t  SentTime(uint32_t seq) const;
+    uint32_t FramesSent() const;
+    uint32_t FramesCorrupted() const;
+    uint32_t HostFramesOk() const;
+    uint32_t HostFramesBad() const;
+    uint32_t CompactRejected() const;
+    uint32_t PongsSent() const;
+
+    static int64_t  NowNs();
+    static uint32_t DeviceClockUs();
+
+private:
+    void TxLoop();
+    void RxLoop();
+    void WriteAll(const unsigned char* data, size_t len);
+    void CheckHostV1(std::vector<unsigned char>& pending);
+    void CheckHostV2(std::vector<unsigned char>& pending);
+    void CheckHostCompact(const unsigned char* data, size_t len);
+    void SendPong(const PongMessage& pong);
+
+    McuSimConfig config;
+    int          master;
+    int          slave;
+    std::string  slaveName;
+
+    std::thread       txThread;
+    std::thread       rxThread;
+    std::atomic<bool> running;
+    std::atomic<bool> finished;
+
+    std::vector<std::atomic<int64_t>> sentTime;  ///<按帧序号记录发送时刻(ns)
+    std::atomic<uint32_t>             framesSent;
+    std::atomic<uint32_t>             framesCorrupted;
+    std::atomic<uint32_t>             hostFramesOk;
+    std::atomic<uint32_t>             hostFramesBad;
+    std::atomic<uint32_t>             pongsSent;
+
+    std::mutex writeLock;  ///<收发两个线程都会写主端,按整帧加锁
+    uint8_t    txSeq;      ///<V2发送序号,持有writeLock时访问
+
+    CompactRx             compactRx;  ///<只在接收线程使用
+    std::atomic<uint32_t> compactRejected;
+};
+
+#endif  // MCUSIMULATOR_H
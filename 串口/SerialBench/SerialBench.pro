@@ -0,0 +1,36 @@
+TEMPLATE = app
+CONFIG += console c++2a
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# GCC 10需要显式打开协程支持
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
+
+INCLUDEPATH += ../SerialPort
+INCLUDEPATH += ../McuReference
+LIBS += -lpthread -lutil -lrt
+
+SOURCES += \
+        ../McuReference/compact_decoder.c \
+        ../SerialPort/AsyncUart.cpp \
+        ../SerialPort/ClockSync.cpp \
+        ../SerialPort/Cobs.cpp \
+        ../SerialPort/CompactCodec.cpp \
+        ../SerialPort/Crc.cpp \
+        ../SerialPort/EventLoop.cpp \
+        ../SerialPort/FrameParser.cpp \
+        ../SerialPort/PortManager.cpp \
+        ../SerialPort/ProtocolV2.cpp \
+        ../SerialPort/RealTime.cpp \
+        ../SerialPort/SerialBridge.cpp \
+        ../SerialPort/SerialCapture.cpp \
+        ../SerialPort/SerialPort.cpp \
+        ../SerialPort/ShmChannel.cpp \
+        ../SerialPort/TxScheduler.cpp \
+        ../SerialPort/UartReceiver.cpp \
+        ../SerialPort/UartStats.cpp \
+        McuSimulator.cpp \
+        main.cpp
+
+HEADERS += \
+    McuSimulator.h
@@ -0,0 +1,811 @@
+/**
+ * @file    main.cpp
+ * @brief   串口吞吐/延迟测试:下位机模拟器 + Uart接收路径
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    用法: SerialBench [--rate=1000] [--seconds=10] [--noise=0.05] [--noise-bytes=8] [--split=0.2]
+ *                            [--corrupt=0.01] [--tx-rate=200] [--poll-us=100] [--mode=thread|inline|coro] [--seed=1]
+ *                            [--record=capture.bin] [--replay=capture.bin] [--replay-speed=max|original] [--protocol=v1|v2]
+ *                            [--realtime=CPU] [--spin-us=200] [--compact=0.01] [--ping=1] [--tx-hz=1000] [--rx-stall=0.01]
+ *                            [--shm=10000] [--bridge=3] [--ports=4]
+ *          mode=thread:UartReceiver接收线程 + 环形缓冲区,主循环阻塞在UartReceiver::Wait上直到有数据或下一次发送
+ *          mode=inline:主循环直接调用Uart::GetMode(原有方式),每轮休眠poll-us
+ *          mode=coro:EventLoop + AsyncUart,收发各一个协程,不轮询
+ *          record:把收发的原始数据录制到文件;replay:不启动模拟器,把录制文件送入Uart::Decode并统计解析吞吐
+ *          protocol=v2:收发都使用COBS分帧的V2协议,额外打印按序号统计的丢帧数
+ *          compact(需protocol=v2):按给定角度步长与模拟下位机协商压缩编码,下位机端使用McuReference中的参考实现
+ *          ping(需protocol=v2):随目标帧定期发送时钟同步请求,模拟下位机的时钟有固定偏差,打印往返延迟、单向延迟与偏差估计误差
+ *          realtime/spin-us(仅mode=thread):接收线程绑定到CPU并使用SCHED_FIFO、锁定内存;读到数据后忙轮询spin-us再阻塞
+ *          tx-hz(mode=thread|inline):由TxScheduler按给定频率定频发送,主循环只按tx-rate把目标发布到邮箱,打印合并/重发/写不下的次数
+ *          rx-stall:模拟下位机每次读取前以给定概率暂停20ms不读,使上位机的内核发送缓冲区写满,检验写不下时的处理
+ *          shm:不启动模拟器,fork出一个子进程作为视觉进程,按rate经共享内存通道发送给定条数的目标,
+ *              本进程像串口进程一样读取,统计收到/丢失条数与跨进程延迟
+ *          bridge:解析出的每帧经SerialBridge转发给给定个数的本地订阅者:第一个尽快读取,中间的每20ms读一条
+ *              (缓冲区满时丢弃),最后一个(个数>=2时)从不读取(连续丢弃过多后被断开);打印各订阅者收到/丢弃条数与转发延迟
+ *          ports:启动给定个数的模拟下位机,全部交给一个PortManager(单个reactor线程epoll)接收,主循环按tx-rate向每个串口发送,
+ *              打印各串口的收发帧数与延迟;mode等只对单串口有效的参数被忽略
+ */
+
+#include "AsyncUart.h"
+#include "McuSimulator.h"
+#include "PortManager.h"
+#include "SerialBridge.h"
+#include "SerialPort.h"
+#include "ShmChannel.h"
+#include "TxScheduler.h"
+#include "UartReceiver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <sys/wait.h>
+#include <thread>
+
+#define BENCH_SHM_CHANNEL     "/serial_bench_host"           ///shm模式使用的共享内存,避免与正在运行的串口程序冲突
+#define BENCH_BRIDGE_SOCKET   "/tmp/serial_bench_bridge.sock"  ///bridge模式的监听地址
+#define BENCH_BRIDGE_SLOW_MS  20                              ///bridge模式中慢订阅者每次读取的间隔
+
+typedef struct
+{
+    const McuSimulator* sim;
+    SerialBridge*       bridge;     ///<非NULL时每帧转发给订阅者
+    vector<int64_t>     latencies;  ///<端到端延迟(ns)
+    uint32_t            received;
+} BenchContext;
+
+static void OnFrame(const GroundChassisData& data, void* user)
+{
+    BenchContext* ctx  = static_cast<BenchContext*>(user);
+    int64_t       sent = ctx->sim->SentTime(static_cast<uint32_t>(data.gain_yaw.f));
+    if (sent != 0)
+    {
+        ctx->latencies.push_back(McuSimulator::NowNs() - sent);
+    }
+    ctx->received++;
+
+    if (ctx->bridge != NULL)
+    {
+        ctx->bridge->Publish(data);
+    }
+}
+
+///bridge模式中订阅者的读取方式
+enum BridgeReader
+{
+    BRIDGE_READER_FAST,   ///<尽快读取
+    BRIDGE_READER_SLOW,   ///<每BENCH_BRIDGE_SLOW_MS读一条
+    BRIDGE_READER_STALL,  ///<从不读取
+};
+
+///bridge模式中一个订阅者的统计
+typedef struct
+{
+    BridgeReader    reader;
+    bool            connected;
+    bool            evicted;    ///<被转发端断开
+    uint64_t        received;
+    uint64_t        lost;       ///<消息头报告的丢弃条数之和
+    uint64_t        gaps;       ///<按转发序号统计的缺口
+    vector<int64_t> latencies;  ///<Publish到收到的延迟(ns)
+} BridgeResult;
+
+static bool ParseArg(const char* arg, const char* name, string& value)
+{
+    size_t len = strlen(name);
+    if (strncmp(arg, name, len) == 0 && arg[len] == '=')
+    {
+        value = &arg[len + 1];
+        return true;
+    }
+    return false;
+}
+
+static double Percentile(const vector<int64_t>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+static void FillSendData(HostComputerData& sendData)
+{
+    sendData.pitch.f    = 1.0f;
+    sendData.yaw.f      = 2.0f;
+    sendData.distance.f = 3000.0f;
+}
+
+/**
+ * @brief CoroRx 协程模式的接收:等待新帧(帧由解析器回调统计),模拟器发送结束100ms后退出
+ */
+static Task<void> CoroRx(AsyncUart& port, const McuSimulator& sim, bool& done)
+{
+    int64_t drainAt = 0;
+
+    while (port.IsOpen())
+    {
+        co_await port.NextFrame<GroundChassisData>(10000000);
+
+        int64_t now = McuSimulator::NowNs();
+        if (sim.Finished())
+        {
+            if (drainAt == 0)
+            {
+                drainAt = now + 100000000LL;
+            }
+            else if (now >= drainAt)
+            {
+                break;
+            }
+        }
+    }
+
+    done = true;
+}
+
+/**
+ * @brief CoroTx 协程模式的发送:按绝对时刻周期发送,接收协程退出后停止事件循环
+ */
+static Task<void> CoroTx(EventLoop& loop, AsyncUart& port, int64_t every, const bool& done)
+{
+    HostComputerData sendData;
+    FillSendData(sendData);
+
+    int64_t next = McuSimulator::NowNs();
+    while (!done)
+    {
+        next += every;
+        co_await loop.SleepUntil(next);
+        co_await port.Send(sendData);
+    }
+
+    loop.Stop();
+}
+
+/**
+ * @brief Replay 回放录制文件,统计解析吞吐
+ */
+static int Replay(const string& path, ReplaySpeed speed, ProtocolVersion protocol)
+{
+    Uart              uart;
+    GroundChassisData data;
+    uart.SetProtocol(protocol);
+    int64_t           start    = McuSimulator::NowNs();
+    long              replayed = ReplayCapture(path, uart, speed, data);
+    double            elapsed  = static_cast<double>(McuSimulator::NowNs() - start) / 1e9;
+    if (replayed < 0)
+    {
+        return -1;
+    }
+
+    UartStatsSnapshot stats;
+    uart.Stats().Snapshot(stats);
+    const FrameParserStats& parsed = uart.Parser().Stats();
+
+    cout << "回放记录数      : " << replayed << " (" << elapsed << " 秒)" << endl;
+    cout << "解析帧数        : " << parsed.frames << " (" << static_cast<double>(parsed.frames) / elapsed << " 帧/秒)" << endl;
+    cout << "解析吞吐        : " << static_cast<double>(stats.bytesRead) / elapsed / 1e6 << " MB/s" << endl;
+    cout << "CRC失败/重同步  : " << parsed.crcErrors << " / " << parsed.resyncs << endl;
+    cout << "解析延迟p50/p99 : " << stats.rxLatency.Percentile(0.5) / 1000.0 << " / " << stats.rxLatency.Percentile(0.99) / 1000.0 << " us" << endl;
+
+    return 0;
+}
+
+/**
+ * @brief BridgeRead bridge模式的一个订阅者:按读取方式读到done为止
+ */
+static void BridgeRead(BridgeResult& result, const std::atomic<bool>& done)
+{
+    BridgeSubscriber sub;
+    result.connected = sub.Connect(BENCH_BRIDGE_SOCKET);
+
+    BridgeMessage msg;
+    int64_t       last = -1;
+    while (result.connected && !done.load())
+    {
+        if (result.reader == BRIDGE_READER_STALL)
+        {
+            usleep(10000);
+            continue;
+        }
+
+        if (!sub.Read(msg, 100))
+        {
+            if (sub.Fd() == -1)
+            {
+                result.evicted = true;
+                break;
+            }
+            continue;
+        }
+
+        result.latencies.push_back(McuSimulator::NowNs() - msg.header.stampNs);
+        result.received++;
+        result.lost += msg.header.lost;
+        if (last >= 0)
+        {
+            result.gaps += msg.header.seq - static_cast<uint32_t>(last) - 1;
+        }
+        last = msg.header.seq;
+
+        if (result.reader == BRIDGE_READER_SLOW)
+        {
+            usleep(BENCH_BRIDGE_SLOW_MS * 1000);
+        }
+    }
+
+    ///从不读取的订阅者结束时检查连接是否已被断开
+    if (result.reader == BRIDGE_READER_STALL && result.connected)
+    {
+        while (sub.Read(msg, 0))
+        {
+        }
+        result.evicted = sub.Fd() == -1;
+    }
+}
+
+/**
+ * @brief ShmBench 跨进程共享内存通道测试:子进程发布目标,本进程读取
+ * @param messages 发送条数
+ * @param rateHz   发送频率
+ */
+static int ShmBench(uint32_t messages, double rateHz)
+{
+    ShmChannel::Unlink(BENCH_SHM_CHANNEL);
+
+    ShmQueue<HostComputerData> reader;
+    if (!reader.Open(BENCH_SHM_CHANNEL))
+    {
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        cout << "创建子进程失败" << endl;
+        return -1;
+    }
+    if (pid == 0)
+    {
+        ///视觉进程:distance字段写入消息序号
+        ShmQueue<HostComputerData> writer;
+        if (!writer.Open(BENCH_SHM_CHANNEL))
+        {
+            _exit(1);
+        }
+
+        HostComputerData data;
+        FillSendData(data);
+        int64_t period = static_cast<int64_t>(1e9 / rateHz);
+        int64_t next   = McuSimulator::NowNs();
+        for (uint32_t i = 0; i < messages; i++)
+        {
+            next += period;
+            struct timespec ts;
+            ts.tv_sec  = next / 1000000000LL;
+            ts.tv_nsec = next % 1000000000LL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+            data.distance.f = static_cast<float>(i);
+            writer.Publish(data);
+        }
+        _exit(0);
+    }
+
+    vector<int64_t>  latencies;
+    HostComputerData data;
+    int64_t          publishedNs = 0;
+    int64_t          last        = -1;
+    uint64_t         gaps        = 0;
+    latencies.reserve(messages);
+
+    ///串口进程:收到最后一条或100ms没有新消息时结束
+    while (last + 1 < static_cast<int64_t>(messages) && reader.Read(data, 100000000, &publishedNs))
+    {
+        latencies.push_back(McuSimulator::NowNs() - publishedNs);
+        int64_t index = static_cast<int64_t>(data.distance.f);
+        gaps += static_cast<uint64_t>(index - last - 1);
+        last = index;
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ShmChannel::Unlink(BENCH_SHM_CHANNEL);
+
+    sort(latencies.begin(), latencies.end());
+    cout << "共享内存通道    : 发送 " << messages << " 收到 " << latencies.size() << " 序号缺口 " << gaps << " 覆盖丢失 " << reader.Lost() << endl;
+    cout << "跨进程p50/p99/p999: " << Percentile(latencies, 0.5) << " / " << Percentile(latencies, 0.99) << " / " << Percentile(latencies, 0.999) << " us" << endl;
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0 ? 0 : -1;
+}
+
+/**
+ * @brief PortsBench 多串口测试:每个模拟下位机一个伪终端,由一个PortManager统一接收
+ * @param config  模拟器参数,第i个串口的随机种子为config.seed + i
+ * @param count   串口个数
+ * @param txRate  每个串口的发送频率
+ */
+static int PortsBench(const McuSimConfig& config, int count, double txRate)
+{
+    vector<std::unique_ptr<McuSimulator>> sims;
+    vector<BenchContext>                  ctxs(static_cast<size_t>(count));
+    PortManager                           manager;
+
+    for (int i = 0; i < count; i++)
+    {
+        McuSimConfig portConfig = config;
+        portConfig.seed         = config.seed + static_cast<uint32_t>(i);
+        sims.push_back(std::unique_ptr<McuSimulator>(new McuSimulator(portConfig)));
+        if (!sims[i]->Open())
+        {
+            cout << "创建伪终端失败" << endl;
+            return -1;
+        }
+
+        ctxs[i].sim      = sims[i].get();
+        ctxs[i].bridge   = NULL;
+        ctxs[i].received = 0;
+        ctxs[i].latencies.reserve(config.frames);
+
+        PortConfig port = {"port" + to_string(i), sims[i]->SlaveName(), BAUDRATE, 0, 8, 1, 'N', OnFrame, &ctxs[i], config.protocol};
+        if (manager.AddPort(port) != i)
+        {
+            return -1;
+        }
+    }
+
+    if (!manager.Start())
+    {
+        return -1;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        sims[i]->Start();
+    }
+
+    ///主循环只负责按绝对时刻发送,接收全部在reactor线程中
+    HostComputerData sendData;
+    FillSendData(sendData);
+    int64_t start   = McuSimulator::NowNs();
+    int64_t txNext  = start;
+    int64_t txEvery = static_cast<int64_t>(1e9 / txRate);
+    int64_t drainAt = 0;
+    vector<uint32_t> sendFailed(static_cast<size_t>(count), 0);
+    while (drainAt == 0 || McuSimulator::NowNs() < drainAt)
+    {
+        txNext += txEvery;
+        struct timespec ts;
+        ts.tv_sec  = txNext / 1000000000LL;
+        ts.tv_nsec = txNext % 1000000000LL;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+
+        bool finished = true;
+        for (int i = 0; i < count; i++)
+        {
+            if (!manager.Send(i, sendData))
+            {
+                sendFailed[i]++;
+            }
+            finished = finished && sims[i]->Finished();
+        }
+        ///发送结束后再等待100ms,收完缓冲区中剩余的数据
+        if (finished && drainAt == 0)
+        {
+            drainAt = McuSimulator::NowNs() + 100000000LL;
+        }
+    }
+    double elapsed = static_cast<double>(McuSimulator::NowNs() - start) / 1e9;
+
+    manager.Stop();
+    for (int i = 0; i < count; i++)
+    {
+        sims[i]->Stop();
+    }
+
+    cout << "串口数          : " << count << " (1个reactor线程)" << endl;
+    for (int i = 0; i < count; i++)
+    {
+        BenchContext&     ctx = ctxs[i];
+        UartStatsSnapshot snapshot;
+        manager.Stats(i).Snapshot(snapshot);
+        sort(ctx.latencies.begin(), ctx.latencies.end());
+
+        int64_t lost = static_cast<int64_t>(sims[i]->FramesSent()) - static_cast<int64_t>(sims[i]->FramesCorrupted()) - static_cast<int64_t>(ctx.received);
+        cout << "port" << i << "           : 发送 " << sims[i]->FramesSent() << " (篡改 " << sims[i]->FramesCorrupted() << ") 接收 " << ctx.received << " ("
+             << static_cast<double>(ctx.received) / elapsed << " 帧/秒) 丢失 " << lost << " 延迟p50/p99 " << Percentile(ctx.latencies, 0.5) << " / "
+             << Percentile(ctx.latencies, 0.99) << " us 解析p50 " << snapshot.rxLatency.Percentile(0.5) / 1000.0 << " us 下位机收到 正确 "
+             << sims[i]->HostFramesOk() << " 错误 " << sims[i]->HostFramesBad() << " 发送丢弃 " << sendFailed[i] << endl;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    McuSimConfig config;
+    config.rateHz        = 1000;
+    config.frames        = 0;
+    config.noiseRatio    = 0.05;
+    config.noiseBytes    = 8;
+    config.splitRatio    = 0.2;
+    config.corruptRatio  = 0.01;
+    config.seed          = 1;
+    config.protocol      = PROTOCOL_V1;
+    config.compact       = false;
+    config.clockOffsetUs = 123456789;
+    config.stallRatio    = 0;
+
+    double seconds = 10;
+    double txRate  = 200;
+    int    pollUs  = 100;
+    string mode    = "thread";
+    string record;
+    string replay;
+    string replaySpeed = "max";
+    int    rtCpu       = -1;
+    int    spinUs      = 0;
+    float  compactStep = 0;
+    bool   ping        = false;
+    double txHz        = 0;
+    int    shmMessages = 0;
+    int    bridgeSubs  = 0;
+    int    portCount   = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string value;
+        if (ParseArg(argv[i], "--rate", value))
+            config.rateHz = atof(value.c_str());
+        else if (ParseArg(argv[i], "--seconds", value))
+            seconds = atof(value.c_str());
+        else if (ParseArg(argv[i], "--noise", value))
+            config.noiseRatio = atof(value.c_str());
+        else if (ParseArg(argv[i], "--noise-bytes", value))
+            config.noiseBytes = atoi(value.c_str());
+        else if (ParseArg(argv[i], "--split", value))
+            config.splitRatio = atof(value.c_str());
+        else if (ParseArg(argv[i], "--corrupt", value))
+            config.corruptRatio = atof(value.c_str());
+        else if (ParseArg(argv[i], "--tx-rate", value))
+            txRate = atof(value.c_str());
+        else if (ParseArg(argv[i], "--poll-us", value))
+            pollUs = atoi(value.c_str());
+        else if (ParseArg(argv[i], "--mode", value))
+            mode = value;
+        else if (ParseArg(argv[i], "--seed", value))
+            config.seed = static_cast<uint32_t>(atoi(value.c_str()));
+        else if (ParseArg(argv[i], "--record", value))
+            record = value;
+        else if (ParseArg(argv[i], "--replay", value))
+            replay = value;
+        else if (ParseArg(argv[i], "--replay-speed", value))
+            replaySpeed = value;
+        else if (ParseArg(argv[i], "--protocol", value))
+            config.protocol = value == "v2" ? PROTOCOL_V2 : PROTOCOL_V1;
+        else if (ParseArg(argv[i], "--realtime", value))
+            rtCpu = atoi(value.c_str());
+        else if (ParseArg(argv[i], "--spin-us", value))
+            spinUs = atoi(value.c_str());
+        else if (ParseArg(argv[i], "--compact", value))
+            compactStep = static_cast<float>(atof(value.c_str()));
+        else if (ParseArg(argv[i], "--ping", value))
+            ping = atoi(value.c_str()) != 0;
+        else if (ParseArg(argv[i], "--tx-hz", value))
+            txHz = atof(value.c_str());
+        else if (ParseArg(argv[i], "--rx-stall", value))
+            config.stallRatio = atof(value.c_str());
+        else if (ParseArg(argv[i], "--shm", value))
+            shmMessages = atoi(value.c_str());
+        else if (ParseArg(argv[i], "--ports", value))
+            portCount = atoi(value.c_str());
+        else if (ParseArg(argv[i], "--bridge", value))
+            bridgeSubs = std::min(atoi(value.c_str()), BRIDGE_MAX_SUBSCRIBERS);
+        else
+        {
+            cout << "未知参数: " << argv[i] << endl;
+            return -1;
+        }
+    }
+    config.frames  = static_cast<uint32_t>(config.rateHz * seconds);
+    config.compact = compactStep > 0 && config.protocol == PROTOCOL_V2;
+    ping           = ping && config.protocol == PROTOCOL_V2;
+
+    if (shmMessages > 0)
+    {
+        return ShmBench(static_cast<uint32_t>(shmMessages), config.rateHz);
+    }
+
+    if (portCount > 0)
+    {
+        return PortsBench(config, portCount, txRate);
+    }
+
+    if (!replay.empty())
+    {
+        return Replay(replay, replaySpeed == "original" ? REPLAY_ORIGINAL : REPLAY_MAX, config.protocol);
+    }
+
+    McuSimulator sim(config);
+    if (!sim.Open())
+    {
+        cout << "创建伪终端失败" << endl;
+        return -1;
+    }
+
+    Uart uart;
+    int  fd = -1;
+    if (uart.InitSerial(fd, sim.SlaveName()) != 0)
+    {
+        return -1;
+    }
+    uart.SetProtocol(config.protocol);
+
+    ///压缩编码:下位机的同意回复经分发表交给CompactLink
+    CompactConfig     compactConfig = {compactStep, 1.0f, 50};
+    CompactLink       compact(compactConfig);
+    MessageDispatcher dispatcher;
+    if (config.compact)
+    {
+        dispatcher.Register(V2_MSG_COMPACT_ACCEPT, CompactLink::OnAccept, &compact);
+        uart.SetCompact(&compact);
+    }
+
+    ///时钟同步:请求附带在目标帧前,回复经分发表交给ClockSync
+    ClockSync clock;
+    if (ping)
+    {
+        dispatcher.Register(V2_MSG_PONG, ClockSync::OnPong, &clock);
+        uart.SetClockSync(&clock);
+    }
+
+    CaptureWriter recorder;
+    if (!record.empty())
+    {
+        if (!recorder.Open(record))
+        {
+            return -1;
+        }
+        uart.SetRecorder(&recorder);
+    }
+
+    ///本地转发:订阅者连接完成后再开始发送
+    SerialBridge         bridge;
+    vector<BridgeResult> bridgeResults(static_cast<size_t>(std::max(bridgeSubs, 0)));
+    vector<std::thread>  bridgeReaders;
+    std::atomic<bool>    bridgeDone(false);
+    if (bridgeSubs > 0)
+    {
+        if (!bridge.Start(BENCH_BRIDGE_SOCKET))
+        {
+            return -1;
+        }
+        for (int i = 0; i < bridgeSubs; i++)
+        {
+            BridgeResult& result = bridgeResults[i];
+            result.reader        = i == 0 ? BRIDGE_READER_FAST : (i == bridgeSubs - 1 ? BRIDGE_READER_STALL : BRIDGE_READER_SLOW);
+            result.connected     = false;
+            result.evicted       = false;
+            result.received      = 0;
+            result.lost          = 0;
+            result.gaps          = 0;
+            result.latencies.reserve(config.frames);
+            bridgeReaders.push_back(std::thread(BridgeRead, std::ref(result), std::cref(bridgeDone)));
+        }
+
+        BridgeStats bs;
+        for (int wait = 0; wait < 100; wait++)
+        {
+            bridge.Snapshot(bs);
+            if (bs.subscribers == static_cast<size_t>(bridgeSubs))
+            {
+                break;
+            }
+            usleep(10000);
+        }
+    }
+
+    BenchContext ctx;
+    ctx.sim      = &sim;
+    ctx.bridge   = bridgeSubs > 0 ? &bridge : NULL;
+    ctx.received = 0;
+    ctx.latencies.reserve(config.frames);
+
+    UartReceiver receiver;
+    FrameParser* parser = NULL;
+    if (mode == "thread")
+    {
+        parser = &receiver.Parser();
+        parser->SetProtocol(config.protocol);
+        parser->SetCallback(OnFrame, &ctx);
+        receiver.SetRecorder(record.empty() ? NULL : &recorder);
+        if (rtCpu >= 0 || spinUs != 0)
+        {
+            RealTimeConfig rt = {rtCpu, rtCpu >= 0 ? RT_DEFAULT_PRIORITY : 0, rtCpu >= 0, static_cast<int64_t>(spinUs) * 1000};
+            receiver.SetRealTime(rt);
+        }
+        receiver.Start(fd);
+        if (rtCpu >= 0 || spinUs != 0)
+        {
+            PrintRealTimeReport("接收线程", receiver.RealTime());
+        }
+    }
+    else
+    {
+        parser = &uart.Parser();
+        parser->SetCallback(OnFrame, &ctx);
+    }
+    parser->SetDispatcher(config.compact || ping ? &dispatcher : NULL);
+    clock.SetParser(parser);
+
+    ///定频发送:主循环发布目标,TxScheduler按txHz写出
+    LatestValue<HostComputerData> txMailbox;
+    TxScheduler                   scheduler(uart, txMailbox);
+    if (txHz > 0 && mode != "coro")
+    {
+        TxSchedulerConfig txConfig = {txHz, true};
+        scheduler.Start(fd, txConfig);
+    }
+
+    sim.Start();
+
+    HostComputerData  sendData;
+    GroundChassisData receiveData;
+    int64_t           start   = McuSimulator::NowNs();
+    int64_t           txNext  = start;
+    int64_t           txEvery = static_cast<int64_t>(1e9 / txRate);
+    int64_t           drainAt = 0;
+
+    if (mode == "coro")
+    {
+        EventLoop loop;
+        AsyncUart port(loop, uart, fd);
+        bool      done = false;
+
+        loop.Spawn(CoroRx(port, sim, done));
+        loop.Spawn(CoroTx(loop, port, txEvery, done));
+        loop.Run();
+    }
+    else
+    {
+        while (true)
+        {
+            if (mode == "thread")
+            {
+                receiver.Wait(std::max<int64_t>(txNext - McuSimulator::NowNs(), 0));
+                receiver.GetMode(receiveData);
+            }
+            else
+            {
+                uart.GetMode(fd, receiveData);
+            }
+
+            int64_t now = McuSimulator::NowNs();
+            if (now >= txNext)
+            {
+                FillSendData(sendData);
+                if (scheduler.IsRunning())
+                {
+                    txMailbox.Publish(sendData);
+                }
+                else
+                {
+                    uart.TransformTarPos(fd, sendData);
+                }
+                txNext += txEvery;
+            }
+
+            ///发送结束后再等待100ms,收完缓冲区中剩余的数据
+            if (sim.Finished())
+            {
+                if (drainAt == 0)
+                {
+                    drainAt = now + 100000000LL;
+                }
+                else if (now >= drainAt)
+                {
+                    break;
+                }
+            }
+
+            if (mode != "thread" && pollUs > 0)
+            {
+                usleep(static_cast<useconds_t>(pollUs));
+            }
+        }
+    }
+
+    double elapsed = static_cast<double>(McuSimulator::NowNs() - start) / 1e9;
+
+    TxSchedulerStats txScheduled;
+    scheduler.Stop();
+    scheduler.Snapshot(txScheduled);
+
+    UartStatsSnapshot rxStats;
+    UartStatsSnapshot txStats;
+    (mode == "thread" ? receiver.Stats() : uart.Stats()).Snapshot(rxStats);
+    uart.Stats().Snapshot(txStats);
+
+    sim.Stop();
+    receiver.Stop();
+    uart.CloseSerial(fd);
+    recorder.Close();
+
+    BridgeStats bridgeStats;
+    bridge.Snapshot(bridgeStats);
+    bridgeDone.store(true);
+    for (size_t i = 0; i < bridgeReaders.size(); i++)
+    {
+        bridgeReaders[i].join();
+    }
+    bridge.Stop();
+
+    sort(ctx.latencies.begin(), ctx.latencies.end());
+    const FrameParserStats& stats = parser->Stats();
+
+    double crcRate = stats.frames + stats.crcErrors > 0 ? static_cast<double>(stats.crcErrors) / static_cast<double>(stats.frames + stats.crcErrors) : 0;
+
+    cout << "模式            : " << mode << endl;
+    cout << "发送帧数        : " << sim.FramesSent() << " (篡改 " << sim.FramesCorrupted() << ")" << endl;
+    cout << "接收帧数        : " << ctx.received << " (" << static_cast<double>(ctx.received) / elapsed << " 帧/秒)" << endl;
+    cout << "丢失帧数        : " << static_cast<int64_t>(sim.FramesSent()) - static_cast<int64_t>(sim.FramesCorrupted()) - static_cast<int64_t>(ctx.received) << endl;
+    cout << "CRC失败率       : " << crcRate * 100 << "%" << endl;
+    cout << "重同步/丢弃字节 : " << stats.resyncs << " / " << stats.discarded << endl;
+    if (config.protocol == PROTOCOL_V2)
+    {
+        cout << "序号丢帧        : " << stats.lost << endl;
+    }
+    cout << "延迟p50/p99/p999: " << Percentile(ctx.latencies, 0.5) << " / " << Percentile(ctx.latencies, 0.99) << " / " << Percentile(ctx.latencies, 0.999) << " us" << endl;
+    cout << "解析延迟p50/p99 : " << rxStats.rxLatency.Percentile(0.5) / 1000.0 << " / " << rxStats.rxLatency.Percentile(0.99) / 1000.0 << " us" << endl;
+    cout << "发送帧数/字节   : " << txStats.txFrames << " / " << txStats.txBytes << endl;
+    cout << "下位机收到      : 正确 " << sim.HostFramesOk() << " 错误 " << sim.HostFramesBad() << endl;
+    if (txScheduled.ticks > 0)
+    {
+        cout << "定频发送        : 周期 " << txScheduled.ticks << " 发送 " << txScheduled.sent << " 重发 " << txScheduled.repeated << " 合并 " << txScheduled.coalesced
+             << " 错过 " << txScheduled.missed << " 写不下 " << txScheduled.shortWrites << endl;
+        cout << "定频唤醒p50/p99 : " << txScheduled.wakeLatency.Percentile(0.5) / 1000.0 << " / " << txScheduled.wakeLatency.Percentile(0.99) / 1000.0 << " us" << endl;
+    }
+    if (config.compact)
+    {
+        const CompactStats& cs = compact.Stats();
+        cout << "压缩编码        : " << (compact.Active() ? "已协商" : "未协商") << " 关键帧 " << cs.keyframes << " 差分帧 " << cs.deltas << " 饱和 " << cs.saturated
+             << " 下位机丢弃差分 " << sim.CompactRejected() << endl;
+    }
+    if (ping)
+    {
+        ClockSyncStats cs;
+        ClockEstimate  est;
+        clock.Snapshot(cs);
+        cout << "时钟同步        : 请求 " << cs.pings << " 回复 " << sim.PongsSent() << " 有效 " << cs.pongs << " 丢弃 " << cs.stale << endl;
+        cout << "往返p50/p99     : " << cs.rtt.Percentile(0.5) / 1000.0 << " / " << cs.rtt.Percentile(0.99) / 1000.0 << " us" << endl;
+        if (clock.Estimate(est))
+        {
+            int32_t error = static_cast<int32_t>(ClockSync::ToDeviceUs(est, McuSimulator::NowNs()) - McuSimulator::DeviceClockUs());
+            cout << "链路延迟最小/近 : " << est.minDelayNs / 1000.0 << " / " << est.delayNs / 1000.0 << " us (上行 " << est.uplinkNs / 1000.0 << " 下行 "
+                 << est.downlinkNs / 1000.0 << ")" << endl;
+            cout << "偏差估计误差    : " << error << " us" << endl;
+        }
+    }
+    if (bridgeSubs > 0)
+    {
+        static const char* readerNames[] = {"快  ", "慢  ", "不读"};
+
+        cout << "本地转发        : 提交 " << bridgeStats.published << " 队列丢弃 " << bridgeStats.queueDropped << " 送达 " << bridgeStats.sent << " 缓冲区满丢弃 "
+             << bridgeStats.dropped << " 断开 " << bridgeStats.evicted << " 拒绝 " << bridgeStats.rejected << endl;
+        for (size_t i = 0; i < bridgeResults.size(); i++)
+        {
+            BridgeResult& result = bridgeResults[i];
+            sort(result.latencies.begin(), result.latencies.end());
+            cout << "订阅者" << i << " " << readerNames[result.reader] << "    : " << (result.connected ? "" : "未连接 ") << "收到 " << result.received << " 报告丢弃 " << result.lost
+                 << " 序号缺口 " << result.gaps << (result.evicted ? " 已被断开" : "") << " 延迟p50/p99 " << Percentile(result.latencies, 0.5) << " / "
+                 << Percentile(result.latencies, 0.99) << " us" << endl;
+        }
+    }
+    if (!record.empty())
+    {
+        cout << "录制记录/字节   : " << recorder.Records() << " / " << recorder.Bytes() << " -> " << record << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file    AsyncUart.cpp
+ * @brief   Uart的协程接口
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "AsyncUart.h"
+
+#include <sys/epoll.h>
+
+FrameAwaiter<GroundChassisData>::FrameAwaiter(AsyncUart& port, int64_t timeoutNs) : port(port), timeoutNs(timeoutNs), ok(false)
+{
+    timer.expire = OnTimeout;
+    timer.user   = this;
+}
+
+/**
+ * @brief await_ready 已有未取走的新帧或串口已关闭时不挂起
+ */
+bool FrameAwaiter<GroundChassisData>::await_ready()
+{
+    if (port.fresh)
+    {
+        data       = port.latest;
+        ok         = true;
+        port.fresh = false;
+        return true;
+    }
+
+    return !port.open || timeoutNs == 0;
+}
+
+void FrameAwaiter<GroundChassisData>::await_suspend(std::coroutine_handle<> h)
+{
+    handle      = h;
+    port.reader = this;
+
+    if (timeoutNs > 0)
+    {
+        timer.deadline = MonotonicNs() + timeoutNs;
+        port.loop.AddTimer(&timer);
+    }
+}
+
+/**
+ * @brief await_resume 超时或串口关闭时返回空
+ */
+std::optional<GroundChassisData> FrameAwaiter<GroundChassisData>::await_resume()
+{
+    if (!ok)
+    {
+        return std::nullopt;
+    }
+    return data;
+}
+
+void FrameAwaiter<GroundChassisData>::OnTimeout(TimerNode* timer)
+{
+    FrameAwaiter* self = static_cast<FrameAwaiter*>(timer->user);
+    self->port.reader  = NULL;
+    self->handle.resume();
+}
+
+SendAwaiter::SendAwaiter(AsyncUart& port, const HostComputerData& data) : port(port), data(data), len(0), written(0), ok(false) {}
+
+/**
+ * @brief TryWrite 写入一帧,内核缓冲区满时记下已写出的位置,下次从该位置继续
+ * @return         是否结束(成功,或遇到EAGAIN以外的错误)
+ * @note           帧只在第一次调用时组一次,重试不会再占用发送序号或推进压缩编码的差分基准
+ */
+bool SendAwaiter::TryWrite()
+{
+    if (!port.open)
+    {
+        ok = false;
+        return true;
+    }
+
+    if (len == 0)
+    {
+        len = port.uart.EncodeTarPos(data, frame);
+    }
+
+    while (written < len)
+    {
+        ssize_t n = write(port.fd, &frame[written], len - written);
+        if (n > 0)
+        {
+            written += static_cast<size_t>(n);
+        }
+        else if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (n == -1 && errno == EAGAIN)
+        {
+            return false;
+        }
+        else
+        {
+            ok = false;
+            return true;
+        }
+    }
+
+    port.uart.CommitWrite(frame, len);
+    ok = true;
+    return true;
+}
+
+bool SendAwaiter::await_ready()
+{
+    return TryWrite();
+}
+
+void SendAwaiter::await_suspend(std::coroutine_handle<> h)
+{
+    handle      = h;
+    port.writer = this;
+    port.loop.Modify(port.fd, EPOLLIN | EPOLLOUT, &port.watch);
+}
+
+/**
+ * @brief AsyncUart 把已打开的串口注册到事件循环
+ * @param loop      事件循环
+ * @param uart      串口(协议版本、录制等设置照常生效)
+ * @param fd        打开串口的文件句柄(需为非阻塞模式,InitSerial默认如此),关闭仍由调用者负责
+ */
+AsyncUart::AsyncUart(EventLoop& loop, Uart& uart, int fd) : loop(loop), uart(uart), fd(fd), open(false), fresh(false), reader(NULL), writer(NULL)
+{
+    memset(&latest, 0, sizeof(latest));
+
+    watch.callback = OnEvent;
+    watch.user     = this;
+    open           = loop.Watch(fd, EPOLLIN, &watch);
+}
+
+AsyncUart::~AsyncUart()
+{
+    if (open)
+    {
+        loop.Unwatch(fd, &watch);
+    }
+}
+
+/**
+ * @brief Send 发送一帧上位机数据
+ */
+SendAwaiter AsyncUart::Send(const HostComputerData& data)
+{
+    return SendAwaiter(*this, data);
+}
+
+bool AsyncUart::IsOpen() const
+{
+    return open;
+}
+
+void AsyncUart::OnEvent(uint32_t events, void* user)
+{
+    AsyncUart* self = static_cast<AsyncUart*>(user);
+
+    if ((events & EPOLLOUT) && self->writer != NULL && self->writer->TryWrite())
+    {
+        SendAwaiter* writer = self->writer;
+        self->writer        = NULL;
+        self->loop.Modify(self->fd, EPOLLIN, &self->watch);
+        writer->handle.resume();
+    }
+
+    if (events & EPOLLIN)
+    {
+        self->OnReadable();
+    }
+
+    ///串口被拔出:唤醒所有等待者
+    if (events & (EPOLLHUP | EPOLLERR))
+    {
+        cout << "串口连接断开" << endl;
+        self->Close();
+    }
+}
+
+/**
+ * @brief OnReadable 读空内核缓冲区,解析出新帧时恢复等待者
+ */
+void AsyncUart::OnReadable()
+{
+    size_t before = uart.Parser().Stats().frames;
+
+    while (uart.GetMode(fd, latest) > 0)
+    {
+    }
+
+    if (uart.Parser().Stats().frames == before)
+    {
+        return;
+    }
+
+    fresh = true;
+    if (reader != NULL)
+    {
+        FrameAwaiter<GroundChassisData>* waiter = reader;
+        reader                                  = NULL;
+        loop.CancelTimer(&waiter->timer);
+
+        waiter->data = latest;
+        waiter->ok   = true;
+        fresh        = false;
+        waiter->handle.resume();
+    }
+}
+
+void AsyncUart::Close()
+{
+    if (!open)
+    {
+        return;
+    }
+
+    loop.Unwatch(fd, &watch);
+    open = false;
+
+    if (writer != NULL)
+    {
+        SendAwaiter* waiter = writer;
+        writer              = NULL;
+        waiter->ok          = false;
+        waiter->handle.resume();
+    }
+    if (reader != NULL)
+    {
+        FrameAwaiter<GroundChassisData>* waiter = reader;
+        reader                                  = NULL;
+        loop.CancelTimer(&waiter->timer);
+        waiter->handle.resume();
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @file    AsyncUart.h
+ * @brief   Uart的协程接口
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    串口fd注册到EventLoop,可读时用Uart::GetMode读空内核缓冲区,解析出新帧时恢复等待的协程;
+ *          写入时内核缓冲区满(EAGAIN)则挂起,等EPOLLOUT后从已写出的位置继续写剩余部分。
+ *          与GetMode相同,NextFrame取的是最新一帧:两次等待之间收到的多帧只保留最新的一帧,需要逐帧处理时使用解析器回调。
+ *          同一时刻每个串口只允许一个协程等待NextFrame、一个协程等待Send
+ * @example Task<void> Control(EventLoop& loop, AsyncUart& port)
+ *          {
+ *              while (true)
+ *              {
+ *                  std::optional<GroundChassisData> data = co_await port.NextFrame<GroundChassisData>(50000000);
+ *                  if (!data)
+ *                  {
+ *                      continue;  //50ms内没有收到下位机数据
+ *                  }
+ *                  co_await port.Send(Solve(*data));
+ *              }
+ *          }
+ */
+
+#ifndef ASYNCUART_H
+#define ASYNCUART_H
+
+#include "EventLoop.h"
+#include "SerialPort.h"
+
+#include <optional>
+
+class AsyncUart;
+
+///co_await port.NextFrame<T>()的等待体,只为下位机实际发送的消息类型提供特化
+template <typename T>
+class FrameAwaiter;
+
+template <>
+class FrameAwaiter<GroundChassisData>
+{
+public:
+    FrameAwaiter(AsyncUart& port, int64_t timeoutNs);
+
+    bool                             await_ready();
+    void                             await_suspend(std::coroutine_handle<> h);
+    std::optional<GroundChassisData> await_resume();
+
+private:
+    friend class AsyncUart;
+
+    static void OnTimeout(TimerNode* timer);
+
+    AsyncUart&              port;
+    int64_t                 timeoutNs;  ///<小于0表示不超时
+    TimerNode               timer;
+    std::coroutine_handle<> handle;
+    GroundChassisData       data;
+    bool                    ok;
+};
+
+///co_await port.Send(data)的等待体,结果为是否完整写入
+class SendAwaiter
+{
+public:
+    SendAwaiter(AsyncUart& port, const HostComputerData& data);
+
+    bool await_ready();
+    void await_suspend(std::coroutine_handle<> h);
+    bool await_resume() const noexcept { return ok; }
+
+private:
+    friend class AsyncUart;
+
+    bool TryWrite();
+
+    AsyncUart&              port;
+    HostComputerData        data;
+    unsigned char           frame[V2_MAX_FRAME];  ///<组好的帧,重试时不再重新组帧
+    size_t                  len;                  ///<帧长,0表示尚未组帧
+    size_t                  written;              ///<已写出的字节数
+    std::coroutine_handle<> handle;
+    bool                    ok;
+};
+
+class AsyncUart
+{
+public:
+    AsyncUart(EventLoop& loop, Uart& uart, int fd);
+    ~AsyncUart();
+
+    template <typename T>
+    FrameAwaiter<T> NextFrame(int64_t timeoutNs = -1)
+    {
+        return FrameAwaiter<T>(*this, timeoutNs);
+    }
+
+    SendAwaiter Send(const HostComputerData& data);
+    bool        IsOpen() const;
+
+private:
+    friend class FrameAwaiter<GroundChassisData>;
+    friend class SendAwaiter;
+
+    static void OnEvent(uint32_t events, void* user);
+    void        OnReadable();
+    void        Close();
+
+    EventLoop&        loop;
+    Uart&             uart;
+    int               fd;
+    bool              open;
+    IoWatch           watch;
+    GroundChassisData latest;  ///<最近一帧
+    bool              fresh;   ///<latest是否未被NextFrame取走
+
+    FrameAwaiter<GroundChassisData>* reader;  ///<等待新帧的协程
+    SendAwaiter*                     writer;  ///<等待可写的协程
+};
+
+#endif  // ASYNCUART_H
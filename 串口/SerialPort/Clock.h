@@ -0,0 +1,25 @@
+/**
+ * @file    Clock.h
+ * @brief   串口模块统一使用的单调时钟
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief MonotonicNs 单调时钟(CLOCK_MONOTONIC,ns)
+ */
+inline int64_t MonotonicNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+#endif  // CLOCK_H
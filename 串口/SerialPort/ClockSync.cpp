@@ -0,0 +1,181 @@
+/**
+ * @file    ClockSync.cpp
+ * @brief   往返延迟测量与上下位机时钟偏差估计(NTP式最小延迟滤波)
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "ClockSync.h"
+#include "FrameParser.h"
+
+#include <string.h>
+
+ClockSync::ClockSync() : parser(NULL), nextPingNs(0), pinged(false), count(0), deviceUs(0), samples(0), pings(0), pongs(0), stale(0)
+{
+    memset(window, 0, sizeof(window));
+}
+
+/**
+ * @brief SetParser 设置接收回复的解析器,以其RxTime()作为t4
+ * @note  不设置时以处理回复的时刻为t4,会把解析线程的排队时间算进下行延迟
+ */
+void ClockSync::SetParser(const FrameParser* parser)
+{
+    this->parser = parser;
+}
+
+/**
+ * @brief Due 是否该发送下一条请求
+ */
+bool ClockSync::Due(int64_t now) const
+{
+    return now >= nextPingNs;
+}
+
+/**
+ * @brief EncodePing 组一条请求,t1取当前时刻
+ * @param seq        V2发送序号
+ * @param frame      输出,至少V2_MAX_FRAME字节
+ * @return           线上帧长
+ * @note             只在发送线程调用,组好后应立即写出
+ */
+size_t ClockSync::EncodePing(uint8_t seq, unsigned char* frame)
+{
+    PingMessage ping;
+    int64_t     now = MonotonicNs();
+    ping.hostNs     = static_cast<uint64_t>(now);
+    nextPingNs      = now + CLOCK_PING_INTERVAL_NS;
+
+    pinged.store(true, std::memory_order_relaxed);
+    pings.fetch_add(1, std::memory_order_relaxed);
+
+    return EncodeMessageV2<PingPayload>(V2_MSG_PING, seq, ping, frame);
+}
+
+/**
+ * @brief OnPong V2_MSG_PONG的处理函数,注册到接收端的MessageDispatcher
+ * @param ctx    ClockSync
+ */
+void ClockSync::OnPong(const MessageV2& msg, void* ctx)
+{
+    ClockSync* self = static_cast<ClockSync*>(ctx);
+    int64_t    t4   = self->parser != NULL ? self->parser->RxTime() : 0;
+    if (t4 == 0)
+    {
+        t4 = MonotonicNs();
+    }
+
+    if (msg.length < PongPayload::SIZE || !self->pinged.load(std::memory_order_relaxed))
+    {
+        self->stale.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    PongMessage pong;
+    PongPayload::Decode(msg.payload, pong);
+    self->Update(pong, t4);
+}
+
+/**
+ * @brief Update 加入一个样本,按窗口内延迟最小的样本更新估计
+ */
+void ClockSync::Update(const PongMessage& pong, int64_t t4)
+{
+    int64_t t1        = static_cast<int64_t>(pong.hostNs);
+    int64_t roundTrip = t4 - t1;
+    int32_t hold      = static_cast<int32_t>(pong.txUs - pong.rxUs);  //下位机处理时间,32位回绕也能正确相减
+    if (roundTrip < 0 || roundTrip > CLOCK_MAX_RTT_NS || hold < 0 || static_cast<int64_t>(hold) * 1000 > roundTrip)
+    {
+        stale.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ///32位设备时间戳展开为64位
+    deviceUs = samples == 0 ? pong.rxUs : deviceUs + static_cast<int32_t>(pong.rxUs - static_cast<uint32_t>(deviceUs));
+
+    int64_t t2 = deviceUs * 1000;
+    int64_t t3 = t2 + static_cast<int64_t>(hold) * 1000;
+
+    Sample sample;
+    sample.delayNs  = roundTrip - (t3 - t2);
+    sample.offsetNs = ((t2 - t1) + (t3 - t4)) / 2;
+
+    window[count % CLOCK_WINDOW] = sample;
+    count++;
+    samples++;
+
+    ///窗口内延迟最小的样本
+    size_t        n    = count < CLOCK_WINDOW ? count : CLOCK_WINDOW;
+    const Sample* best = &window[0];
+    for (size_t i = 1; i < n; i++)
+    {
+        if (window[i].delayNs < best->delayNs)
+        {
+            best = &window[i];
+        }
+    }
+
+    ClockEstimate est;
+    est.offsetNs    = best->offsetNs;
+    est.minDelayNs  = best->delayNs;
+    est.delayNs     = sample.delayNs;
+    est.uplinkNs    = (t2 - est.offsetNs) - t1;
+    est.downlinkNs  = t4 - (t3 - est.offsetNs);
+    est.deviceRefUs = deviceUs;
+    est.updatedNs   = t4;
+    est.samples     = samples;
+    estimate.Publish(est);
+
+    pongs.fetch_add(1, std::memory_order_relaxed);
+    rtt.Record(roundTrip);
+}
+
+/**
+ * @brief Estimate 取当前的时钟估计,可在任意线程调用
+ * @return         是否已有有效样本
+ */
+bool ClockSync::Estimate(ClockEstimate& out) const
+{
+    return estimate.Read(out) != 0;
+}
+
+/**
+ * @brief Snapshot 取统计快照,可在任意线程调用
+ */
+void ClockSync::Snapshot(ClockSyncStats& out) const
+{
+    out.pings = pings.load(std::memory_order_relaxed);
+    out.pongs = pongs.load(std::memory_order_relaxed);
+    out.stale = stale.load(std::memory_order_relaxed);
+    rtt.Snapshot(out.rtt);
+}
+
+/**
+ * @brief ToHostNs 设备时间戳换算为主机时刻(MonotonicNs)
+ * @param deviceUs 下位机的32位微秒时间戳,需在参考点前后约35分钟以内
+ */
+int64_t ClockSync::ToHostNs(const ClockEstimate& est, uint32_t deviceUs)
+{
+    int64_t unwrapped = est.deviceRefUs + static_cast<int32_t>(deviceUs - static_cast<uint32_t>(est.deviceRefUs));
+    return unwrapped * 1000 - est.offsetNs;
+}
+
+/**
+ * @brief ToDeviceUs 主机时刻换算为下位机的32位微秒时间戳(如指令的生效时刻)
+ */
+uint32_t ClockSync::ToDeviceUs(const ClockEstimate& est, int64_t hostNs)
+{
+    return static_cast<uint32_t>((hostNs + est.offsetNs) / 1000);
+}
+
+/**
+ * @brief FrameAgeNs 估计一帧不带时间戳的下位机数据的年龄
+ * @param rxNs       该帧的读取时刻
+ * @param now        当前时刻
+ * @return           now - 下位机发出该帧的时刻,下行延迟按最小往返延迟的一半计
+ */
+int64_t ClockSync::FrameAgeNs(const ClockEstimate& est, int64_t rxNs, int64_t now)
+{
+    return now - rxNs + est.minDelayNs / 2;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file    ClockSync.h
+ * @brief   往返延迟测量与上下位机时钟偏差估计(NTP式最小延迟滤波)
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    上位机每CLOCK_PING_INTERVAL_NS发送一条V2_MSG_PING | t1(u64,主机ns) |,
+ *          下位机回复V2_MSG_PONG | t1(原样返回) | t2(u32,收到请求的设备时刻us) | t3(u32,发出回复的设备时刻us) |,
+ *          上位机以回复被读到的时刻为t4(FrameParser::RxTime)。每次往返得到一个样本:
+ *              链路延迟 delay  = (t4 - t1) - (t3 - t2)             (扣除下位机的处理时间)
+ *              时钟偏差 offset = ((t2 - t1) + (t3 - t4)) / 2       (设备时刻 = 主机时刻 + offset)
+ *          排队、重发、线程被抢占只会让延迟变大,延迟最小的样本最接近对称假设,
+ *          因此取最近CLOCK_WINDOW个样本中延迟最小者的offset作为估计;窗口约1.6秒,晶振漂移的影响在微秒级。
+ *          有了offset,每条回复都能拆成上行/下行两个单向延迟,带设备时间戳的消息可换算成主机时间;
+ *          不带时间戳的GroundChassisData用读取时刻(UartReceiver::GetMode的rxNs)加上下行延迟估计其年龄。
+ *          t1为编码时刻,请求排在同一次写入的最前面,不受同批其他帧的串行化时间影响。
+ *          设备时间戳为32位微秒计数,约71分钟回绕一次,换算时按距参考点最近的方向展开
+ * @example ClockSync         clock;
+ *          dispatcher.Register(V2_MSG_PONG, ClockSync::OnPong, &clock);
+ *          clock.SetParser(&receiver.Parser());
+ *          InfoPort.SetClockSync(&clock);    //发送目标时按间隔附带请求
+ *          ClockEstimate est;
+ *          if (clock.Estimate(est))
+ *              age = ClockSync::FrameAgeNs(est, rxNs, MonotonicNs());
+ */
+
+#ifndef CLOCKSYNC_H
+#define CLOCKSYNC_H
+
+#include "Mailbox.h"
+#include "ProtocolV2.h"
+#include "UartStats.h"
+
+class FrameParser;
+
+#define CLOCK_PING_INTERVAL_NS 100000000LL  ///发送请求的间隔(ns)
+#define CLOCK_WINDOW           16           ///最小延迟滤波的窗口(样本数)
+#define CLOCK_MAX_RTT_NS       200000000LL  ///往返超过该时间的回复视为过期,丢弃
+
+///V2_MSG_PING | t1 |
+typedef struct
+{
+    uint64_t hostNs;
+} PingMessage;
+
+///V2_MSG_PONG | t1 | t2 | t3 |
+typedef struct
+{
+    uint64_t hostNs;  ///<请求中的t1
+    uint32_t rxUs;    ///<t2
+    uint32_t txUs;    ///<t3
+} PongMessage;
+
+typedef PayloadSchema<PingMessage,
+                      Field<&PingMessage::hostNs>>
+    PingPayload;
+
+typedef PayloadSchema<PongMessage,
+                      Field<&PongMessage::hostNs>,
+                      Field<&PongMessage::rxUs>,
+                      Field<&PongMessage::txUs>>
+    PongPayload;
+
+///当前的时钟估计,由接收线程发布,任意线程读取
+typedef struct
+{
+    int64_t offsetNs;     ///<设备时刻 - 主机时刻
+    int64_t minDelayNs;   ///<窗口内最小链路往返延迟
+    int64_t delayNs;      ///<最近一次链路往返延迟
+    int64_t uplinkNs;     ///<最近一次 上位机->下位机 单向延迟
+    int64_t downlinkNs;   ///<最近一次 下位机->上位机 单向延迟
+    int64_t deviceRefUs;  ///<最近一次回复的设备时刻(展开后),用于展开32位时间戳
+    int64_t updatedNs;    ///<最近一次更新的主机时刻
+    int64_t samples;      ///<累计有效样本数
+} ClockEstimate;
+
+typedef struct
+{
+    uint64_t        pings;  ///<发出的请求数
+    uint64_t        pongs;  ///<有效回复数
+    uint64_t        stale;  ///<过期或时间戳不合理而丢弃的回复数
+    LatencySnapshot rtt;    ///<往返时间t4 - t1(含下位机处理时间)
+} ClockSyncStats;
+
+class ClockSync
+{
+public:
+    ClockSync();
+
+    void   SetParser(const FrameParser* parser);
+    bool   Due(int64_t now) const;
+    size_t EncodePing(uint8_t seq, unsigned char* frame);
+    bool   Estimate(ClockEstimate& out) const;
+    void   Snapshot(ClockSyncStats& out) const;
+
+    static void     OnPong(const MessageV2& msg, void* ctx);
+    static int64_t  ToHostNs(const ClockEstimate& est, uint32_t deviceUs);
+    static uint32_t ToDeviceUs(const ClockEstimate& est, int64_t hostNs);
+    static int64_t  FrameAgeNs(const ClockEstimate& est, int64_t rxNs, int64_t now);
+
+private:
+    typedef struct
+    {
+        int64_t delayNs;
+        int64_t offsetNs;
+    } Sample;
+
+    void Update(const PongMessage& pong, int64_t t4);
+
+    const FrameParser* parser;      ///<取回复的读取时刻,NULL时用处理时刻
+    int64_t            nextPingNs;  ///<只在发送线程访问
+    std::atomic<bool>  pinged;      ///<是否发过请求,之前收到的回复一律丢弃
+
+    Sample  window[CLOCK_WINDOW];  ///<以下只在接收线程访问
+    size_t  count;
+    int64_t deviceUs;              ///<展开后的上一次t2
+    int64_t samples;
+
+    LatestValue<ClockEstimate> estimate;
+    std::atomic<uint64_t>      pings;
+    std::atomic<uint64_t>      pongs;
+    std::atomic<uint64_t>      stale;
+    LatencyHistogram           rtt;
+};
+
+#endif  // CLOCKSYNC_H
@@ -0,0 +1,78 @@
+/**
+ * @file    Cobs.cpp
+ * @brief   COBS(Consistent Overhead Byte Stuffing)编解码
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "Cobs.h"
+
+#include <string.h>
+
+/**
+ * @brief CobsEncode 编码
+ * @param in         原始数据
+ * @param len        原始数据长度
+ * @param out        输出,至少COBS_MAX_ENCODED(len)字节,不写分隔符
+ * @return           编码后的长度
+ */
+size_t CobsEncode(const unsigned char* in, size_t len, unsigned char* out)
+{
+    size_t code = 0;  //当前段长度字节的位置
+    size_t pos  = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            out[code] = static_cast<unsigned char>(pos - code);
+            code      = pos++;
+            continue;
+        }
+
+        out[pos++] = in[i];
+        if (pos - code == 0xFF)
+        {
+            out[code] = 0xFF;
+            code      = pos++;
+        }
+    }
+    out[code] = static_cast<unsigned char>(pos - code);
+
+    return pos;
+}
+
+/**
+ * @brief CobsDecode 解码
+ * @param in         编码数据(不含分隔符)
+ * @param len        编码数据长度
+ * @param out        输出,至少len字节,可以与in相同(原地解码)
+ * @return           解码后的长度,数据不合法时返回0
+ */
+size_t CobsDecode(const unsigned char* in, size_t len, unsigned char* out)
+{
+    size_t pos = 0;
+    size_t n   = 0;
+
+    while (pos < len)
+    {
+        size_t code = in[pos];
+        if (code == 0 || pos + code > len)
+        {
+            return 0;
+        }
+
+        ///段内数据不含0,整段拷贝
+        memmove(&out[n], &in[pos + 1], code - 1);
+        n += code - 1;
+        pos += code;
+
+        if (code != 0xFF && pos < len)
+        {
+            out[n++] = 0;
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,22 @@
+/**
+ * @file    Cobs.h
+ * @brief   COBS(Consistent Overhead Byte Stuffing)编解码
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    编码后的数据中不含0x00,0x00只作为帧分隔符出现,接收端看到0x00即可确定帧边界。
+ *          开销固定为每254字节最多1字节
+ */
+
+#ifndef COBS_H
+#define COBS_H
+
+#include <stddef.h>
+
+///长度为n的数据编码后的最大长度(不含分隔符)
+#define COBS_MAX_ENCODED(n) ((n) + (n) / 254 + 1)
+
+size_t CobsEncode(const unsigned char* in, size_t len, unsigned char* out);
+size_t CobsDecode(const unsigned char* in, size_t len, unsigned char* out);
+
+#endif  // COBS_H
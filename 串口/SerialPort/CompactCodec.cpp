@@ -0,0 +1,323 @@
+/**
+ * @file    CompactCodec.cpp
+ * @brief   上位机数据的压缩编码:定点量化 + 差分 + 周期关键帧,按链路协商启用
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "CompactCodec.h"
+#include "Clock.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Quantize 量化并饱和
+ * @param saturated 超出范围时置为true
+ */
+static int32_t Quantize(float value, float step, int32_t lo, int32_t hi, bool& saturated)
+{
+    if (!(step > 0) || value != value)
+    {
+        saturated = true;
+        return 0;
+    }
+
+    float q = roundf(value / step);
+    if (q < static_cast<float>(lo))
+    {
+        saturated = true;
+        return lo;
+    }
+    if (q > static_cast<float>(hi))
+    {
+        saturated = true;
+        return hi;
+    }
+
+    return static_cast<int32_t>(q);
+}
+
+static void Dequantize(const CompactSample& q, const CompactConfig& config, HostComputerData& data)
+{
+    data.pitch.f    = static_cast<float>(q.pitch) * config.angleStep;
+    data.yaw.f      = static_cast<float>(q.yaw) * config.angleStep;
+    data.distance.f = static_cast<float>(q.distance) * config.distanceStep;
+}
+
+/**
+ * @brief EncodeCompactOffer 组一条协商消息(请求或回复)
+ * @param id                 V2_MSG_COMPACT_OFFER或V2_MSG_COMPACT_ACCEPT
+ * @param version            COMPACT_VERSION,回复0表示拒绝
+ * @param frame              输出,至少V2_MAX_FRAME字节
+ * @return                   线上帧长
+ */
+size_t EncodeCompactOffer(uint8_t id, uint8_t seq, uint8_t version, const CompactConfig& config, unsigned char* frame)
+{
+    CompactOffer offer;
+    offer.version          = version;
+    offer.angleStep        = config.angleStep;
+    offer.distanceStep     = config.distanceStep;
+    offer.keyframeInterval = config.keyframeInterval;
+
+    return EncodeMessageV2<CompactOfferPayload>(id, seq, offer, frame);
+}
+
+/**
+ * @brief DecodeCompactOffer 解出协商消息
+ * @return                   长度是否足够;拒绝消息可以只有版本号
+ */
+bool DecodeCompactOffer(const MessageV2& msg, CompactOffer& offer)
+{
+    memset(&offer, 0, sizeof(offer));
+
+    if (msg.length >= CompactOfferPayload::SIZE)
+    {
+        CompactOfferPayload::Decode(msg.payload, offer);
+        return true;
+    }
+
+    ///只带版本号的拒绝消息
+    if (msg.length >= 1 && msg.payload[0] == 0)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief CompactOfferMatches 协商消息是否以当前版本同意了给定的参数
+ */
+bool CompactOfferMatches(const CompactOffer& offer, const CompactConfig& config)
+{
+    return offer.version == COMPACT_VERSION && offer.angleStep == config.angleStep && offer.distanceStep == config.distanceStep &&
+           offer.keyframeInterval == config.keyframeInterval;
+}
+
+CompactEncoder::CompactEncoder(const CompactConfig& config) : config(config)
+{
+    memset(&stats, 0, sizeof(stats));
+    Reset();
+}
+
+/**
+ * @brief Reset 丢弃差分基准,下一帧发送关键帧
+ */
+void CompactEncoder::Reset()
+{
+    memset(&state, 0, sizeof(state));
+    valid    = false;
+    sinceKey = 0;
+}
+
+/**
+ * @brief Encode 编码一帧,自动选择关键帧或差分帧
+ * @param seq    V2序号
+ * @param frame  输出,至少V2_MAX_FRAME字节
+ * @return       线上帧长
+ */
+size_t CompactEncoder::Encode(const HostComputerData& data, uint8_t seq, unsigned char* frame)
+{
+    bool          saturated = false;
+    CompactSample q;
+    q.pitch    = static_cast<int16_t>(Quantize(data.pitch.f, config.angleStep, -32767, 32767, saturated));
+    q.yaw      = static_cast<int16_t>(Quantize(data.yaw.f, config.angleStep, -32767, 32767, saturated));
+    q.distance = static_cast<uint16_t>(Quantize(data.distance.f, config.distanceStep, 0, 65535, saturated));
+    if (saturated)
+    {
+        stats.saturated++;
+    }
+
+    int32_t dp = q.pitch - state.pitch;
+    int32_t dy = q.yaw - state.yaw;
+    int32_t dd = q.distance - state.distance;
+
+    bool key = !valid || sinceKey + 1 >= config.keyframeInterval || dp < -128 || dp > 127 || dy < -128 || dy > 127 || dd < -128 || dd > 127;
+
+    state = q;
+    valid = true;
+
+    if (key)
+    {
+        sinceKey = 0;
+        stats.keyframes++;
+        return EncodeMessageV2<CompactKeyPayload>(V2_MSG_HOST_KEY, seq, q, frame);
+    }
+
+    CompactDelta delta;
+    delta.pitch    = static_cast<int8_t>(dp);
+    delta.yaw      = static_cast<int8_t>(dy);
+    delta.distance = static_cast<int8_t>(dd);
+
+    sinceKey++;
+    stats.deltas++;
+    return EncodeMessageV2<CompactDeltaPayload>(V2_MSG_HOST_DELTA, seq, delta, frame);
+}
+
+const CompactConfig& CompactEncoder::Config() const
+{
+    return config;
+}
+
+const CompactStats& CompactEncoder::Stats() const
+{
+    return stats;
+}
+
+CompactDecoder::CompactDecoder(const CompactConfig& config) : config(config)
+{
+    memset(&stats, 0, sizeof(stats));
+    Reset();
+}
+
+void CompactDecoder::Reset()
+{
+    memset(&state, 0, sizeof(state));
+    valid   = false;
+    lastSeq = 0;
+}
+
+/**
+ * @brief SetConfig 更换量化参数(重新协商),同时丢弃差分基准
+ */
+void CompactDecoder::SetConfig(const CompactConfig& config)
+{
+    this->config = config;
+    Reset();
+}
+
+/**
+ * @brief Decode 解出一帧压缩消息
+ * @param msg    收到的每一条V2消息都应交给Decode:其他消息不产生结果,只用于检查序号是否连续
+ * @param data   输出,失败时不修改
+ * @return       是否得到新的目标
+ */
+bool CompactDecoder::Decode(const MessageV2& msg, HostComputerData& data)
+{
+    ///与上一条消息(任何类型)序号不连续:中间丢过帧,差分基准失效
+    if (msg.seq != static_cast<uint8_t>(lastSeq + 1))
+    {
+        valid = false;
+    }
+    lastSeq = msg.seq;
+
+    if (msg.id == V2_MSG_HOST_KEY && msg.length >= CompactKeyPayload::SIZE)
+    {
+        CompactKeyPayload::Decode(msg.payload, state);
+        valid = true;
+        stats.keyframes++;
+
+        Dequantize(state, config, data);
+        return true;
+    }
+
+    if (msg.id == V2_MSG_HOST_DELTA && msg.length >= CompactDeltaPayload::SIZE)
+    {
+        ///没有基准或中间丢过帧:等待下一个关键帧
+        if (!valid)
+        {
+            stats.rejected++;
+            return false;
+        }
+
+        CompactDelta delta;
+        CompactDeltaPayload::Decode(msg.payload, delta);
+        state.pitch    = static_cast<int16_t>(state.pitch + delta.pitch);
+        state.yaw      = static_cast<int16_t>(state.yaw + delta.yaw);
+        state.distance = static_cast<uint16_t>(state.distance + delta.distance);
+        stats.deltas++;
+
+        Dequantize(state, config, data);
+        return true;
+    }
+
+    return false;
+}
+
+const CompactStats& CompactDecoder::Stats() const
+{
+    return stats;
+}
+
+CompactLink::CompactLink(const CompactConfig& config) : encoder(config), accepted(false), generation(0), encodedGeneration(0), nextOfferNs(0) {}
+
+/**
+ * @brief Encode 按协商状态组帧:协商成功前为完整的V2_MSG_HOST(定期附带协商请求),之后为压缩帧
+ * @param seq    V2发送序号,按实际发出的消息数递增
+ * @param frame  输出,至少V2_MAX_FRAME字节
+ * @return       线上字节数(附带协商请求时为两帧之和)
+ * @note         只在发送线程调用
+ */
+size_t CompactLink::Encode(const HostComputerData& data, uint8_t& seq, unsigned char* frame)
+{
+    if (accepted.load(std::memory_order_acquire))
+    {
+        uint32_t current = generation.load(std::memory_order_acquire);
+        if (current != encodedGeneration)
+        {
+            encoder.Reset();
+            encodedGeneration = current;
+        }
+        return encoder.Encode(data, seq++, frame);
+    }
+
+    size_t len = EncodeMessageV2<HostPayloadV2>(V2_MSG_HOST, seq++, data, frame);
+
+    int64_t now = MonotonicNs();
+    if (now >= nextOfferNs)
+    {
+        len += EncodeCompactOffer(V2_MSG_COMPACT_OFFER, seq++, COMPACT_VERSION, encoder.Config(), &frame[len]);
+        nextOfferNs = now + COMPACT_OFFER_INTERVAL_NS;
+    }
+
+    return len;
+}
+
+/**
+ * @brief Active 是否已协商为压缩编码
+ */
+bool CompactLink::Active() const
+{
+    return accepted.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Reset 退回完整帧并重新协商
+ */
+void CompactLink::Reset()
+{
+    accepted.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief Stats 编码统计,只在发送线程读取
+ */
+const CompactStats& CompactLink::Stats() const
+{
+    return encoder.Stats();
+}
+
+/**
+ * @brief OnAccept V2_MSG_COMPACT_ACCEPT的处理函数,注册到接收端的MessageDispatcher
+ * @param ctx      CompactLink
+ * @note           下位机回复的参数与请求不一致时视为拒绝
+ */
+void CompactLink::OnAccept(const MessageV2& msg, void* ctx)
+{
+    CompactLink* self = static_cast<CompactLink*>(ctx);
+
+    CompactOffer offer;
+    bool         ok = DecodeCompactOffer(msg, offer) && CompactOfferMatches(offer, self->encoder.Config());
+
+    if (ok && !self->accepted.load(std::memory_order_acquire))
+    {
+        self->generation.fetch_add(1, std::memory_order_release);
+        self->accepted.store(true, std::memory_order_release);
+    }
+    else if (!ok)
+    {
+        self->accepted.store(false, std::memory_order_release);
+    }
+}
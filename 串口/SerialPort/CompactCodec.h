@@ -0,0 +1,158 @@
+/**
+ * @file    CompactCodec.h
+ * @brief   上位机数据的压缩编码:定点量化 + 差分 + 周期关键帧,按链路协商启用
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    pitch/yaw按angleStep、distance按distanceStep量化为整数:
+ *          关键帧 V2_MSG_HOST_KEY   | pitch(i16) | yaw(i16) | distance(u16) |   6字节数据,线上14字节
+ *          差分帧 V2_MSG_HOST_DELTA | dpitch(i8) | dyaw(i8) | ddistance(i8) | 3字节数据,线上11字节
+ *          (完整的V2_MSG_HOST线上20字节,V1帧14字节;115200波特率下约1000帧/秒,V1约820帧/秒)。
+ *          差分量是与上一帧量化值之差,两端都只保存整数状态,不会累积误差;
+ *          任一差分超出i8、或距上一个关键帧已有keyframeInterval帧时发送关键帧。
+ *          量化超出i16/u16范围时饱和(angleStep=0.01时角度范围为±327.67)。
+ *          解码端只在序号与上一条消息(任何类型,如夹在中间的时钟同步请求)连续时应用差分,中间丢过帧则等待下一个关键帧,不会用错误的基准。
+ *          协商:上位机每COMPACT_OFFER_INTERVAL_NS在完整帧后附带一条V2_MSG_COMPACT_OFFER,
+ *          下位机原样回复参数(V2_MSG_COMPACT_ACCEPT)后切换为压缩帧;下位机回复版本0(例如重启后收到差分帧)时退回完整帧并重新协商。
+ *          只用于PROTOCOL_V2:V1没有消息ID,下位机无法回复协商结果。
+ *          下位机参考实现见 串口/McuReference/compact_decoder.c
+ * @example CompactConfig     config = {0.01f, 1.0f, 50};
+ *          CompactLink       link(config);
+ *          MessageDispatcher dispatcher;
+ *          dispatcher.Register(V2_MSG_COMPACT_ACCEPT, CompactLink::OnAccept, &link);
+ *          receiver.Parser().SetDispatcher(&dispatcher);
+ *          InfoPort.SetCompact(&link);
+ */
+
+#ifndef COMPACTCODEC_H
+#define COMPACTCODEC_H
+
+#include "ProtocolV2.h"
+
+#include <atomic>
+
+#define COMPACT_VERSION           1            ///压缩编码版本,协商时交换
+#define COMPACT_OFFER_INTERVAL_NS 100000000LL  ///未协商成功时发送请求的间隔(ns)
+
+typedef struct
+{
+    float   angleStep;         ///<pitch/yaw量化步长(与角度同单位)
+    float   distanceStep;      ///<distance量化步长(mm)
+    uint8_t keyframeInterval;  ///<关键帧间隔(帧),0或1表示只发关键帧
+} CompactConfig;
+
+///量化后的数据,也是两端保存的差分基准
+typedef struct
+{
+    int16_t  pitch;
+    int16_t  yaw;
+    uint16_t distance;
+} CompactSample;
+
+typedef struct
+{
+    int8_t pitch;
+    int8_t yaw;
+    int8_t distance;
+} CompactDelta;
+
+///协商消息 | 版本 | angleStep | distanceStep | keyframeInterval |
+typedef struct
+{
+    uint8_t version;  ///<0表示拒绝/退出压缩编码
+    float   angleStep;
+    float   distanceStep;
+    uint8_t keyframeInterval;
+} CompactOffer;
+
+typedef PayloadSchema<CompactOffer,
+                      Field<&CompactOffer::version>,
+                      Field<&CompactOffer::angleStep>,
+                      Field<&CompactOffer::distanceStep>,
+                      Field<&CompactOffer::keyframeInterval>>
+    CompactOfferPayload;
+
+typedef PayloadSchema<CompactSample,
+                      Field<&CompactSample::pitch>,
+                      Field<&CompactSample::yaw>,
+                      Field<&CompactSample::distance>>
+    CompactKeyPayload;
+
+typedef PayloadSchema<CompactDelta,
+                      Field<&CompactDelta::pitch>,
+                      Field<&CompactDelta::yaw>,
+                      Field<&CompactDelta::distance>>
+    CompactDeltaPayload;
+
+typedef struct
+{
+    uint64_t keyframes;  ///<关键帧数
+    uint64_t deltas;     ///<差分帧数
+    uint64_t saturated;  ///<编码端量化饱和次数
+    uint64_t rejected;   ///<解码端因缺少基准而丢弃的差分帧数
+} CompactStats;
+
+size_t EncodeCompactOffer(uint8_t id, uint8_t seq, uint8_t version, const CompactConfig& config, unsigned char* frame);
+bool   DecodeCompactOffer(const MessageV2& msg, CompactOffer& offer);
+bool   CompactOfferMatches(const CompactOffer& offer, const CompactConfig& config);
+
+class CompactEncoder
+{
+public:
+    explicit CompactEncoder(const CompactConfig& config);
+
+    void   Reset();
+    size_t Encode(const HostComputerData& data, uint8_t seq, unsigned char* frame);
+
+    const CompactConfig& Config() const;
+    const CompactStats&  Stats() const;
+
+private:
+    CompactConfig config;
+    CompactSample state;     ///<解码端当前的基准
+    bool          valid;     ///<是否已发过关键帧
+    uint8_t       sinceKey;  ///<距上一个关键帧的帧数
+    CompactStats  stats;
+};
+
+class CompactDecoder
+{
+public:
+    explicit CompactDecoder(const CompactConfig& config);
+
+    void Reset();
+    void SetConfig(const CompactConfig& config);
+    bool Decode(const MessageV2& msg, HostComputerData& data);
+
+    const CompactStats& Stats() const;
+
+private:
+    CompactConfig config;
+    CompactSample state;
+    bool          valid;    ///<是否有可用的基准
+    uint8_t       lastSeq;  ///<上一条消息的序号
+    CompactStats  stats;
+};
+
+class CompactLink
+{
+public:
+    explicit CompactLink(const CompactConfig& config);
+
+    size_t Encode(const HostComputerData& data, uint8_t& seq, unsigned char* frame);
+    bool   Active() const;
+    void   Reset();
+
+    const CompactStats& Stats() const;
+
+    static void OnAccept(const MessageV2& msg, void* ctx);
+
+private:
+    CompactEncoder        encoder;            ///<只在发送线程使用
+    std::atomic<bool>     accepted;           ///<下位机是否同意,由接收线程设置
+    std::atomic<uint32_t> generation;         ///<每次协商成功加1
+    uint32_t              encodedGeneration;  ///<编码器基准对应的协商
+    int64_t               nextOfferNs;        ///<下一次发送协商请求的时刻
+};
+
+#endif  // COMPACTCODEC_H
@@ -0,0 +1,175 @@
+/**
+ * @file    Crc.cpp
+ * @brief   CRC32C硬件加速内核与运行时分派
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    CLMUL内核:数据按CRC32C_BLOCK字节分成三路,crc32指令三路交错计算以隐藏指令延迟,
+ *          再用PCLMULQDQ把前两路的结果"平移"到块尾合并:
+ *          crc(A|B|C) = crc(A)·x^(16*BLOCK) ⊕ crc(B)·x^(8*BLOCK) ⊕ crc(C)
+ */
+
+#include "Crc.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC32C_X86 1
+#endif
+
+#define CRC32C_BLOCK 256  ///三路并行时每一路的字节数
+
+/**
+ * @brief Crc32cXPow 计算x^n mod P(反射表示),用于CLMUL合并常数
+ */
+static constexpr uint32_t Crc32cXPow(uint32_t n)
+{
+    uint32_t v = 0x80000000u;  //反射表示下的x^0
+    for (uint32_t i = 0; i < n; i++)
+    {
+        v = (v & 1) ? ((v >> 1) ^ 0x82F63B78u) : (v >> 1);
+    }
+    return v;
+}
+
+///clmul(a, K)得到a·K·x,再经crc32_u64(0, ·)乘x^32取模,因此K = x^(8n-33) mod P
+static constexpr uint32_t CRC32C_K1 = Crc32cXPow(8 * CRC32C_BLOCK - 33);
+static constexpr uint32_t CRC32C_K2 = Crc32cXPow(16 * CRC32C_BLOCK - 33);
+
+static uint32_t Crc32cSlice8(uint32_t reg, const void* data, size_t len)
+{
+    return Crc32cSoft::UpdateSlice8(reg, data, len);
+}
+
+#ifdef CRC32C_X86
+__attribute__((target("sse4.2"))) static uint32_t Crc32cSse42(uint32_t reg, const void* data, size_t len)
+{
+    const uint8_t* p   = static_cast<const uint8_t*>(data);
+    uint64_t       crc = reg;
+
+    for (; len >= 8; len -= 8, p += 8)
+    {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = _mm_crc32_u64(crc, v);
+    }
+
+    uint32_t crc32 = static_cast<uint32_t>(crc);
+    for (; len > 0; len--, p++)
+    {
+        crc32 = _mm_crc32_u8(crc32, *p);
+    }
+
+    return crc32;
+}
+
+__attribute__((target("sse4.2,pclmul"))) static uint32_t Crc32cClmul(uint32_t reg, const void* data, size_t len)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+
+    while (len >= 3 * CRC32C_BLOCK)
+    {
+        uint64_t crcA = reg;
+        uint64_t crcB = 0;
+        uint64_t crcC = 0;
+
+        for (size_t i = 0; i < CRC32C_BLOCK; i += 8)
+        {
+            uint64_t a, b, c;
+            memcpy(&a, p + i, 8);
+            memcpy(&b, p + CRC32C_BLOCK + i, 8);
+            memcpy(&c, p + 2 * CRC32C_BLOCK + i, 8);
+            crcA = _mm_crc32_u64(crcA, a);
+            crcB = _mm_crc32_u64(crcB, b);
+            crcC = _mm_crc32_u64(crcC, c);
+        }
+
+        __m128i shiftA = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crcA)), _mm_cvtsi32_si128(static_cast<int>(CRC32C_K2)), 0x00);
+        __m128i shiftB = _mm_clmulepi64_si128(_mm_cvtsi32_si128(static_cast<int>(crcB)), _mm_cvtsi32_si128(static_cast<int>(CRC32C_K1)), 0x00);
+        uint64_t folded = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_xor_si128(shiftA, shiftB)));
+
+        reg = static_cast<uint32_t>(_mm_crc32_u64(0, folded) ^ crcC);
+        p += 3 * CRC32C_BLOCK;
+        len -= 3 * CRC32C_BLOCK;
+    }
+
+    return Crc32cSse42(reg, p, len);
+}
+#endif
+
+typedef uint32_t (*Crc32cFunc)(uint32_t reg, const void* data, size_t len);
+
+/**
+ * @brief Crc32cDetect 根据CPU特性选择最快的内核
+ */
+static Crc32cKernel Crc32cDetect()
+{
+#ifdef CRC32C_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        return __builtin_cpu_supports("pclmul") ? CRC32C_CLMUL : CRC32C_SSE42;
+    }
+#endif
+    return CRC32C_SLICE8;
+}
+
+static Crc32cFunc Crc32cSelect(Crc32cKernel kernel)
+{
+#ifdef CRC32C_X86
+    switch (kernel)
+    {
+    case CRC32C_CLMUL:
+        return Crc32cClmul;
+    case CRC32C_SSE42:
+        return Crc32cSse42;
+    default:
+        break;
+    }
+#endif
+    (void)kernel;
+    return Crc32cSlice8;
+}
+
+static Crc32cKernel activeKernel = Crc32cDetect();
+static Crc32cFunc   activeFunc   = Crc32cSelect(activeKernel);
+
+/**
+ * @brief Crc32cUpdate 增量计算CRC32C(寄存器值,未异或XOROUT)
+ * @param reg          寄存器值,首次为Crc32cSoft::Begin()
+ * @param data         数据首地址
+ * @param len          数据长度
+ * @return             新的寄存器值
+ */
+uint32_t Crc32cUpdate(uint32_t reg, const void* data, size_t len)
+{
+    return activeFunc(reg, data, len);
+}
+
+/**
+ * @brief Crc32c 计算一段数据的CRC32C
+ */
+uint32_t Crc32c(const void* data, size_t len)
+{
+    return Crc32cSoft::Finish(activeFunc(Crc32cSoft::Begin(), data, len));
+}
+
+Crc32cKernel Crc32cActiveKernel()
+{
+    return activeKernel;
+}
+
+/**
+ * @brief Crc32cSetKernel 强制指定内核(用于测速对比),CPU不支持时退回CPU支持的最快内核
+ * @note  非线程安全,需在开始计算前调用;枚举值按速度递增排列,如只支持SSE4.2时请求CLMUL得到SSE42
+ */
+void Crc32cSetKernel(Crc32cKernel kernel)
+{
+    Crc32cKernel best = Crc32cDetect();
+    if (kernel > best)
+    {
+        kernel = best;
+    }
+
+    activeKernel = kernel;
+    activeFunc   = Crc32cSelect(kernel);
+}
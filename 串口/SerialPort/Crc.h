@@ -0,0 +1,216 @@
+/**
+ * @file    Crc.h
+ * @brief   编译期生成查找表的通用CRC引擎
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    参数模型同Rocksoft(WIDTH/POLY/INIT/REFIN=REFOUT/XOROUT),查找表在编译期由多项式生成,
+ *          提供逐字节、slicing-by-4、slicing-by-8三种查表内核;
+ *          CRC32C另有SSE4.2 crc32指令与PCLMULQDQ三路并行内核,运行时根据CPU自动选择
+ */
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+template <int Width, uint32_t Poly, uint32_t Init, bool Reflect, uint32_t XorOut>
+class CrcEngine
+{
+    static_assert(Width >= 8 && Width <= 32, "CRC位宽需在8~32之间");
+
+public:
+    static constexpr uint32_t MASK = Width == 32 ? 0xffffffffu : ((1u << Width) - 1);
+
+    ///slicing-by-8查找表:table[k][b]为字节b后跟k个0字节的CRC余数
+    struct Tables
+    {
+        uint32_t t[8][256];
+    };
+
+    /**
+     * @brief Begin 初始寄存器值
+     */
+    static constexpr uint32_t Begin()
+    {
+        return Reflect ? ReflectBits(Init, Width) : (Init << (32 - Width));
+    }
+
+    /**
+     * @brief Finish 由寄存器值得到最终CRC
+     */
+    static constexpr uint32_t Finish(uint32_t reg)
+    {
+        return ((Reflect ? reg : (reg >> (32 - Width))) ^ XorOut) & MASK;
+    }
+
+    /**
+     * @brief Compute 计算一段数据的CRC
+     * @param data    数据首地址
+     * @param len     数据长度
+     * @return        CRC值
+     */
+    static uint32_t Compute(const void* data, size_t len)
+    {
+        return Finish(Update(Begin(), data, len));
+    }
+
+    /**
+     * @brief Update 增量计算,自动选择内核
+     * @note  短数据逐字节,16字节以上使用slicing-by-8
+     */
+    static uint32_t Update(uint32_t reg, const void* data, size_t len)
+    {
+        return len < 16 ? UpdateBytewise(reg, data, len) : UpdateSlice8(reg, data, len);
+    }
+
+    static uint32_t UpdateBytewise(uint32_t reg, const void* data, size_t len)
+    {
+        return UpdateBytewise(reg, static_cast<const uint8_t*>(data), len);
+    }
+
+    static constexpr uint32_t UpdateBytewise(uint32_t reg, const uint8_t* p, size_t len)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            reg = Step(reg, p[i]);
+        }
+        return reg;
+    }
+
+    static uint32_t UpdateSlice4(uint32_t reg, const void* data, size_t len)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const auto&    t = table.t;
+
+        for (; len >= 4; len -= 4, p += 4)
+        {
+            uint32_t x = reg ^ Load32(p);
+            if (Reflect)
+            {
+                reg = t[3][x & 0xff] ^ t[2][(x >> 8) & 0xff] ^ t[1][(x >> 16) & 0xff] ^ t[0][x >> 24];
+            }
+            else
+            {
+                reg = t[3][x >> 24] ^ t[2][(x >> 16) & 0xff] ^ t[1][(x >> 8) & 0xff] ^ t[0][x & 0xff];
+            }
+        }
+
+        return UpdateBytewise(reg, p, len);
+    }
+
+    static uint32_t UpdateSlice8(uint32_t reg, const void* data, size_t len)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const auto&    t = table.t;
+
+        for (; len >= 8; len -= 8, p += 8)
+        {
+            uint32_t x = reg ^ Load32(p);
+            if (Reflect)
+            {
+                reg = t[7][x & 0xff] ^ t[6][(x >> 8) & 0xff] ^ t[5][(x >> 16) & 0xff] ^ t[4][x >> 24];
+            }
+            else
+            {
+                reg = t[7][x >> 24] ^ t[6][(x >> 16) & 0xff] ^ t[5][(x >> 8) & 0xff] ^ t[4][x & 0xff];
+            }
+            reg ^= t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        }
+
+        return UpdateBytewise(reg, p, len);
+    }
+
+private:
+    static constexpr uint32_t ReflectBits(uint32_t v, int bits)
+    {
+        uint32_t r = 0;
+        for (int i = 0; i < bits; i++)
+        {
+            r = (r << 1) | ((v >> i) & 1);
+        }
+        return r;
+    }
+
+    static constexpr Tables MakeTables()
+    {
+        Tables tab = {};
+
+        for (uint32_t b = 0; b < 256; b++)
+        {
+            uint32_t r = Reflect ? b : (b << 24);
+            for (int i = 0; i < 8; i++)
+            {
+                if (Reflect)
+                {
+                    r = (r & 1) ? ((r >> 1) ^ ReflectBits(Poly, Width)) : (r >> 1);
+                }
+                else
+                {
+                    r = (r & 0x80000000u) ? ((r << 1) ^ (Poly << (32 - Width))) : (r << 1);
+                }
+            }
+            tab.t[0][b] = r;
+        }
+
+        for (int k = 1; k < 8; k++)
+        {
+            for (uint32_t b = 0; b < 256; b++)
+            {
+                uint32_t prev = tab.t[k - 1][b];
+                tab.t[k][b]   = Reflect ? ((prev >> 8) ^ tab.t[0][prev & 0xff]) : ((prev << 8) ^ tab.t[0][prev >> 24]);
+            }
+        }
+
+        return tab;
+    }
+
+    static constexpr uint32_t Step(uint32_t reg, uint8_t b)
+    {
+        return Reflect ? ((reg >> 8) ^ table.t[0][(reg ^ b) & 0xff]) : ((reg << 8) ^ table.t[0][(reg >> 24) ^ b]);
+    }
+
+    ///反射CRC按小端、非反射CRC按大端读取,与寄存器的移位方向一致
+    static uint32_t Load32(const uint8_t* p)
+    {
+        if (Reflect)
+        {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+        return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+    }
+
+public:
+    static constexpr Tables table = MakeTables();
+};
+
+/// NAME    :CRC-8/MAXIM   POLY:0x31  INIT:0x00  REFIN/REFOUT:true  XOROUT:0x00  CHECK:0xA1
+typedef CrcEngine<8, 0x31, 0x00, true, 0x00> Crc8Maxim;
+/// NAME    :CRC-16/CCITT-FALSE   POLY:0x1021  INIT:0xFFFF  REFIN/REFOUT:false  XOROUT:0x0000  CHECK:0x29B1
+typedef CrcEngine<16, 0x1021, 0xffff, false, 0x0000> Crc16Ccitt;
+/// NAME    :CRC-32C(Castagnoli)   POLY:0x1EDC6F41  INIT:0xFFFFFFFF  REFIN/REFOUT:true  XOROUT:0xFFFFFFFF  CHECK:0xE3069283
+typedef CrcEngine<32, 0x1EDC6F41, 0xffffffff, true, 0xffffffff> Crc32cSoft;
+
+///标准校验输入"123456789",编译期核对生成的查找表
+constexpr uint8_t CRC_CHECK_INPUT[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+static_assert(Crc8Maxim::Finish(Crc8Maxim::UpdateBytewise(Crc8Maxim::Begin(), CRC_CHECK_INPUT, 9)) == 0xA1, "CRC-8/MAXIM校验值错误");
+static_assert(Crc16Ccitt::Finish(Crc16Ccitt::UpdateBytewise(Crc16Ccitt::Begin(), CRC_CHECK_INPUT, 9)) == 0x29B1, "CRC-16/CCITT校验值错误");
+static_assert(Crc32cSoft::Finish(Crc32cSoft::UpdateBytewise(Crc32cSoft::Begin(), CRC_CHECK_INPUT, 9)) == 0xE3069283, "CRC-32C校验值错误");
+
+///CRC32C内核
+enum Crc32cKernel
+{
+    CRC32C_SLICE8 = 0,  ///<查表
+    CRC32C_SSE42  = 1,  ///<SSE4.2 crc32指令
+    CRC32C_CLMUL  = 2   ///<crc32指令三路并行 + PCLMULQDQ合并
+};
+
+uint32_t     Crc32cUpdate(uint32_t reg, const void* data, size_t len);
+uint32_t     Crc32c(const void* data, size_t len);
+Crc32cKernel Crc32cActiveKernel();
+void         Crc32cSetKernel(Crc32cKernel kernel);
+
+#endif  // CRC_H
@@ -0,0 +1,112 @@
+/**
+ * @file    DispatchTable.h
+ * @brief   按编号分发的处理函数表
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    表项为 函数指针 + 上下文指针 的定长数组,按编号直接下标访问:没有虚函数、std::function和map,
+ *          分发开销为一次数组访问加一次间接调用,与注册的消息种类数无关。处理函数在启动时注册,
+ *          分发时只读,运行中不要再修改。
+ *          消息处理函数拿到的是MessageV2视图,payload直接指向接收/解码缓冲区,只在回调期间有效;
+ *          V1定长帧以帧头字节(RX_FRAME_HEAD)作为编号分发,V2以消息ID分发,因此V2消息ID不使用0x5a/0xA5
+ * @example void OnTelemetry(const MessageV2& msg, void* ctx);                 //直接处理原始数据
+ *          void OnChassis(const GroundChassisData& data, void* ctx);           //按schema解码后处理
+ *          MessageDispatcher dispatcher;
+ *          dispatcher.Register(0x10, OnTelemetry, &telemetry);                 //自定义的遥测消息
+ *          dispatcher.Register(V2_MSG_CHASSIS, PayloadHandler<ChassisPayloadV2, OnChassis>, &robot);
+ *          uart.Parser().SetDispatcher(&dispatcher);
+ *          按GroundChassisData::mode(自瞄/能量机关等)切换处理逻辑由使用下位机数据的一方负责,不在接收路径中分发
+ */
+
+#ifndef DISPATCHTABLE_H
+#define DISPATCHTABLE_H
+
+#include "ProtocolV2.h"
+
+#include <stddef.h>
+
+template <typename Arg, size_t N = 256>
+class DispatchTable
+{
+public:
+    typedef void (*Handler)(const Arg& arg, void* ctx);
+
+    DispatchTable()
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            entries[i].handler = NULL;
+            entries[i].ctx     = NULL;
+        }
+    }
+
+    /**
+     * @brief Register 绑定处理函数,已有绑定时覆盖
+     * @param key      编号
+     * @param handler  处理函数
+     * @param ctx      透传给处理函数的上下文
+     * @return         编号是否在表的范围内
+     */
+    bool Register(size_t key, Handler handler, void* ctx)
+    {
+        if (key >= N)
+        {
+            return false;
+        }
+
+        entries[key].handler = handler;
+        entries[key].ctx     = ctx;
+        return true;
+    }
+
+    void Unregister(size_t key)
+    {
+        Register(key, NULL, NULL);
+    }
+
+    /**
+     * @brief Dispatch 调用编号对应的处理函数
+     * @return         是否有处理函数
+     */
+    bool Dispatch(size_t key, const Arg& arg) const
+    {
+        if (key >= N || entries[key].handler == NULL)
+        {
+            return false;
+        }
+
+        entries[key].handler(arg, entries[key].ctx);
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        Handler handler;
+        void*   ctx;
+    };
+
+    Entry entries[N];
+};
+
+///按消息ID(V2)或帧头字节(V1)分发
+typedef DispatchTable<MessageV2, 256> MessageDispatcher;
+
+/**
+ * @brief PayloadHandler 把按schema解码的处理函数适配为消息处理函数,解码结果在栈上,不分配内存
+ * @note  数据短于schema时丢弃;长于schema时多出的字段被忽略
+ */
+template <typename Schema, void (*Handler)(const typename Schema::type& data, void* ctx)>
+void PayloadHandler(const MessageV2& msg, void* ctx)
+{
+    if (msg.length < Schema::SIZE)
+    {
+        return;
+    }
+
+    typename Schema::type data = {};
+    Schema::Decode(msg.payload, data);
+    Handler(data, ctx);
+}
+
+#endif  // DISPATCHTABLE_H
@@ -0,0 +1,317 @@
+/**
+ * @file    EventLoop.cpp
+ * @brief   基于epoll的单线程协程执行器
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "EventLoop.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#define LOOP_MAX_EVENTS 16  ///单次epoll_wait处理的最大事件数
+
+///Spawn用的顶层协程:立即开始执行,结束后自行销毁
+struct DetachedTask
+{
+    struct promise_type
+    {
+        DetachedTask       get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void               return_void() const noexcept {}
+        void               unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+static DetachedTask Detach(Task<void> task)
+{
+    co_await task;
+}
+
+static bool TimerLater(const TimerNode* a, const TimerNode* b)
+{
+    return a->deadline > b->deadline;
+}
+
+/**
+ * @brief DrainFd 读出eventfd/timerfd的计数,清除可读状态
+ * @return 是否读到;计数已被清除(EAGAIN)时返回false
+ */
+static bool DrainFd(int fd)
+{
+    uint64_t count;
+    return read(fd, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count));
+}
+
+static void OnTimerFd(uint32_t, void* user)
+{
+    ///到期的定时器由ExpireTimers按时刻处理,这里只清除可读状态
+    DrainFd(*static_cast<int*>(user));
+}
+
+SleepAwaiter::SleepAwaiter(EventLoop& loop, int64_t deadline) : loop(loop)
+{
+    timer.deadline = deadline;
+    timer.expire   = NULL;
+    timer.user     = NULL;
+}
+
+bool SleepAwaiter::await_ready() const noexcept
+{
+    return timer.deadline <= MonotonicNs();
+}
+
+void SleepAwaiter::await_suspend(std::coroutine_handle<> h)
+{
+    timer.handle = h;
+    loop.AddTimer(&timer);
+}
+
+EventLoop::EventLoop() : armed(0), dispatching(false)
+{
+    epfd    = epoll_create1(EPOLL_CLOEXEC);
+    stopfd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epfd == -1 || stopfd == -1 || timerfd == -1)
+    {
+        std::cout << "创建事件循环失败" << std::endl;
+        return;
+    }
+
+    struct epoll_event ev;
+    ev.events   = EPOLLIN;
+    ev.data.ptr = NULL;  //NULL表示停止事件
+    epoll_ctl(epfd, EPOLL_CTL_ADD, stopfd, &ev);
+
+    timerWatch.callback = OnTimerFd;
+    timerWatch.user     = &timerfd;
+    Watch(timerfd, EPOLLIN, &timerWatch);
+
+    timers.reserve(16);
+    removed.reserve(LOOP_MAX_EVENTS);
+}
+
+EventLoop::~EventLoop()
+{
+    if (timerfd != -1)
+    {
+        close(timerfd);
+    }
+    if (stopfd != -1)
+    {
+        close(stopfd);
+    }
+    if (epfd != -1)
+    {
+        close(epfd);
+    }
+}
+
+/**
+ * @brief Watch 监听文件句柄
+ * @param fd    文件句柄
+ * @param events epoll事件位,如EPOLLIN
+ * @param watch 回调,需在Unwatch之前保持有效
+ * @return      是否成功
+ */
+bool EventLoop::Watch(int fd, uint32_t events, IoWatch* watch)
+{
+    struct epoll_event ev;
+    ev.events   = events;
+    ev.data.ptr = watch;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+/**
+ * @brief Modify 修改监听的事件(如发送阻塞时加上EPOLLOUT)
+ */
+bool EventLoop::Modify(int fd, uint32_t events, IoWatch* watch)
+{
+    struct epoll_event ev;
+    ev.events   = events;
+    ev.data.ptr = watch;
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+/**
+ * @brief Unwatch 停止监听文件句柄
+ * @param fd      文件句柄
+ * @param watch   Watch时传入的回调
+ * @note          可在回调中调用:本批已取出、尚未分发的事件不会再交给watch,watch在Unwatch返回后即可释放
+ */
+void EventLoop::Unwatch(int fd, IoWatch* watch)
+{
+    epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL);
+
+    if (dispatching)
+    {
+        removed.push_back(watch);
+    }
+}
+
+/**
+ * @brief AddTimer 注册定时器,到期时在Run()线程中触发一次
+ */
+void EventLoop::AddTimer(TimerNode* timer)
+{
+    timers.push_back(timer);
+    std::push_heap(timers.begin(), timers.end(), TimerLater);
+    ArmTimer();
+}
+
+/**
+ * @brief CancelTimer 取消未到期的定时器(已到期或未注册时无操作)
+ * @note  等待者同一时刻只有少数几个,线性查找即可
+ */
+void EventLoop::CancelTimer(TimerNode* timer)
+{
+    std::vector<TimerNode*>::iterator it = std::find(timers.begin(), timers.end(), timer);
+    if (it == timers.end())
+    {
+        return;
+    }
+
+    *it = timers.back();
+    timers.pop_back();
+    std::make_heap(timers.begin(), timers.end(), TimerLater);
+    ArmTimer();
+}
+
+/**
+ * @brief ArmTimer 把timerfd设置为堆顶的到期时刻
+ */
+void EventLoop::ArmTimer()
+{
+    int64_t deadline = timers.empty() ? 0 : std::max<int64_t>(timers.front()->deadline, 1);
+    if (deadline == armed)
+    {
+        return;
+    }
+
+    struct itimerspec spec;
+    spec.it_interval.tv_sec  = 0;
+    spec.it_interval.tv_nsec = 0;
+    spec.it_value.tv_sec     = deadline / 1000000000LL;
+    spec.it_value.tv_nsec    = deadline % 1000000000LL;
+    timerfd_settime(timerfd, TFD_TIMER_ABSTIME, &spec, NULL);
+    armed = deadline;
+}
+
+/**
+ * @brief ExpireTimers 触发所有已到期的定时器
+ */
+void EventLoop::ExpireTimers()
+{
+    int64_t now = MonotonicNs();
+
+    while (!timers.empty() && timers.front()->deadline <= now)
+    {
+        std::pop_heap(timers.begin(), timers.end(), TimerLater);
+        TimerNode* timer = timers.back();
+        timers.pop_back();
+
+        if (timer->expire != NULL)
+        {
+            timer->expire(timer);
+        }
+        else
+        {
+            timer->handle.resume();
+        }
+    }
+
+    ArmTimer();
+}
+
+/**
+ * @brief Spawn 启动一个顶层协程,立即执行到第一个挂起点
+ */
+void EventLoop::Spawn(Task<void> task)
+{
+    Detach(std::move(task));
+}
+
+/**
+ * @brief Run 执行事件循环,直到Stop()
+ * @note  Stop时仍在等待的协程不会被恢复或销毁
+ */
+void EventLoop::Run()
+{
+    struct epoll_event events[LOOP_MAX_EVENTS];
+
+    while (true)
+    {
+        int n = epoll_wait(epfd, events, LOOP_MAX_EVENTS, -1);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        bool stop   = false;
+        dispatching = true;
+        for (int i = 0; i < n; i++)
+        {
+            IoWatch* watch = static_cast<IoWatch*>(events[i].data.ptr);
+            if (watch == NULL)
+            {
+                stop = true;
+                continue;
+            }
+            if (!removed.empty() && std::find(removed.begin(), removed.end(), watch) != removed.end())
+            {
+                continue;
+            }
+            watch->callback(events[i].events, watch->user);
+        }
+        dispatching = false;
+        removed.clear();
+
+        ExpireTimers();
+
+        if (stop)
+        {
+            DrainFd(stopfd);  //清除计数,下次Run()不会立即返回
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Stop 使Run()返回,可在任意线程调用
+ */
+void EventLoop::Stop()
+{
+    uint64_t one = 1;
+    if (write(stopfd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+    {
+        std::cout << "通知事件循环退出失败" << std::endl;
+    }
+}
+
+/**
+ * @brief Sleep 挂起当前协程ns纳秒
+ */
+SleepAwaiter EventLoop::Sleep(int64_t ns)
+{
+    return SleepAwaiter(*this, MonotonicNs() + ns);
+}
+
+/**
+ * @brief SleepUntil 挂起当前协程直到deadline(MonotonicNs),用于无累积误差的周期任务
+ */
+SleepAwaiter EventLoop::SleepUntil(int64_t deadline)
+{
+    return SleepAwaiter(*this, deadline);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file    EventLoop.h
+ * @brief   基于epoll的单线程协程执行器
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    所有协程都在调用Run()的线程中执行。文件句柄就绪时调用注册的回调,由回调恢复等待的协程;
+ *          定时器按截止时刻放在最小堆中,堆顶时刻写入一个timerfd(TFD_TIMER_ABSTIME),精度为ns而不是epoll_wait的ms。
+ *          等待中的定时器节点存放在协程帧里,注册/取消都不分配内存
+ * @example EventLoop loop;
+ *          loop.Spawn(Blink(loop));  //Task<void> Blink(EventLoop& loop) { while (true) { co_await loop.Sleep(1000000); ... } }
+ *          loop.Run();
+ */
+
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include "Clock.h"
+#include "Task.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+///文件句柄事件回调,events为epoll事件位
+typedef void (*IoCallback)(uint32_t events, void* user);
+
+typedef struct
+{
+    IoCallback callback;
+    void*      user;
+} IoWatch;
+
+///定时器节点,由等待者持有;expire为NULL时到期直接恢复handle
+typedef struct TimerNode
+{
+    int64_t                 deadline;  ///<到期时刻(MonotonicNs)
+    std::coroutine_handle<> handle;
+    void (*expire)(struct TimerNode* timer);
+    void* user;
+} TimerNode;
+
+class EventLoop;
+
+///co_await loop.Sleep(ns) / co_await loop.SleepUntil(deadline)
+class SleepAwaiter
+{
+public:
+    SleepAwaiter(EventLoop& loop, int64_t deadline);
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const noexcept {}
+
+private:
+    EventLoop& loop;
+    TimerNode  timer;
+};
+
+class EventLoop
+{
+public:
+    EventLoop();
+    ~EventLoop();
+
+    bool Watch(int fd, uint32_t events, IoWatch* watch);
+    bool Modify(int fd, uint32_t events, IoWatch* watch);
+    void Unwatch(int fd, IoWatch* watch);
+
+    void AddTimer(TimerNode* timer);
+    void CancelTimer(TimerNode* timer);
+
+    void Spawn(Task<void> task);
+    void Run();
+    void Stop();
+
+    SleepAwaiter Sleep(int64_t ns);
+    SleepAwaiter SleepUntil(int64_t deadline);
+
+private:
+    void ExpireTimers();
+    void ArmTimer();
+
+    int                     epfd;
+    int                     stopfd;       ///<Stop()写入,可在其他线程调用
+    int                     timerfd;      ///<堆顶定时器
+    IoWatch                 timerWatch;
+    std::vector<TimerNode*> timers;       ///<按deadline的最小堆
+    int64_t                 armed;        ///<timerfd当前的到期时刻,0表示未设置
+    bool                    dispatching;  ///<Run()正在分发一批epoll事件
+    std::vector<IoWatch*>   removed;      ///<本批事件中已被Unwatch的回调,本批剩余的事件不再分发给它们
+};
+
+#endif  // EVENTLOOP_H
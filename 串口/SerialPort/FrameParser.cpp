@@ -0,0 +1,367 @@
+/**
+ * @file    FrameParser.cpp
+ * @brief   下位机数据帧流式解析器
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "FrameParser.h"
+#include "SerialPort.h"
+
+FrameParser::FrameParser() : have(0), overflow(false), protocol(PROTOCOL_V1), seqValid(false), nextSeq(0), latestRxNs(0), rxNs(0), fresh(false), callback(NULL), user(NULL), sink(NULL), dispatcher(NULL)
+{
+    memset(&latest, 0, sizeof(latest));
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * @brief SetCallback 设置逐帧回调
+ * @param cb          回调函数,为NULL时只保留最新帧
+ * @param user        透传给回调的用户指针
+ */
+void FrameParser::SetCallback(FrameCallback cb, void* user)
+{
+    this->callback = cb;
+    this->user     = user;
+}
+
+/**
+ * @brief SetStats 设置统计输出
+ * @param sink     串口统计,为NULL时不输出
+ */
+void FrameParser::SetStats(UartStats* sink)
+{
+    this->sink = sink;
+}
+
+/**
+ * @brief SetProtocol 切换协议版本,丢弃未收完的半帧
+ * @param protocol    PROTOCOL_V1或PROTOCOL_V2
+ */
+void FrameParser::SetProtocol(ProtocolVersion protocol)
+{
+    this->protocol = protocol;
+    have           = 0;
+    overflow       = false;
+    seqValid       = false;
+}
+
+/**
+ * @brief SetDispatcher 设置消息分发表
+ * @param dispatcher    分发表,为NULL时不分发;解析期间需保持有效
+ */
+void FrameParser::SetDispatcher(const MessageDispatcher* dispatcher)
+{
+    this->dispatcher = dispatcher;
+}
+
+/**
+ * @brief SetRxTime 设置接下来Feed的数据的读取时刻
+ * @param ns        MonotonicNs,由读取串口的一方在read返回时记录
+ * @note            一帧跨多次读取时以收齐最后一段的时刻为准
+ */
+void FrameParser::SetRxTime(int64_t ns)
+{
+    rxNs = ns;
+}
+
+/**
+ * @brief RxTime 正在解析的数据的读取时刻,供回调与分发表处理函数给消息打上主机时间
+ */
+int64_t FrameParser::RxTime() const
+{
+    return rxNs;
+}
+
+/**
+ * @brief Feed 输入一段接收到的数据
+ * @param data 数据首地址
+ * @param len  数据长度,可以为任意值(包括不足一帧)
+ * @return     本次解析出的有效帧数
+ */
+size_t FrameParser::Feed(const unsigned char* data, size_t len)
+{
+    FrameParserStats before = stats;
+
+    if (protocol == PROTOCOL_V2)
+    {
+        FeedV2(data, len);
+    }
+    else
+    {
+        FeedV1(data, len);
+    }
+
+    if (sink != NULL)
+    {
+        sink->AddParsed(stats.frames - before.frames, stats.crcErrors - before.crcErrors, stats.resyncs - before.resyncs, stats.discarded - before.discarded, stats.lost - before.lost);
+    }
+
+    return stats.frames - before.frames;
+}
+
+/**
+ * @brief FeedV1 按定长帧解析
+ */
+void FrameParser::FeedV1(const unsigned char* data, size_t len)
+{
+    size_t pos = 0;
+
+    while (pos < len)
+    {
+        if (have == 0)
+        {
+            ///寻找帧头
+            const unsigned char* head = static_cast<const unsigned char*>(memchr(&data[pos], RX_FRAME_HEAD, len - pos));
+            if (head == NULL)
+            {
+                stats.discarded += len - pos;
+                break;
+            }
+
+            size_t at = static_cast<size_t>(head - data);
+            stats.discarded += at - pos;
+            pos = at;
+
+            ///剩余数据够一整帧时直接在输入缓冲区上校验,不拷贝
+            if (len - pos >= RX_FRAME_LEN)
+            {
+                if (Accept(&data[pos]))
+                {
+                    pos += RX_FRAME_LEN;
+                }
+                else
+                {
+                    stats.resyncs++;
+                    stats.discarded++;
+                    pos++;
+                }
+                continue;
+            }
+
+            memcpy(buf, &data[pos], len - pos);
+            have = len - pos;
+            break;
+        }
+
+        ///收集帧体
+        size_t need = RX_FRAME_LEN - have;
+        size_t n    = need < len - pos ? need : len - pos;
+        memcpy(&buf[have], &data[pos], n);
+        have += n;
+        pos += n;
+
+        if (have == RX_FRAME_LEN)
+        {
+            if (Accept(buf))
+            {
+                have = 0;
+            }
+            else
+            {
+                Resync();
+            }
+        }
+    }
+}
+
+/**
+ * @brief FeedV2 按COBS分帧解析
+ * @note  一帧完整在输入缓冲区中时直接解码,不拷贝
+ */
+void FrameParser::FeedV2(const unsigned char* data, size_t len)
+{
+    size_t pos = 0;
+
+    while (pos < len)
+    {
+        const unsigned char* end = static_cast<const unsigned char*>(memchr(&data[pos], V2_DELIMITER, len - pos));
+        size_t               n   = (end == NULL ? len : static_cast<size_t>(end - data)) - pos;
+
+        if (overflow || have + n > V2_MAX_ENCODED)
+        {
+            ///超长:不可能是有效帧,丢弃到下一个帧边界
+            stats.discarded += have + n;
+            have     = 0;
+            overflow = end == NULL;
+            if (end != NULL)
+            {
+                stats.resyncs++;
+            }
+        }
+        else if (end == NULL)
+        {
+            memcpy(&buf[have], &data[pos], n);
+            have += n;
+        }
+        else if (have == 0)
+        {
+            AcceptV2(&data[pos], n);
+        }
+        else
+        {
+            memcpy(&buf[have], &data[pos], n);
+            AcceptV2(buf, have + n);
+            have = 0;
+        }
+
+        if (end == NULL)
+        {
+            break;
+        }
+        pos += n + 1;
+    }
+}
+
+/**
+ * @brief Accept 校验一帧,成功则更新最新帧并回调
+ * @param frame  帧首地址
+ * @return       是否为有效帧
+ */
+bool FrameParser::Accept(const unsigned char* frame)
+{
+    if (!Uart::UnpackFrame(frame, latest))
+    {
+        stats.crcErrors++;
+        return false;
+    }
+
+    ///视图直接指向帧内的数据,不拷贝
+    if (dispatcher != NULL)
+    {
+        MessageV2 view;
+        view.id      = RX_FRAME_HEAD;
+        view.seq     = 0;
+        view.length  = static_cast<uint8_t>(ChassisFrame::PAYLOAD);
+        view.payload = &frame[1];
+        if (dispatcher->Dispatch(view.id, view))
+        {
+            stats.dispatched++;
+        }
+    }
+
+    Deliver();
+    return true;
+}
+
+/**
+ * @brief AcceptV2 校验一帧V2消息,先交给分发表,下位机数据消息再更新最新帧并回调
+ * @param encoded  两个帧边界之间的数据
+ * @param len      数据长度,为0时是相邻两帧之间的空帧,忽略
+ */
+void FrameParser::AcceptV2(const unsigned char* encoded, size_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    MessageV2 msg;
+    if (!DecodeMessageV2(encoded, len, scratch, msg))
+    {
+        stats.crcErrors++;
+        stats.resyncs++;
+        stats.discarded += len + 1;
+        return;
+    }
+
+    ///序号间隔即为两帧之间丢失的帧数
+    if (seqValid)
+    {
+        stats.lost += static_cast<uint8_t>(msg.seq - nextSeq);
+    }
+    seqValid = true;
+    nextSeq  = static_cast<uint8_t>(msg.seq + 1);
+
+    bool handled = dispatcher != NULL && dispatcher->Dispatch(msg.id, msg);
+    if (handled)
+    {
+        stats.dispatched++;
+    }
+
+    if (msg.id == V2_MSG_CHASSIS && DecodeChassisV2(msg, latest))
+    {
+        Deliver();
+    }
+    else if (!handled)
+    {
+        stats.unknown++;
+    }
+}
+
+/**
+ * @brief Deliver latest已更新为新的一帧
+ */
+void FrameParser::Deliver()
+{
+    stats.frames++;
+    fresh      = true;
+    latestRxNs = rxNs;
+
+    if (callback != NULL)
+    {
+        callback(latest, user);
+    }
+}
+
+/**
+ * @brief Resync 半帧校验失败后,从半帧内下一个帧头处重新开始
+ * @note  假帧头后面可能紧跟着真帧头,不能整段丢弃
+ */
+void FrameParser::Resync()
+{
+    stats.resyncs++;
+
+    const unsigned char* head = static_cast<const unsigned char*>(memchr(&buf[1], RX_FRAME_HEAD, have - 1));
+    if (head == NULL)
+    {
+        stats.discarded += have;
+        have = 0;
+        return;
+    }
+
+    size_t at = static_cast<size_t>(head - buf);
+    stats.discarded += at;
+    have -= at;
+    memmove(buf, head, have);
+}
+
+/**
+ * @brief TakeLatest 取出最新一帧
+ * @param data       接收的数据
+ * @param rxNs       可选,输出该帧的读取时刻(SetRxTime设置,未设置时为0)
+ * @return           自上次调用以来是否有新的有效帧
+ */
+bool FrameParser::TakeLatest(GroundChassisData& data, int64_t* rxNs)
+{
+    if (!fresh)
+    {
+        return false;
+    }
+
+    data  = latest;
+    fresh = false;
+    if (rxNs != NULL)
+    {
+        *rxNs = latestRxNs;
+    }
+    return true;
+}
+
+/**
+ * @brief Reset 丢弃半帧并清空统计
+ */
+void FrameParser::Reset()
+{
+    have     = 0;
+    overflow = false;
+    seqValid = false;
+    fresh    = false;
+    memset(&stats, 0, sizeof(stats));
+}
+
+const FrameParserStats& FrameParser::Stats() const
+{
+    return stats;
+}
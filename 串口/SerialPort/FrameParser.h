@@ -0,0 +1,82 @@
+/**
+ * @file    FrameParser.h
+ * @brief   下位机数据帧流式解析器
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    状态机:寻找帧头 -> 收集帧体 -> 校验。不足一帧的数据保留在解析器内部,
+ *          因此帧被拆分到多次read中、多帧首尾相连、帧前有垃圾数据都能正确解析。
+ *          帧头用memchr查找(glibc中为SIMD实现),每字节开销与read的分块方式无关。
+ *          PROTOCOL_V2下改为用memchr查找帧边界0x00,两个帧边界之间即为一帧,校验失败时丢弃整帧,
+ *          不在帧内重新寻找帧头;消息序号不连续时累加丢帧数。
+ *          设置了MessageDispatcher时,每个有效帧先以视图形式交给分发表,再按原有方式更新最新帧
+ */
+
+#ifndef FRAMEPARSER_H
+#define FRAMEPARSER_H
+
+#include "DispatchTable.h"
+#include "ProtocolV2.h"
+#include "UartStats.h"
+
+#include <stddef.h>
+
+///逐帧回调:每解析出一帧有效数据调用一次,顺序与接收顺序一致
+typedef void (*FrameCallback)(const GroundChassisData& data, void* user);
+
+typedef struct
+{
+    size_t frames;      ///<有效帧数
+    size_t crcErrors;   ///<CRC校验失败次数
+    size_t resyncs;     ///<校验失败后重新同步的次数
+    size_t discarded;   ///<丢弃的字节数
+    size_t lost;        ///<按V2序号推算的链路丢帧数
+    size_t unknown;     ///<V2中未知消息ID(且没有注册处理函数)的帧数
+    size_t dispatched;  ///<交给分发表处理的帧数
+} FrameParserStats;
+
+class FrameParser
+{
+public:
+    FrameParser();
+
+    void   SetCallback(FrameCallback cb, void* user);
+    void   SetStats(UartStats* sink);
+    void   SetProtocol(ProtocolVersion protocol);
+    void   SetDispatcher(const MessageDispatcher* dispatcher);
+    void   SetRxTime(int64_t ns);
+    size_t Feed(const unsigned char* data, size_t len);
+    bool   TakeLatest(GroundChassisData& data, int64_t* rxNs = NULL);
+    void   Reset();
+
+    int64_t RxTime() const;
+
+    const FrameParserStats& Stats() const;
+
+private:
+    void FeedV1(const unsigned char* data, size_t len);
+    void FeedV2(const unsigned char* data, size_t len);
+    bool Accept(const unsigned char* frame);
+    void AcceptV2(const unsigned char* encoded, size_t len);
+    void Deliver();
+    void Resync();
+
+    unsigned char     buf[V2_MAX_ENCODED];      ///<未收完的半帧
+    unsigned char     scratch[V2_MAX_ENCODED];  ///<V2解码缓冲区
+    size_t            have;                     ///<半帧已有字节数,0表示处于寻找帧头状态
+    bool              overflow;                 ///<V2半帧超长,丢弃到下一个帧边界
+    ProtocolVersion   protocol;
+    bool              seqValid;                 ///<是否已收到过V2消息
+    uint8_t           nextSeq;                  ///<期望的下一个V2序号
+    GroundChassisData latest;                   ///<最近一帧有效数据
+    int64_t           latestRxNs;               ///<latest的读取时刻
+    int64_t           rxNs;                     ///<正在解析的数据的读取时刻(MonotonicNs),0表示未知
+    bool              fresh;                    ///<latest是否未被取走
+    FrameCallback     callback;
+    void*             user;
+    FrameParserStats  stats;
+    UartStats*               sink;        ///<可选,每次Feed结束时把增量累加到串口统计
+    const MessageDispatcher* dispatcher;  ///<可选,按消息ID分发
+};
+
+#endif  // FRAMEPARSER_H
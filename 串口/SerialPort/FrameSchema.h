@@ -0,0 +1,206 @@
+/**
+ * @file    FrameSchema.h
+ * @brief   编译期帧格式描述,自动生成编解码
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    一帧 = | 帧头 | 字段1 | 字段2 | ... | CRC |,字段按声明顺序紧密排列,线上统一为小端。
+ *          帧长与每个字段的偏移都在编译期确定,展开后是一串定长memcpy(大端主机上额外bswap),
+ *          增加字段只需在schema中添加一项
+ * @example typedef FrameSchema<0xA5, ProtocolCrc8, HostComputerData,
+ *                              Field<&HostComputerData::pitch>, Field<&HostComputerData::yaw>> Frame;
+ *          unsigned char buf[Frame::LENGTH];
+ *          Frame::Encode(data, buf);
+ */
+
+#ifndef FRAMESCHEMA_H
+#define FRAMESCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+///线上字节序为小端,大端主机编解码时交换字节
+constexpr bool WIRE_NEED_SWAP = __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__;
+
+template <size_t N>
+struct WireUInt;
+template <>
+struct WireUInt<1>
+{
+    typedef uint8_t type;
+    static uint8_t Swap(uint8_t v) { return v; }
+};
+template <>
+struct WireUInt<2>
+{
+    typedef uint16_t type;
+    static uint16_t Swap(uint16_t v) { return __builtin_bswap16(v); }
+};
+template <>
+struct WireUInt<4>
+{
+    typedef uint32_t type;
+    static uint32_t Swap(uint32_t v) { return __builtin_bswap32(v); }
+};
+template <>
+struct WireUInt<8>
+{
+    typedef uint64_t type;
+    static uint64_t Swap(uint64_t v) { return __builtin_bswap64(v); }
+};
+
+/**
+ * @brief WireCodec 单个字段的线上编解码,默认支持整数与浮点数
+ * @note  其他类型(如float2uchar)通过特化提供
+ */
+template <typename M, typename Enable = void>
+struct WireCodec
+{
+    static_assert(std::is_arithmetic<M>::value, "字段类型需为整数/浮点数,或为其特化WireCodec");
+
+    static constexpr size_t SIZE = sizeof(M);
+
+    static void Encode(const M& value, unsigned char* out)
+    {
+        typename WireUInt<SIZE>::type raw;
+        memcpy(&raw, &value, SIZE);
+        if (WIRE_NEED_SWAP)
+        {
+            raw = WireUInt<SIZE>::Swap(raw);
+        }
+        memcpy(out, &raw, SIZE);
+    }
+
+    static void Decode(const unsigned char* in, M& value)
+    {
+        typename WireUInt<SIZE>::type raw;
+        memcpy(&raw, in, SIZE);
+        if (WIRE_NEED_SWAP)
+        {
+            raw = WireUInt<SIZE>::Swap(raw);
+        }
+        memcpy(&value, &raw, SIZE);
+    }
+};
+
+template <typename P>
+struct MemberTraits;
+template <typename T, typename M>
+struct MemberTraits<M T::*>
+{
+    typedef T owner;
+    typedef M type;
+};
+
+/**
+ * @brief Field 帧中的一个字段,由结构体成员指针描述
+ */
+template <auto Member>
+struct Field
+{
+    typedef typename MemberTraits<decltype(Member)>::owner owner;
+    typedef typename MemberTraits<decltype(Member)>::type  type;
+
+    static constexpr size_t SIZE = WireCodec<type>::SIZE;
+
+    static void Encode(const owner& data, unsigned char* out)
+    {
+        WireCodec<type>::Encode(data.*Member, out);
+    }
+
+    static void Decode(const unsigned char* in, owner& data)
+    {
+        WireCodec<type>::Decode(in, data.*Member);
+    }
+};
+
+/**
+ * @brief PayloadSchema 字段部分的排列,不含帧头与校验,可被不同的帧格式复用
+ * @param T      对应的数据结构
+ * @param Fields 字段列表,按线上顺序排列
+ */
+template <typename T, typename... Fields>
+struct PayloadSchema
+{
+    typedef T type;
+
+    static constexpr size_t SIZE = (Fields::SIZE + ... + 0);
+
+    /**
+     * @brief Encode 编码全部字段
+     * @param data   数据
+     * @param out    输出,至少SIZE字节
+     */
+    static void Encode(const T& data, unsigned char* out)
+    {
+        size_t offset = 0;
+        ((Fields::Encode(data, &out[offset]), offset += Fields::SIZE), ...);
+    }
+
+    /**
+     * @brief Decode 解码全部字段,不做校验
+     */
+    static void Decode(const unsigned char* in, T& data)
+    {
+        size_t offset = 0;
+        ((Fields::Decode(&in[offset], data), offset += Fields::SIZE), ...);
+    }
+};
+
+/**
+ * @brief FrameSchema 定长帧:帧头 + 字段 + CRC(CRC覆盖全部字段,不含帧头)
+ * @param Head   帧头字节
+ * @param Crc    CRC引擎(CrcEngine),取低8位作为校验字节
+ * @param T      对应的数据结构
+ * @param Fields 字段列表,按线上顺序排列
+ */
+template <uint8_t Head, typename Crc, typename T, typename... Fields>
+struct FrameSchema
+{
+    typedef PayloadSchema<T, Fields...> Payload;
+
+    static constexpr uint8_t HEAD    = Head;
+    static constexpr size_t  PAYLOAD = Payload::SIZE;  ///<有效数据长度
+    static constexpr size_t  LENGTH  = 1 + PAYLOAD + 1;  ///<帧长(含帧头与CRC)
+
+    /**
+     * @brief Encode 组帧
+     * @param data   数据
+     * @param frame  输出,至少LENGTH字节
+     */
+    static void Encode(const T& data, unsigned char* frame)
+    {
+        frame[0] = Head;
+        Payload::Encode(data, &frame[1]);
+        frame[LENGTH - 1] = static_cast<unsigned char>(Crc::Compute(&frame[1], PAYLOAD));
+    }
+
+    /**
+     * @brief Check 校验帧头与CRC
+     */
+    static bool Check(const unsigned char* frame)
+    {
+        return frame[0] == Head && frame[LENGTH - 1] == static_cast<unsigned char>(Crc::Compute(&frame[1], PAYLOAD));
+    }
+
+    /**
+     * @brief Decode 校验并解帧
+     * @param frame  帧首地址,至少LENGTH字节
+     * @param data   输出,校验失败时不修改
+     * @return       是否为有效帧
+     */
+    static bool Decode(const unsigned char* frame, T& data)
+    {
+        if (!Check(frame))
+        {
+            return false;
+        }
+
+        Payload::Decode(&frame[1], data);
+        return true;
+    }
+};
+
+#endif  // FRAMESCHEMA_H
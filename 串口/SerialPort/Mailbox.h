@@ -0,0 +1,138 @@
+/**
+ * @file    Mailbox.h
+ * @brief   单写者/多读者"最新值"邮箱(seqlock)
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    写者从不等待读者;读者只在恰好与写入重叠时重读一次,总能拿到完整的最新值。
+ *          数据以64位原子字保存,读写过程不存在数据竞争
+ */
+
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include "Clock.h"
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MAILBOX_PAUSE() _mm_pause()
+#else
+#define MAILBOX_PAUSE()
+#endif
+
+template <typename T>
+class LatestValue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "邮箱只能存放可平凡复制的类型");
+
+public:
+    LatestValue() : seq(0), stamp(0)
+    {
+        for (size_t i = 0; i < WORDS; i++)
+        {
+            words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Publish 发布新值(仅允许一个写者线程调用)
+     * @param value   新值
+     */
+    void Publish(const T& value)
+    {
+        uint64_t buf[WORDS] = {};
+        memcpy(buf, &value, sizeof(T));
+
+        uint64_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);  //奇数:写入中
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORDS; i++)
+        {
+            words[i].store(buf[i], std::memory_order_relaxed);
+        }
+        stamp.store(MonotonicNs(), std::memory_order_relaxed);
+
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Read 读取最新值
+     * @param value       输出
+     * @param publishedNs 可选,输出该值的发布时刻(MonotonicNs)
+     * @return            该值的版本号(发布次数),0表示从未发布
+     */
+    uint64_t Read(T& value, int64_t* publishedNs = NULL) const
+    {
+        uint64_t buf[WORDS];
+        int64_t  published;
+        uint64_t s1, s2;
+
+        do
+        {
+            s1 = seq.load(std::memory_order_acquire);
+            while (s1 & 1)
+            {
+                MAILBOX_PAUSE();
+                s1 = seq.load(std::memory_order_acquire);
+            }
+
+            for (size_t i = 0; i < WORDS; i++)
+            {
+                buf[i] = words[i].load(std::memory_order_relaxed);
+            }
+            published = stamp.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            s2 = seq.load(std::memory_order_relaxed);
+        } while (s1 != s2);
+
+        memcpy(&value, buf, sizeof(T));
+        if (publishedNs != NULL)
+        {
+            *publishedNs = published;
+        }
+        return s1 / 2;
+    }
+
+    /**
+     * @brief ReadIfNewer 仅当有比version更新的值时读取
+     * @param value       输出
+     * @param version     输入上次读到的版本号,读到新值时更新
+     * @param publishedNs 可选,输出该值的发布时刻(MonotonicNs)
+     * @return            是否读到新值
+     */
+    bool ReadIfNewer(T& value, uint64_t& version, int64_t* publishedNs = NULL) const
+    {
+        if (Version() == version)
+        {
+            return false;
+        }
+
+        version = Read(value, publishedNs);
+        return true;
+    }
+
+    /**
+     * @brief Version 当前版本号(发布次数)
+     */
+    uint64_t Version() const
+    {
+        return seq.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> seq;    ///<序号,奇数表示写入中
+    std::atomic<int64_t>  stamp;  ///<发布时刻
+    std::atomic<uint64_t> words[WORDS];
+};
+
+#endif  // MAILBOX_H
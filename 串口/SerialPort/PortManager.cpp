@@ -0,0 +1,397 @@
+/**
+ * @file    PortManager.cpp
+ * @brief   多串口管理:单个reactor线程通过epoll同时服务多个串口
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "PortManager.h"
+
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#define PORT_READ_SIZE  4096  ///单次read的最大字节数
+#define PORT_MAX_EVENTS 16    ///单次epoll_wait处理的最大事件数
+
+PortManager::PortManager() : epfd(-1), stopfd(-1) {}
+
+PortManager::~PortManager()
+{
+    Stop();
+
+    for (size_t i = 0; i < ports.size(); i++)
+    {
+        if (ports[i]->fd != -1)
+        {
+            close(ports[i]->fd);
+        }
+    }
+}
+
+/**
+ * @brief AddPort 打开并配置一个串口
+ * @param config  串口参数
+ * @return        串口编号,失败返回-1
+ * @note          需在Start()之前调用
+ */
+int PortManager::AddPort(const PortConfig& config)
+{
+    if (reactor.joinable())
+    {
+        return -1;
+    }
+
+    int fd = open(config.device.c_str(), O_RDWR | O_NONBLOCK | O_NOCTTY);
+    if (fd == -1)
+    {
+        cout << config.name << ": 串口打开失败 " << config.device << endl;
+        return -1;
+    }
+
+    if (!Uart::SetUart(fd, config.speed, config.flow, config.databits, config.stopbits, config.parity))
+    {
+        cout << config.name << ": 设置串口属性失败" << endl;
+        close(fd);
+        return -1;
+    }
+
+    std::unique_ptr<Port> port(new Port);
+    port->config = config;
+    port->fd     = fd;
+    port->open.store(true);
+    port->parser.SetCallback(config.callback, config.user);
+    port->parser.SetStats(&port->stats);
+    port->parser.SetProtocol(config.protocol);
+    port->txSeq.store(0);
+    port->txLength = 0;
+    port->txArmed  = false;
+
+    ports.push_back(std::move(port));
+
+    cout << config.name << ": 串口打开成功 " << config.device << endl;
+    return static_cast<int>(ports.size() - 1);
+}
+
+/**
+ * @brief Start 启动reactor线程
+ * @return      是否成功
+ */
+bool PortManager::Start()
+{
+    if (reactor.joinable())
+    {
+        return false;
+    }
+
+    epfd   = epoll_create1(EPOLL_CLOEXEC);
+    stopfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epfd == -1 || stopfd == -1)
+    {
+        cout << "创建epoll失败" << endl;
+        Stop();
+        return false;
+    }
+
+    struct epoll_event ev;
+    ev.events   = EPOLLIN;
+    ev.data.ptr = NULL;  //NULL表示停止事件
+    epoll_ctl(epfd, EPOLL_CTL_ADD, stopfd, &ev);
+
+    for (size_t i = 0; i < ports.size(); i++)
+    {
+        ///Start之前Send留下的数据由reactor线程补发
+        std::lock_guard<std::mutex> guard(ports[i]->txLock);
+        ports[i]->txArmed = ports[i]->txLength > 0;
+
+        ev.events   = ports[i]->txArmed ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        ev.data.ptr = ports[i].get();
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, ports[i]->fd, &ev) == -1)
+        {
+            cout << ports[i]->config.name << ": 串口加入epoll失败" << endl;
+            Stop();
+            return false;
+        }
+    }
+
+    reactor = std::thread(&PortManager::Run, this);
+    return true;
+}
+
+/**
+ * @brief Stop 停止reactor线程(串口保持打开,析构时关闭)
+ */
+void PortManager::Stop()
+{
+    if (reactor.joinable())
+    {
+        uint64_t one = 1;
+        if (write(stopfd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+        {
+            cout << "通知reactor线程退出失败" << endl;
+        }
+        reactor.join();
+    }
+
+    if (epfd != -1)
+    {
+        close(epfd);
+        epfd = -1;
+    }
+    if (stopfd != -1)
+    {
+        close(stopfd);
+        stopfd = -1;
+    }
+}
+
+/**
+ * @brief Run reactor主循环
+ */
+void PortManager::Run()
+{
+    struct epoll_event events[PORT_MAX_EVENTS];
+
+    while (true)
+    {
+        int n = epoll_wait(epfd, events, PORT_MAX_EVENTS, -1);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            Port* port = static_cast<Port*>(events[i].data.ptr);
+            if (port == NULL)
+            {
+                return;
+            }
+
+            if (events[i].events & EPOLLIN)
+            {
+                OnReadable(*port);
+            }
+            if (events[i].events & EPOLLOUT)
+            {
+                OnWritable(*port);
+            }
+
+            ///串口被拔出:移出epoll,其他串口继续工作
+            if (events[i].events & (EPOLLHUP | EPOLLERR))
+            {
+                cout << port->config.name << ": 串口连接断开" << endl;
+                epoll_ctl(epfd, EPOLL_CTL_DEL, port->fd, NULL);
+                port->open.store(false);
+            }
+        }
+    }
+}
+
+/**
+ * @brief OnReadable 读空一个串口的内核缓冲区并解析
+ */
+void PortManager::OnReadable(Port& port)
+{
+    unsigned char buf[PORT_READ_SIZE];
+
+    while (true)
+    {
+        ssize_t bytes = read(port.fd, buf, sizeof(buf));
+        if (bytes > 0)
+        {
+            int64_t readNs = MonotonicNs();
+            port.stats.AddRead(static_cast<uint64_t>(bytes));
+
+            port.parser.SetRxTime(readNs);
+            size_t frames = port.parser.Feed(buf, static_cast<size_t>(bytes));
+            if (frames > 0)
+            {
+                port.stats.rxLatency.Record(MonotonicNs() - readNs, frames);
+            }
+            continue;
+        }
+        if (bytes == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        break;
+    }
+}
+
+/**
+ * @brief OnWritable 串口可写时补发暂存的数据,写完后停止监听EPOLLOUT
+ */
+void PortManager::OnWritable(Port& port)
+{
+    std::lock_guard<std::mutex> guard(port.txLock);
+    if (FlushLocked(port))
+    {
+        ArmLocked(port, false);
+    }
+}
+
+/**
+ * @brief FlushLocked 尽量写出暂存的数据(调用者持有txLock)
+ * @return            暂存区是否已写空
+ */
+bool PortManager::FlushLocked(Port& port)
+{
+    size_t done = 0;
+    while (done < port.txLength)
+    {
+        ssize_t n = write(port.fd, port.txBacklog + done, port.txLength - done);
+        if (n > 0)
+        {
+            done += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        break;
+    }
+
+    if (done > 0)
+    {
+        port.stats.AddWrite(done);
+        port.txLength -= done;
+        memmove(port.txBacklog, port.txBacklog + done, port.txLength);
+    }
+
+    return port.txLength == 0;
+}
+
+/**
+ * @brief ArmLocked 开始/停止监听串口可写(调用者持有txLock)
+ * @note  reactor未启动时只记录状态,Start时按暂存区是否为空决定
+ */
+void PortManager::ArmLocked(Port& port, bool writable)
+{
+    if (port.txArmed == writable || epfd == -1)
+    {
+        return;
+    }
+
+    struct epoll_event ev;
+    ev.events   = writable ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    ev.data.ptr = &port;
+    if (epoll_ctl(epfd, EPOLL_CTL_MOD, port.fd, &ev) == 0)
+    {
+        port.txArmed = writable;
+    }
+}
+
+/**
+ * @brief Send 向指定串口发送一帧上位机数据
+ * @param port 串口编号
+ * @param data 发送的数据
+ * @return     是否完整写入
+ */
+bool PortManager::Send(int port, const HostComputerData& data)
+{
+    if (port < 0 || static_cast<size_t>(port) >= ports.size())
+    {
+        return false;
+    }
+
+    unsigned char frame[V2_MAX_FRAME];
+    size_t        len = TX_FRAME_LEN;
+    if (ports[port]->config.protocol == PROTOCOL_V2)
+    {
+        len = EncodeMessageV2<HostPayloadV2>(V2_MSG_HOST, ports[port]->txSeq.fetch_add(1), data, frame);
+    }
+    else
+    {
+        HostFrame::Encode(data, frame);
+    }
+
+    return Send(port, frame, len);
+}
+
+/**
+ * @brief Send 向指定串口发送原始数据(可在任意线程调用)
+ * @return     是否已写出或暂存;暂存区放不下、长度超过PORT_TX_BACKLOG或串口出错时整帧丢弃并返回false
+ * @note       先补发暂存的数据,保证字节顺序;本次写不完的部分暂存,由reactor线程在可写时补发
+ */
+bool PortManager::Send(int port, const unsigned char* data, size_t len)
+{
+    if (port < 0 || static_cast<size_t>(port) >= ports.size() || !ports[port]->open.load() || len > PORT_TX_BACKLOG)
+    {
+        return false;
+    }
+
+    Port&                       p = *ports[port];
+    std::lock_guard<std::mutex> guard(p.txLock);
+
+    size_t done = 0;
+    if (FlushLocked(p))
+    {
+        while (done < len)
+        {
+            ssize_t n = write(p.fd, data + done, len - done);
+            if (n > 0)
+            {
+                done += static_cast<size_t>(n);
+                continue;
+            }
+            if (n == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n == -1 && errno != EAGAIN)
+            {
+                ///一个字节都没写出时整帧丢弃;已写出一部分时余下的仍需补发,否则线路上留下半帧
+                if (done == 0)
+                {
+                    return false;
+                }
+            }
+            break;
+        }
+
+        if (done > 0)
+        {
+            p.stats.AddWrite(done);
+        }
+        if (done == len)
+        {
+            return true;
+        }
+    }
+
+    if (p.txLength + (len - done) > PORT_TX_BACKLOG)
+    {
+        ///只有整帧尚未开始写出时才会放不下:已写出一部分时暂存区为空,余下的部分不超过PORT_TX_BACKLOG
+        return false;
+    }
+
+    memcpy(p.txBacklog + p.txLength, data + done, len - done);
+    p.txLength += len - done;
+    ArmLocked(p, true);
+    return true;
+}
+
+size_t PortManager::PortCount() const
+{
+    return ports.size();
+}
+
+bool PortManager::IsOpen(int port) const
+{
+    return port >= 0 && static_cast<size_t>(port) < ports.size() && ports[port]->open.load();
+}
+
+/**
+ * @brief Stats 指定串口的收发统计
+ */
+UartStats& PortManager::Stats(int port)
+{
+    return ports[port]->stats;
+}
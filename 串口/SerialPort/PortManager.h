@@ -0,0 +1,89 @@
+/**
+ * @file    PortManager.h
+ * @brief   多串口管理:单个reactor线程通过epoll同时服务多个串口
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    每个串口有独立的串口参数、解析器、统计与回调;所有串口的读取与解析都在同一个线程中完成,
+ *          设备数增加时不再增加线程数与上下文切换。回调在reactor线程中执行,应尽快返回。
+ *          Send可在任意线程调用,同一串口的发送互斥;内核发送缓冲区写不下时未写出的部分暂存,
+ *          由reactor线程在串口可写(EPOLLOUT)时补发,线路上不会出现被截断的帧
+ * @example PortManager manager;
+ *          PortConfig  gimbal = {"gimbal", "/dev/ttyUSB0", 115200, 0, 8, 1, 'N', OnGimbal, NULL};
+ *          int         id     = manager.AddPort(gimbal);
+ *          manager.Start();
+ *          manager.Send(id, data);
+ */
+
+#ifndef PORTMANAGER_H
+#define PORTMANAGER_H
+
+#include "SerialPort.h"
+
+#define PORT_TX_BACKLOG 4096  ///每个串口暂存未写出数据的最大字节数,放不下时整帧丢弃
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef struct
+{
+    string          name;      ///<名称,仅用于打印
+    string          device;    ///<设备路径
+    int             speed;     ///<波特率
+    int             flow;      ///<数据流控制 0:无 1:硬件 2:软件
+    int             databits;  ///<数据位
+    int             stopbits;  ///<停止位
+    int             parity;    ///<校验类型 'N' 'O' 'E' 'S'
+    FrameCallback   callback;  ///<逐帧回调,在reactor线程中调用
+    void*           user;      ///<透传给回调的用户指针
+    ProtocolVersion protocol;  ///<协议版本,省略时为PROTOCOL_V1
+} PortConfig;
+
+class PortManager
+{
+public:
+    PortManager();
+    ~PortManager();
+
+    int  AddPort(const PortConfig& config);
+    bool Start();
+    void Stop();
+
+    bool Send(int port, const HostComputerData& data);
+    bool Send(int port, const unsigned char* data, size_t len);
+
+    size_t     PortCount() const;
+    bool       IsOpen(int port) const;
+    UartStats& Stats(int port);
+
+private:
+    struct Port
+    {
+        PortConfig           config;
+        int                  fd;
+        std::atomic<bool>    open;
+        FrameParser          parser;
+        UartStats            stats;
+        std::atomic<uint8_t> txSeq;                       ///<V2发送序号,Send可在多个线程调用
+        std::mutex           txLock;                      ///<串行化发送线程与reactor线程的补发
+        unsigned char        txBacklog[PORT_TX_BACKLOG];  ///<已接受但尚未写出的数据
+        size_t               txLength;                    ///<txBacklog中的字节数
+        bool                 txArmed;                     ///<是否已监听EPOLLOUT
+    };
+
+    void Run();
+    void OnReadable(Port& port);
+    void OnWritable(Port& port);
+    bool FlushLocked(Port& port);
+    void ArmLocked(Port& port, bool writable);
+
+    std::vector<std::unique_ptr<Port>> ports;
+    int                                epfd;
+    int                                stopfd;
+    std::thread                        reactor;
+};
+
+#endif  // PORTMANAGER_H
@@ -0,0 +1,88 @@
+/**
+ * @file    Protocol.h
+ * @brief   上下位机通信协议:帧格式、数据结构与CRC8参数
+ * @author  xiadengma && storms
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    从SerialPort.h中拆出,供串口、解析器等模块共用
+ */
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "Crc.h"
+#include "FrameSchema.h"
+#include "stdint.h"
+
+#define RX_FRAME_HEAD 0x5a  ///下位机->上位机 帧头
+#define TX_FRAME_HEAD 0xA5  ///上位机->下位机 帧头
+
+/// NAME    :CRC8(多项式同CRC-8/MAXIM,但初值为0xFF,与下位机一致)
+/// POLY    :(0x31)->x8 + x5 + x4 + 1
+/// WIDTH   :8
+/// INIT    :FF
+/// REFIN   :true
+/// REFOUT  :true
+/// XOROUT  :00
+typedef CrcEngine<8, 0x31, 0xff, true, 0x00> ProtocolCrc8;
+
+typedef union {
+    float         f;
+    unsigned char c[4];
+} float2uchar;
+
+///float2uchar在线上按4字节小端float编码
+template <>
+struct WireCodec<float2uchar>
+{
+    static constexpr size_t SIZE = 4;
+
+    static void Encode(const float2uchar& value, unsigned char* out)
+    {
+        WireCodec<float>::Encode(value.f, out);
+    }
+
+    static void Decode(const unsigned char* in, float2uchar& value)
+    {
+        WireCodec<float>::Decode(in, value.f);
+    }
+};
+
+typedef struct
+{
+    float2uchar yaw;       ///偏航角
+    float2uchar pitch;     ///俯仰角
+    float2uchar distance;  ///距离 单位：mm
+} HostComputerData;
+
+typedef struct
+{
+    float2uchar   gain_yaw;          ///获取的yaw
+    float2uchar   gain_pitch;        ///获取的pitch
+    unsigned char mode;              /// 0:正常自瞄 1：击打能量机关 2：吊射模式 3：预测自瞄
+    unsigned char color;             /// 0：击打红色 1：击打蓝色
+    unsigned char speed;             ///射速: 步兵：15/18  英雄：16  单位：m/s
+    float2uchar   lob_offset_yaw;    ///吊射微调yaw
+    float2uchar   lob_offset_pitch;  ///吊射微调pitch
+} GroundChassisData;
+
+///下位机->上位机 | 0x5a | gain_yaw | gain_pitch | mode | color | speed | CRC8 check |
+typedef FrameSchema<RX_FRAME_HEAD, ProtocolCrc8, GroundChassisData,
+                    Field<&GroundChassisData::gain_yaw>,
+                    Field<&GroundChassisData::gain_pitch>,
+                    Field<&GroundChassisData::mode>,
+                    Field<&GroundChassisData::color>,
+                    Field<&GroundChassisData::speed>>
+    ChassisFrame;
+
+///上位机->下位机 | 0xA5 | Pitch | Yaw | Distance | CRC8 check |
+typedef FrameSchema<TX_FRAME_HEAD, ProtocolCrc8, HostComputerData,
+                    Field<&HostComputerData::pitch>,
+                    Field<&HostComputerData::yaw>,
+                    Field<&HostComputerData::distance>>
+    HostFrame;
+
+const size_t RX_FRAME_LEN = ChassisFrame::LENGTH;  ///下位机->上位机 帧长(含帧头与CRC)
+const size_t TX_FRAME_LEN = HostFrame::LENGTH;     ///上位机->下位机 帧长(含帧头与CRC)
+
+#endif  // PROTOCOL_H
@@ -0,0 +1,115 @@
+/**
+ * @file    ProtocolV2.cpp
+ * @brief   第二版通信协议:COBS分帧 + 消息ID + 序号 + 变长数据
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "ProtocolV2.h"
+
+#include <string.h>
+
+/**
+ * @brief SealMessageV2 计算CRC并COBS编码
+ * @param raw           编码前的消息,头部与数据已填好,末尾留出V2_CRC_LEN字节
+ * @param payloadLen    数据长度
+ * @param frame         输出,至少V2_MAX_FRAME字节
+ * @return              线上帧长(含前后帧边界)
+ */
+size_t SealMessageV2(unsigned char* raw, size_t payloadLen, unsigned char* frame)
+{
+    size_t   len = V2_HEADER_LEN + payloadLen;
+    uint16_t crc = static_cast<uint16_t>(ProtocolCrc16::Compute(raw, len));
+    raw[len]     = static_cast<unsigned char>(crc & 0xFF);
+    raw[len + 1] = static_cast<unsigned char>(crc >> 8);
+
+    size_t n     = CobsEncode(raw, len + V2_CRC_LEN, &frame[1]);
+    frame[0]     = V2_DELIMITER;
+    frame[n + 1] = V2_DELIMITER;
+
+    return n + 2;
+}
+
+/**
+ * @brief EncodeMessageV2 组一帧V2消息
+ * @param id              消息ID
+ * @param seq             序号
+ * @param payload         数据
+ * @param len             数据长度,不超过V2_MAX_PAYLOAD
+ * @param frame           输出,至少V2_MAX_FRAME字节
+ * @return                线上帧长(含前后帧边界),数据过长时返回0
+ */
+size_t EncodeMessageV2(uint8_t id, uint8_t seq, const unsigned char* payload, size_t len, unsigned char* frame)
+{
+    if (len > V2_MAX_PAYLOAD)
+    {
+        return 0;
+    }
+
+    unsigned char raw[V2_MAX_RAW];
+    raw[0] = id;
+    raw[1] = seq;
+    raw[2] = static_cast<unsigned char>(len);
+    memcpy(&raw[V2_HEADER_LEN], payload, len);
+
+    return SealMessageV2(raw, len, frame);
+}
+
+/**
+ * @brief DecodeMessageV2 解码并校验一帧V2消息
+ * @param encoded         两个帧边界之间的数据(不含帧边界)
+ * @param len             数据长度
+ * @param scratch         解码缓冲区,至少V2_MAX_ENCODED字节,msg.payload指向其中
+ * @param msg             解出的消息
+ * @return                COBS、长度与CRC均正确时返回true
+ */
+bool DecodeMessageV2(const unsigned char* encoded, size_t len, unsigned char* scratch, MessageV2& msg)
+{
+    if (len > V2_MAX_ENCODED)
+    {
+        return false;
+    }
+
+    size_t n = CobsDecode(encoded, len, scratch);
+    if (n < V2_HEADER_LEN + V2_CRC_LEN || n != V2_HEADER_LEN + static_cast<size_t>(scratch[2]) + V2_CRC_LEN)
+    {
+        return false;
+    }
+
+    uint16_t crc = static_cast<uint16_t>(scratch[n - 2] | (scratch[n - 1] << 8));
+    if (crc != static_cast<uint16_t>(ProtocolCrc16::Compute(scratch, n - V2_CRC_LEN)))
+    {
+        return false;
+    }
+
+    msg.id      = scratch[0];
+    msg.seq     = scratch[1];
+    msg.length  = scratch[2];
+    msg.payload = &scratch[V2_HEADER_LEN];
+
+    return true;
+}
+
+/**
+ * @brief DecodeChassisV2 从V2消息中取出下位机数据
+ * @param msg             V2_MSG_CHASSIS消息
+ * @param data            输出,失败时不修改
+ * @return                数据长度是否足够
+ * @note                  只有V1字段时吊射微调保持原值
+ */
+bool DecodeChassisV2(const MessageV2& msg, GroundChassisData& data)
+{
+    if (msg.length >= ChassisPayloadV2::SIZE)
+    {
+        ChassisPayloadV2::Decode(msg.payload, data);
+        return true;
+    }
+    if (msg.length >= CHASSIS_V2_MIN_PAYLOAD)
+    {
+        ChassisFrame::Payload::Decode(msg.payload, data);
+        return true;
+    }
+
+    return false;
+}
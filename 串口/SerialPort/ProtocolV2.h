@@ -0,0 +1,104 @@
+/**
+ * @file    ProtocolV2.h
+ * @brief   第二版通信协议:COBS分帧 + 消息ID + 序号 + 变长数据
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    编码前: | 消息ID(1B) | 序号(1B) | 长度(1B) | 数据(长度B) | CRC16(2B,小端) |
+ *          线上:   | 0x00 | COBS(编码前) | 0x00 |
+ *          COBS保证编码后的数据中没有0x00,0x00只作为帧边界出现,数据中的任何字节都不会被误认为帧边界;
+ *          校验失败时直接丢到下一个0x00,不需要在每个候选帧头处重试CRC。
+ *          帧前的0x00用于截断线上的噪声,噪声只会与它之前的内容组成一个无效帧,不会连累后面的有效帧;
+ *          连续发送时相邻两帧之间的两个0x00之间为空帧,接收端直接忽略。
+ *          序号每个方向一个,所有消息共用,每发一帧加1(模256),接收端据此统计链路丢帧。
+ *          数据比接收端已知的长时,多出的部分被忽略,新增字段只追加在末尾,新旧版本可以互通
+ */
+
+#ifndef PROTOCOLV2_H
+#define PROTOCOLV2_H
+
+#include "Cobs.h"
+#include "Protocol.h"
+
+enum ProtocolVersion
+{
+    PROTOCOL_V1 = 0,  ///<定长帧(0x5a/0xA5帧头 + CRC8)
+    PROTOCOL_V2 = 1   ///<COBS分帧
+};
+
+#define V2_DELIMITER   0x00  ///帧边界
+#define V2_HEADER_LEN  3     ///消息ID + 序号 + 长度
+#define V2_CRC_LEN     2
+#define V2_MAX_PAYLOAD 240
+#define V2_MAX_RAW     (V2_HEADER_LEN + V2_MAX_PAYLOAD + V2_CRC_LEN)  ///编码前最大长度
+#define V2_MAX_ENCODED COBS_MAX_ENCODED(V2_MAX_RAW)                   ///编码后最大长度(不含帧边界)
+#define V2_MAX_FRAME   (V2_MAX_ENCODED + 2)                           ///线上最大帧长(含前后帧边界)
+
+#define V2_MSG_CHASSIS        0x01  ///下位机->上位机 GroundChassisData
+#define V2_MSG_HOST           0x02  ///上位机->下位机 HostComputerData
+#define V2_MSG_COMPACT_OFFER  0x03  ///上位机->下位机 请求使用压缩编码(CompactCodec.h)
+#define V2_MSG_COMPACT_ACCEPT 0x04  ///下位机->上位机 同意/拒绝压缩编码
+#define V2_MSG_HOST_KEY       0x05  ///上位机->下位机 压缩编码关键帧
+#define V2_MSG_HOST_DELTA     0x06  ///上位机->下位机 压缩编码差分帧
+#define V2_MSG_PING           0x07  ///上位机->下位机 时钟同步请求(ClockSync.h)
+#define V2_MSG_PONG           0x08  ///下位机->上位机 时钟同步回复
+
+/// NAME    :CRC-16/CCITT-FALSE
+/// POLY    :(0x1021)->x16 + x12 + x5 + 1
+/// INIT    :FFFF
+typedef Crc16Ccitt ProtocolCrc16;
+
+///解出的一条消息,payload指向解码缓冲区,下次解码前有效
+typedef struct
+{
+    uint8_t              id;
+    uint8_t              seq;
+    uint8_t              length;
+    const unsigned char* payload;
+} MessageV2;
+
+///下位机->上位机,比V1帧多出吊射微调两个字段
+typedef PayloadSchema<GroundChassisData,
+                      Field<&GroundChassisData::gain_yaw>,
+                      Field<&GroundChassisData::gain_pitch>,
+                      Field<&GroundChassisData::mode>,
+                      Field<&GroundChassisData::color>,
+                      Field<&GroundChassisData::speed>,
+                      Field<&GroundChassisData::lob_offset_yaw>,
+                      Field<&GroundChassisData::lob_offset_pitch>>
+    ChassisPayloadV2;
+
+///上位机->下位机,字段与V1帧相同
+typedef HostFrame::Payload HostPayloadV2;
+
+///V2中只带V1字段的下位机消息仍可解析(旧固件只发V1的字段)
+const size_t CHASSIS_V2_MIN_PAYLOAD = ChassisFrame::PAYLOAD;
+
+size_t SealMessageV2(unsigned char* raw, size_t payloadLen, unsigned char* frame);
+size_t EncodeMessageV2(uint8_t id, uint8_t seq, const unsigned char* payload, size_t len, unsigned char* frame);
+bool   DecodeMessageV2(const unsigned char* encoded, size_t len, unsigned char* scratch, MessageV2& msg);
+bool   DecodeChassisV2(const MessageV2& msg, GroundChassisData& data);
+
+/**
+ * @brief EncodeMessageV2 按schema组一帧V2消息
+ * @param id     消息ID
+ * @param seq    序号
+ * @param data   数据
+ * @param frame  输出,至少V2_MAX_FRAME字节
+ * @return       线上帧长(含前后帧边界)
+ */
+template <typename Schema, typename T>
+size_t EncodeMessageV2(uint8_t id, uint8_t seq, const T& data, unsigned char* frame)
+{
+    static_assert(Schema::SIZE <= V2_MAX_PAYLOAD, "V2消息数据过长");
+
+    unsigned char raw[V2_HEADER_LEN + Schema::SIZE + V2_CRC_LEN];
+    raw[0] = id;
+    raw[1] = seq;
+    raw[2] = static_cast<unsigned char>(Schema::SIZE);
+    Schema::Encode(data, &raw[V2_HEADER_LEN]);
+
+    return SealMessageV2(raw, Schema::SIZE, frame);
+}
+
+#endif  // PROTOCOLV2_H
@@ -0,0 +1,177 @@
+/**
+ * @file    RealTime.cpp
+ * @brief   串口线程的实时配置:绑定CPU核心、SCHED_FIFO、锁定内存、预先触发缺页
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "RealTime.h"
+
+#include <alloca.h>
+#include <errno.h>
+#include <iostream>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * @brief PrefaultStack 在当前线程栈上写一遍,之后的函数调用不会再触发缺页
+ * @note  noinline保证数组真的分配在本函数的栈帧里
+ */
+__attribute__((noinline)) static void PrefaultStack(size_t len)
+{
+    volatile unsigned char* stack = static_cast<volatile unsigned char*>(alloca(len));
+    long                    page  = sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0; i < len; i += static_cast<size_t>(page))
+    {
+        stack[i] = 0;
+    }
+}
+
+/**
+ * @brief ApplyRealTime 对调用线程应用实时配置
+ * @param config        配置
+ * @param report        实际得到的结果
+ * @return              请求的各项是否全部成功
+ * @note                mlockall作用于整个进程,重复调用没有副作用
+ */
+bool ApplyRealTime(const RealTimeConfig& config, RealTimeReport& report)
+{
+    memset(&report, 0, sizeof(report));
+    report.requested = true;
+    report.cpu       = -1;
+
+    bool ok = true;
+
+    if (config.cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config.cpu, &set);
+
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err == 0)
+        {
+            report.cpu = config.cpu;
+        }
+        else
+        {
+            report.cpuErrno = err;
+            ok              = false;
+        }
+    }
+
+    if (config.priority > 0)
+    {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = config.priority;
+
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err == 0)
+        {
+            report.priority = config.priority;
+        }
+        else
+        {
+            report.fifoErrno = err;
+            ok               = false;
+        }
+    }
+
+    if (config.lockMemory)
+    {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+        {
+            report.locked = true;
+
+            ///释放的内存留在进程内,之后的malloc不再从内核要新页
+            mallopt(M_TRIM_THRESHOLD, -1);
+            mallopt(M_MMAP_MAX, 0);
+        }
+        else
+        {
+            report.lockErrno = errno;
+            ok               = false;
+        }
+
+        ///没有锁住内存时预先触发缺页仍能避免第一次用到栈时的缺页
+        PrefaultStack(RT_PREFAULT_STACK);
+        report.prefaulted = RT_PREFAULT_STACK;
+    }
+
+    return ok;
+}
+
+/**
+ * @brief PrefaultMemory 逐页读写一遍缓冲区,使其在实时线程使用前就已映射
+ * @param data           缓冲区首地址
+ * @param len            字节数
+ * @note                 写回原值,不改变内容,但不能与其他线程的写入同时进行
+ */
+void PrefaultMemory(void* data, size_t len)
+{
+    volatile unsigned char* bytes = static_cast<volatile unsigned char*>(data);
+    long                    page  = sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0; i < len; i += static_cast<size_t>(page))
+    {
+        bytes[i] = bytes[i];
+    }
+}
+
+/**
+ * @brief PrintRealTimeReport 输出实时配置实际得到的结果
+ * @param name                线程名
+ */
+void PrintRealTimeReport(const char* name, const RealTimeReport& report)
+{
+    if (!report.requested)
+    {
+        cout << name << ": 未启用实时配置" << endl;
+        return;
+    }
+
+    cout << name << ":";
+
+    if (report.cpu >= 0)
+    {
+        cout << " 绑定核心" << report.cpu;
+    }
+    else if (report.cpuErrno != 0)
+    {
+        cout << " 绑定核心失败(" << strerror(report.cpuErrno) << ")";
+    }
+
+    if (report.priority > 0)
+    {
+        cout << " SCHED_FIFO优先级" << report.priority;
+    }
+    else if (report.fifoErrno != 0)
+    {
+        cout << " SCHED_FIFO失败(" << strerror(report.fifoErrno) << "),使用普通调度";
+    }
+
+    if (report.locked)
+    {
+        cout << " 内存已锁定";
+    }
+    else if (report.lockErrno != 0)
+    {
+        cout << " mlockall失败(" << strerror(report.lockErrno) << ")";
+    }
+
+    if (report.prefaulted > 0)
+    {
+        cout << " 预触发栈" << report.prefaulted / 1024 << "KB";
+    }
+
+    cout << endl;
+}
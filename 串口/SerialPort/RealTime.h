@@ -0,0 +1,56 @@
+/**
+ * @file    RealTime.h
+ * @brief   串口线程的实时配置:绑定CPU核心、SCHED_FIFO、锁定内存、预先触发缺页
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    默认不启用。启用后由线程自己在开始运行时调用ApplyRealTime,每一项单独尝试,
+ *          没有权限(CAP_SYS_NICE/CAP_IPC_LOCK或RLIMIT_RTPRIO/RLIMIT_MEMLOCK不够)时跳过该项继续运行,
+ *          实际得到的结果记录在RealTimeReport中。
+ *          spinNs只对接收线程有效:有数据后继续忙轮询spinNs再阻塞,小于0表示一直忙轮询(独占一个核心)。
+ *          SCHED_FIFO线程忙轮询时同核心上的普通线程得不到运行,收发线程应绑定到不同的核心,
+ *          最好是用isolcpus隔离出来的核心。
+ *          lockMemory的副作用作用于整个进程且不会撤销:除mlockall外还调用mallopt(M_TRIM_THRESHOLD, -1)与mallopt(M_MMAP_MAX, 0),
+ *          释放的内存不再归还内核、大块分配也改从堆上分配,避免之后的malloc/free重新触发缺页;
+ *          进程中其他模块依赖默认malloc行为(如需要及时归还大块内存)时不要启用lockMemory。
+ *          UartReceiver/TxScheduler应用实时配置时还会预先触发各自缓冲区(接收环形缓冲区与时间戳、发送帧)的缺页
+ * @example RealTimeConfig rt = {2, RT_DEFAULT_PRIORITY, true, 200000};  //核心2,优先级80,锁内存,忙轮询200us
+ *          receiver.SetRealTime(rt);
+ *          receiver.Start(fd_serial0);
+ *          PrintRealTimeReport("接收线程", receiver.RealTime());
+ */
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RT_DEFAULT_PRIORITY 80            ///SCHED_FIFO默认优先级(1~99)
+#define RT_PREFAULT_STACK   (256 * 1024)  ///预先触发缺页的线程栈大小
+
+typedef struct
+{
+    int     cpu;         ///<绑定的CPU核心,小于0表示不绑定
+    int     priority;    ///<SCHED_FIFO优先级,0表示保持普通调度
+    bool    lockMemory;  ///<是否mlockall锁定进程内存并预先触发栈的缺页,同时调整进程的malloc参数(见上)
+    int64_t spinNs;      ///<接收线程阻塞前忙轮询的时间(ns),0表示不忙轮询,小于0表示一直忙轮询
+} RealTimeConfig;
+
+typedef struct
+{
+    bool   requested;   ///<是否启用了实时配置
+    int    cpu;         ///<实际绑定的核心,-1表示未绑定
+    int    priority;    ///<实际得到的SCHED_FIFO优先级,0表示普通调度
+    bool   locked;      ///<是否锁定了内存
+    size_t prefaulted;  ///<预先触发缺页的栈大小
+    int    cpuErrno;    ///<绑定核心失败的错误码
+    int    fifoErrno;   ///<设置SCHED_FIFO失败的错误码
+    int    lockErrno;   ///<mlockall失败的错误码
+} RealTimeReport;
+
+bool ApplyRealTime(const RealTimeConfig& config, RealTimeReport& report);
+void PrefaultMemory(void* data, size_t len);
+void PrintRealTimeReport(const char* name, const RealTimeReport& report);
+
+#endif  // REALTIME_H
@@ -0,0 +1,488 @@
+/**
+ * @file    SerialBridge.cpp
+ * @brief   串口数据本地转发:一个进程独占串口,把解析出的下位机数据广播给多个本地订阅者
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "SerialBridge.h"
+#include "Clock.h"
+
+#include <errno.h>
+#include <iostream>
+#include <poll.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define BRIDGE_BATCH 64  ///转发线程一次从队列取出的条数
+
+static bool FillAddress(const char* path, struct sockaddr_un& addr)
+{
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return false;
+    }
+    strcpy(addr.sun_path, path);
+    return true;
+}
+
+/**
+ * @brief DrainFd 读出eventfd的计数,清除可读状态
+ * @return 是否读到;计数已被清除(EAGAIN)时返回false
+ */
+static bool DrainFd(int fd)
+{
+    uint64_t count;
+    return read(fd, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count));
+}
+
+SerialBridge::SerialBridge()
+    : listenfd(-1), epfd(-1), wakefd(-1), stopfd(-1), running(false), pending(false), queue(BRIDGE_QUEUE_SIZE), seq(0), subscribers(0),
+      published(0), queueDropped(0), sent(0), dropped(0), evicted(0), rejected(0)
+{
+    path[0] = '\0';
+    for (int i = 0; i < BRIDGE_MAX_SUBSCRIBERS; i++)
+    {
+        subs[i].fd = -1;
+    }
+}
+
+SerialBridge::~SerialBridge()
+{
+    Stop();
+}
+
+/**
+ * @brief Start 监听本地套接字并启动转发线程
+ * @param path  套接字路径,残留的同名文件(上次异常退出)会被删除
+ * @return      是否启动成功
+ */
+bool SerialBridge::Start(const char* path)
+{
+    if (running.load())
+    {
+        return false;
+    }
+
+    struct sockaddr_un addr;
+    if (!FillAddress(path, addr))
+    {
+        cout << "转发套接字路径过长: " << path << endl;
+        return false;
+    }
+    strcpy(this->path, path);
+
+    listenfd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epfd     = epoll_create1(EPOLL_CLOEXEC);
+    wakefd   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    stopfd   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (listenfd == -1 || epfd == -1 || wakefd == -1 || stopfd == -1)
+    {
+        cout << "创建转发套接字失败: " << strerror(errno) << endl;
+        Stop();
+        return false;
+    }
+
+    unlink(path);
+    if (bind(listenfd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1 || listen(listenfd, BRIDGE_MAX_SUBSCRIBERS) == -1)
+    {
+        cout << "监听转发套接字失败: " << path << " " << strerror(errno) << endl;
+        Stop();
+        return false;
+    }
+
+    int                fds[3] = {listenfd, wakefd, stopfd};
+    struct epoll_event ev;
+    for (int i = 0; i < 3; i++)
+    {
+        ev.events  = EPOLLIN;
+        ev.data.fd = fds[i];
+        epoll_ctl(epfd, EPOLL_CTL_ADD, fds[i], &ev);
+    }
+
+    running.store(true);
+    worker = std::thread(&SerialBridge::Run, this);
+
+    return true;
+}
+
+/**
+ * @brief Stop 停止转发线程,断开全部订阅者并删除套接字文件
+ */
+void SerialBridge::Stop()
+{
+    if (worker.joinable())
+    {
+        uint64_t one = 1;
+        if (write(stopfd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+        {
+            cout << "通知转发线程退出失败" << endl;
+        }
+        worker.join();
+    }
+    running.store(false);
+
+    for (int i = 0; i < BRIDGE_MAX_SUBSCRIBERS; i++)
+    {
+        if (subs[i].fd != -1)
+        {
+            Remove(subs[i]);
+        }
+    }
+
+    int* fds[4] = {&listenfd, &epfd, &wakefd, &stopfd};
+    for (int i = 0; i < 4; i++)
+    {
+        if (*fds[i] != -1)
+        {
+            close(*fds[i]);
+            *fds[i] = -1;
+        }
+    }
+
+    if (path[0] != '\0')
+    {
+        unlink(path);
+        path[0] = '\0';
+    }
+}
+
+bool SerialBridge::IsRunning() const
+{
+    return running.load();
+}
+
+/**
+ * @brief Publish 提交一帧待转发的数据
+ * @note  只允许一个线程调用(串口读取/解析线程);不阻塞,队列满时丢弃本帧。
+ *        转发线程已被唤醒而尚未处理时不再写wakefd
+ */
+void SerialBridge::Publish(const GroundChassisData& data)
+{
+    Item item;
+    item.data    = data;
+    item.stampNs = MonotonicNs();
+
+    published.fetch_add(1, std::memory_order_relaxed);
+    if (queue.Push(&item, 1) == 0)
+    {
+        queueDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!pending.exchange(true, std::memory_order_seq_cst))
+    {
+        uint64_t one = 1;
+        if (write(wakefd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+        {
+            pending.store(false, std::memory_order_seq_cst);  //写入失败时下一条再唤醒
+        }
+    }
+}
+
+/**
+ * @brief OnFrame 逐帧回调形式的Publish,用于FrameParser::SetCallback
+ * @param user    SerialBridge
+ */
+void SerialBridge::OnFrame(const GroundChassisData& data, void* user)
+{
+    static_cast<SerialBridge*>(user)->Publish(data);
+}
+
+/**
+ * @brief Snapshot 取统计快照,可在任意线程调用
+ */
+void SerialBridge::Snapshot(BridgeStats& out) const
+{
+    out.subscribers  = subscribers.load(std::memory_order_relaxed);
+    out.published    = published.load(std::memory_order_relaxed);
+    out.queueDropped = queueDropped.load(std::memory_order_relaxed);
+    out.sent         = sent.load(std::memory_order_relaxed);
+    out.dropped      = dropped.load(std::memory_order_relaxed);
+    out.evicted      = evicted.load(std::memory_order_relaxed);
+    out.rejected     = rejected.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Run 转发线程主循环
+ * @note  订阅者的套接字只用于检测断开(EPOLLHUP/EPOLLERR),订阅者发来的数据直接丢弃
+ */
+void SerialBridge::Run()
+{
+    struct epoll_event events[BRIDGE_MAX_SUBSCRIBERS + 3];
+    Item               batch[BRIDGE_BATCH];
+
+    while (true)
+    {
+        int n = epoll_wait(epfd, events, BRIDGE_MAX_SUBSCRIBERS + 3, -1);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        bool stop = false;
+        for (int i = 0; i < n; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == stopfd)
+            {
+                stop = true;
+            }
+            else if (fd == listenfd)
+            {
+                Accept();
+            }
+            else if (fd == wakefd)
+            {
+                DrainFd(wakefd);
+
+                ///先清标志再取数据:清除之后提交的数据会重新写wakefd
+                pending.store(false, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                size_t got;
+                while ((got = queue.Pop(batch, BRIDGE_BATCH)) > 0)
+                {
+                    for (size_t k = 0; k < got; k++)
+                    {
+                        Broadcast(batch[k]);
+                    }
+                }
+            }
+            else
+            {
+                for (int k = 0; k < BRIDGE_MAX_SUBSCRIBERS; k++)
+                {
+                    if (subs[k].fd != fd)
+                    {
+                        continue;
+                    }
+
+                    unsigned char discard[BRIDGE_MESSAGE_SIZE];
+                    if ((events[i].events & (EPOLLHUP | EPOLLERR)) || recv(fd, discard, sizeof(discard), MSG_DONTWAIT) == 0)
+                    {
+                        Remove(subs[k]);
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    running.store(false);
+}
+
+/**
+ * @brief Accept 接受新的订阅者,连接数已满时直接关闭
+ */
+void SerialBridge::Accept()
+{
+    while (true)
+    {
+        int fd = accept4(listenfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1)
+        {
+            return;
+        }
+
+        Subscriber* sub = NULL;
+        for (int i = 0; i < BRIDGE_MAX_SUBSCRIBERS; i++)
+        {
+            if (subs[i].fd == -1)
+            {
+                sub = &subs[i];
+                break;
+            }
+        }
+        if (sub == NULL)
+        {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            close(fd);
+            continue;
+        }
+
+        ///发送缓冲区即订阅者的队列,设小一些使跟不上的订阅者尽早被发现
+        int sndbuf = BRIDGE_SNDBUF;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+        struct epoll_event ev;
+        ev.events  = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+        sub->fd      = fd;
+        sub->lost    = 0;
+        sub->backlog = 0;
+        subscribers.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Broadcast 把一条数据发给全部订阅者
+ * @note  非阻塞发送,订阅者缓冲区满时只丢弃该订阅者的这一条
+ */
+void SerialBridge::Broadcast(const Item& item)
+{
+    unsigned char msg[BRIDGE_MESSAGE_SIZE];
+    BridgeHeader  header;
+    header.seq     = seq++;
+    header.stampNs = item.stampNs;
+    ChassisPayloadV2::Encode(item.data, &msg[BridgeHeaderPayload::SIZE]);
+
+    for (int i = 0; i < BRIDGE_MAX_SUBSCRIBERS; i++)
+    {
+        Subscriber& sub = subs[i];
+        if (sub.fd == -1)
+        {
+            continue;
+        }
+
+        header.lost = sub.lost;
+        BridgeHeaderPayload::Encode(header, msg);
+
+        ssize_t n = send(sub.fd, msg, sizeof(msg), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n == static_cast<ssize_t>(sizeof(msg)))
+        {
+            sub.lost    = 0;
+            sub.backlog = 0;
+            sent.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS))
+        {
+            sub.lost++;
+            sub.backlog++;
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            if (sub.backlog > BRIDGE_MAX_BACKLOG)
+            {
+                evicted.fetch_add(1, std::memory_order_relaxed);
+                Remove(sub);
+            }
+            continue;
+        }
+
+        ///对端已关闭
+        Remove(sub);
+    }
+}
+
+void SerialBridge::Remove(Subscriber& sub)
+{
+    if (epfd != -1)
+    {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, sub.fd, NULL);
+    }
+    close(sub.fd);
+    sub.fd = -1;
+    subscribers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+BridgeSubscriber::BridgeSubscriber() : fd(-1) {}
+
+BridgeSubscriber::~BridgeSubscriber()
+{
+    Close();
+}
+
+/**
+ * @brief Connect 连接转发端
+ * @return        是否成功(串口进程未运行时失败,可稍后重试)
+ */
+bool BridgeSubscriber::Connect(const char* path)
+{
+    Close();
+
+    struct sockaddr_un addr;
+    if (!FillAddress(path, addr))
+    {
+        return false;
+    }
+
+    fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void BridgeSubscriber::Close()
+{
+    if (fd != -1)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * @brief Read      读取一条消息
+ * @param timeoutMs 最长等待时间,小于0表示一直等待
+ * @return          是否读到;超时或连接断开时返回false,断开后Fd()为-1,需重新Connect
+ */
+bool BridgeSubscriber::Read(BridgeMessage& msg, int timeoutMs)
+{
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct pollfd pfd;
+    pfd.fd     = fd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, timeoutMs) <= 0)
+    {
+        return false;
+    }
+
+    unsigned char buf[BRIDGE_MESSAGE_SIZE];
+    ssize_t       n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n == 0 || (n == -1 && errno != EAGAIN && errno != EINTR))
+    {
+        Close();
+        return false;
+    }
+    if (n != static_cast<ssize_t>(sizeof(buf)))
+    {
+        return false;
+    }
+
+    BridgeHeaderPayload::Decode(buf, msg.header);
+    memset(&msg.data, 0, sizeof(msg.data));
+    ChassisPayloadV2::Decode(&buf[BridgeHeaderPayload::SIZE], msg.data);
+
+    return true;
+}
+
+/**
+ * @brief Fd 连接的文件句柄,可加入调用者自己的poll/epoll
+ */
+int BridgeSubscriber::Fd() const
+{
+    return fd;
+}
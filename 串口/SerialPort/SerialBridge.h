@@ -0,0 +1,149 @@
+/**
+ * @file    SerialBridge.h
+ * @brief   串口数据本地转发:一个进程独占串口,把解析出的下位机数据广播给多个本地订阅者
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    串口只能由一个进程打开,日志、可视化、控制等程序通过Unix域套接字(SOCK_SEQPACKET,保留消息边界)订阅。
+ *          读取线程只把数据写入SPSC环形缓冲区并按需唤醒转发线程,不接触任何订阅者的套接字;
+ *          转发线程以非阻塞方式发送,每个订阅者的内核发送缓冲区就是它的队列:
+ *          缓冲区满时丢弃本条并计数,连续丢弃超过BRIDGE_MAX_BACKLOG条视为订阅者卡死,断开连接。
+ *          订阅者收到的每条消息带有本连接上被丢弃的条数,可据此判断自己是否跟不上。
+ *          同一台机器上对延迟更敏感的订阅者也可以直接读SHM_CHASSIS_CHANNEL共享内存(ShmChannel,多读者且不阻塞写者)
+ * @example 串口进程:
+ *          SerialBridge bridge;
+ *          bridge.Start();
+ *          receiver.Parser().SetCallback(SerialBridge::OnFrame, &bridge);
+ *          订阅进程:
+ *          BridgeSubscriber sub;
+ *          sub.Connect();
+ *          while (sub.Read(msg, 100))
+ *              ...
+ */
+
+#ifndef SERIALBRIDGE_H
+#define SERIALBRIDGE_H
+
+#include "ProtocolV2.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <thread>
+
+#define BRIDGE_SOCKET_PATH     "/tmp/serial_bridge.sock"  ///默认监听地址
+#define BRIDGE_MAX_SUBSCRIBERS 16                         ///最多同时连接的订阅者数
+#define BRIDGE_QUEUE_SIZE      1024                       ///读取线程->转发线程的队列长度(条)
+#define BRIDGE_SNDBUF          16384                      ///每个订阅者的内核发送缓冲区(字节)
+#define BRIDGE_MAX_BACKLOG     256                        ///连续丢弃超过此条数时断开订阅者
+
+///每条转发消息的头部,后接ChassisPayloadV2
+typedef struct
+{
+    uint32_t seq;      ///<转发序号,每条加1
+    uint32_t lost;     ///<自上一条送达以来本连接丢弃的条数
+    int64_t  stampNs;  ///<串口进程解析出该帧的时刻(MonotonicNs)
+} BridgeHeader;
+
+typedef PayloadSchema<BridgeHeader,
+                      Field<&BridgeHeader::seq>,
+                      Field<&BridgeHeader::lost>,
+                      Field<&BridgeHeader::stampNs>>
+    BridgeHeaderPayload;
+
+#define BRIDGE_MESSAGE_SIZE (BridgeHeaderPayload::SIZE + ChassisPayloadV2::SIZE)  ///一条转发消息的字节数
+
+///订阅者收到的一条消息
+typedef struct
+{
+    BridgeHeader      header;
+    GroundChassisData data;
+} BridgeMessage;
+
+typedef struct
+{
+    size_t   subscribers;   ///<当前连接数
+    uint64_t published;     ///<读取线程提交的条数
+    uint64_t queueDropped;  ///<转发线程来不及处理而丢弃的条数
+    uint64_t sent;          ///<送达订阅者的条数(每个订阅者分别计数)
+    uint64_t dropped;       ///<因订阅者缓冲区满而丢弃的条数
+    uint64_t evicted;       ///<因跟不上而被断开的订阅者数
+    uint64_t rejected;      ///<连接数已满而拒绝的连接数
+} BridgeStats;
+
+class SerialBridge
+{
+public:
+    SerialBridge();
+    ~SerialBridge();
+
+    bool Start(const char* path = BRIDGE_SOCKET_PATH);
+    void Stop();
+    bool IsRunning() const;
+
+    void Publish(const GroundChassisData& data);
+    void Snapshot(BridgeStats& out) const;
+
+    static void OnFrame(const GroundChassisData& data, void* user);
+
+private:
+    ///转发队列中的一条
+    typedef struct
+    {
+        GroundChassisData data;
+        int64_t           stampNs;
+    } Item;
+
+    ///一个订阅者连接,只在转发线程中访问
+    typedef struct
+    {
+        int      fd;       ///<-1表示空闲
+        uint32_t lost;     ///<待在下一条消息中报告的丢弃数
+        uint32_t backlog;  ///<连续丢弃的条数
+    } Subscriber;
+
+    void Run();
+    void Accept();
+    void Broadcast(const Item& item);
+    void Remove(Subscriber& sub);
+
+    int               listenfd;
+    int               epfd;
+    int               wakefd;   ///<读取线程提交数据后唤醒转发线程
+    int               stopfd;
+    std::thread       worker;
+    std::atomic<bool> running;
+    std::atomic<bool> pending;  ///<已写过wakefd且转发线程尚未处理,避免每条数据都产生系统调用
+    char              path[108];
+
+    SpscRing<Item> queue;
+    Subscriber     subs[BRIDGE_MAX_SUBSCRIBERS];
+    uint32_t       seq;
+
+    std::atomic<size_t>   subscribers;
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> queueDropped;
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> evicted;
+    std::atomic<uint64_t> rejected;
+};
+
+/**
+ * @brief BridgeSubscriber 订阅端,连接SerialBridge并逐条读取
+ */
+class BridgeSubscriber
+{
+public:
+    BridgeSubscriber();
+    ~BridgeSubscriber();
+
+    bool Connect(const char* path = BRIDGE_SOCKET_PATH);
+    void Close();
+    bool Read(BridgeMessage& msg, int timeoutMs);
+    int  Fd() const;
+
+private:
+    int fd;
+};
+
+#endif  // SERIALBRIDGE_H
@@ -0,0 +1,501 @@
+/**
+ * @file    SerialCapture.cpp
+ * @brief   串口原始数据录制与回放
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "SerialCapture.h"
+#include "SerialPort.h"
+
+#include <sys/mman.h>
+
+#define CAPTURE_ALIGN(n) (((n) + 7) & ~static_cast<size_t>(7))
+
+CaptureWriter::CaptureWriter()
+    : fd(-1), segmentSize(0), header(NULL), segment(NULL), segmentIndex(0), offset(0), requested(false), records(0), bytes(0), wantIndex(0), next(NULL), nextIndex(0), retired(NULL), mapFailed(false),
+      stopping(false)
+{
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    Close();
+}
+
+/**
+ * @brief Open 创建录制文件
+ * @param path        文件路径,已存在时覆盖
+ * @param segmentSize 段大小,向上取整到4KB
+ * @return            是否成功
+ */
+bool CaptureWriter::Open(const std::string& path, size_t segmentSize)
+{
+    Close();
+
+    this->segmentSize = (segmentSize + CAPTURE_HEADER_SIZE - 1) / CAPTURE_HEADER_SIZE * CAPTURE_HEADER_SIZE;
+
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1)
+    {
+        cout << "创建录制文件失败 " << path << endl;
+        return false;
+    }
+
+    if (ftruncate(fd, CAPTURE_HEADER_SIZE) == -1)
+    {
+        Close();
+        return false;
+    }
+
+    void* map = mmap(NULL, CAPTURE_HEADER_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+
+    header              = static_cast<CaptureFileHeader*>(map);
+    header->magic       = CAPTURE_MAGIC;
+    header->version     = CAPTURE_VERSION;
+    header->segmentSize = this->segmentSize;
+    header->dataEnd     = CAPTURE_HEADER_SIZE;
+    header->startNs     = MonotonicNs();
+
+    records = 0;
+    bytes   = 0;
+
+    segment = MapSegment(0);
+    if (segment == NULL)
+    {
+        Close();
+        return false;
+    }
+    segmentIndex = 0;
+    offset       = 0;
+    requested    = false;
+
+    wantIndex = 0;
+    next      = NULL;
+    nextIndex = 0;
+    retired   = NULL;
+    mapFailed = false;
+    stopping  = false;
+    mapper    = std::thread(&CaptureWriter::Prepare, this);
+
+    return true;
+}
+
+/**
+ * @brief MapSegment 分配并映射一个段
+ * @return 映射地址,失败时返回NULL
+ * @note  fallocate预先占用磁盘空间,MAP_POPULATE预先建立页表,录制过程中不会因缺页而阻塞;
+ *        除段0外都在后台映射线程中调用
+ */
+unsigned char* CaptureWriter::MapSegment(uint64_t index)
+{
+    off_t start = static_cast<off_t>(CAPTURE_HEADER_SIZE + index * segmentSize);
+    if (posix_fallocate(fd, start, static_cast<off_t>(segmentSize)) != 0)
+    {
+        cout << "录制文件分配空间失败" << endl;
+        return NULL;
+    }
+
+    void* map = mmap(NULL, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, start);
+    if (map == MAP_FAILED)
+    {
+        cout << "录制文件映射失败" << endl;
+        return NULL;
+    }
+
+    return static_cast<unsigned char*>(map);
+}
+
+/**
+ * @brief Prepare 后台映射线程:映射请求的段,解除换下来的段
+ */
+void CaptureWriter::Prepare()
+{
+    std::unique_lock<std::mutex> guard(mapLock);
+
+    while (true)
+    {
+        mapWake.wait(guard, [this] { return stopping || retired != NULL || wantIndex != 0; });
+        if (stopping)
+        {
+            break;
+        }
+
+        if (retired != NULL)
+        {
+            unsigned char* old = retired;
+            retired            = NULL;
+            guard.unlock();
+            munmap(old, segmentSize);
+            guard.lock();
+            continue;
+        }
+
+        ///映射完成前wantIndex保持不变,重复的请求不会再映射一次
+        uint64_t index = wantIndex;
+        guard.unlock();
+        unsigned char* map = MapSegment(index);
+        guard.lock();
+
+        wantIndex = 0;
+        next      = map;
+        nextIndex = map != NULL ? index : 0;
+        mapFailed = map == NULL;
+        mapDone.notify_all();
+    }
+}
+
+/**
+ * @brief RequestSegment 请求后台线程映射第index段(已映射好或已请求时无操作)
+ */
+void CaptureWriter::RequestSegment(uint64_t index)
+{
+    {
+        std::lock_guard<std::mutex> guard(mapLock);
+        if (nextIndex == index || wantIndex == index)
+        {
+            return;
+        }
+        wantIndex = index;
+        mapFailed = false;
+    }
+    mapWake.notify_one();
+}
+
+/**
+ * @brief TakeSegment 取走后台线程映射好的第index段,当前段交给后台线程解除映射
+ * @return 映射地址;后台线程还没完成时等待,映射失败时返回NULL
+ */
+unsigned char* CaptureWriter::TakeSegment(uint64_t index)
+{
+    RequestSegment(index);
+
+    std::unique_lock<std::mutex> guard(mapLock);
+    mapDone.wait(guard, [this, index] { return nextIndex == index || mapFailed; });
+    if (nextIndex != index)
+    {
+        return NULL;
+    }
+
+    unsigned char* map = next;
+    next               = NULL;
+    nextIndex          = 0;
+    retired            = segment;
+    guard.unlock();
+    mapWake.notify_one();
+
+    return map;
+}
+
+/**
+ * @brief Close 结束录制,文件截断到实际数据长度
+ */
+void CaptureWriter::Close()
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    uint64_t dataEnd = header != NULL ? header->dataEnd : 0;
+
+    if (mapper.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> mapGuard(mapLock);
+            stopping = true;
+        }
+        mapWake.notify_one();
+        mapper.join();
+    }
+    if (next != NULL)
+    {
+        munmap(next, segmentSize);
+        next = NULL;
+    }
+    if (retired != NULL)
+    {
+        munmap(retired, segmentSize);
+        retired = NULL;
+    }
+    if (segment != NULL)
+    {
+        munmap(segment, segmentSize);
+        segment = NULL;
+    }
+    if (header != NULL)
+    {
+        munmap(header, CAPTURE_HEADER_SIZE);
+        header = NULL;
+    }
+    if (fd != -1)
+    {
+        ///截断失败时文件尾部保留已分配的空段,头部的dataEnd仍是准确的,回放不受影响
+        if (dataEnd != 0 && ftruncate(fd, static_cast<off_t>(dataEnd)) == -1)
+        {
+            cout << "录制文件截断失败" << endl;
+        }
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool CaptureWriter::IsOpen() const
+{
+    return segment != NULL;
+}
+
+/**
+ * @brief Append 追加一条记录
+ * @param direction   方向
+ * @param data        数据
+ * @param len         长度,超过段大小的部分被截断
+ * @param timestampNs 时间戳,为0时取当前时刻
+ * @return            是否写入
+ */
+bool CaptureWriter::Append(CaptureDirection direction, const unsigned char* data, size_t len, int64_t timestampNs)
+{
+    if (timestampNs == 0)
+    {
+        timestampNs = MonotonicNs();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (segment == NULL)
+    {
+        return false;
+    }
+
+    size_t limit = segmentSize - sizeof(CaptureRecordHeader);
+    if (len > limit)
+    {
+        len = limit;
+    }
+
+    size_t need = sizeof(CaptureRecordHeader) + CAPTURE_ALIGN(len);
+    if (offset + need > segmentSize)
+    {
+        ///段尾剩余空间写一条跳过记录(至少能放下记录头时)
+        if (segmentSize - offset >= sizeof(CaptureRecordHeader))
+        {
+            CaptureRecordHeader skip;
+            memset(&skip, 0, sizeof(skip));
+            skip.direction = CAPTURE_SKIP;
+            skip.length    = static_cast<uint32_t>(segmentSize - offset - sizeof(CaptureRecordHeader));
+            memcpy(&segment[offset], &skip, sizeof(skip));
+        }
+
+        unsigned char* fresh = TakeSegment(segmentIndex + 1);
+        if (fresh == NULL)
+        {
+            return false;
+        }
+        segment   = fresh;
+        offset    = 0;
+        requested = false;
+        segmentIndex++;
+    }
+
+    CaptureRecordHeader record;
+    record.timestampNs = timestampNs;
+    record.length      = static_cast<uint32_t>(len);
+    record.direction   = static_cast<uint8_t>(direction);
+    memset(record.reserved, 0, sizeof(record.reserved));
+
+    memcpy(&segment[offset], &record, sizeof(record));
+    memcpy(&segment[offset + sizeof(record)], data, len);
+    offset += need;
+
+    ///写过一半时让后台线程准备下一段,换段时不再在此线程中分配与映射
+    if (!requested && offset >= segmentSize / 2)
+    {
+        RequestSegment(segmentIndex + 1);
+        requested = true;
+    }
+
+    header->dataEnd = CAPTURE_HEADER_SIZE + segmentIndex * segmentSize + offset;
+
+    records++;
+    bytes += len;
+
+    return true;
+}
+
+uint64_t CaptureWriter::Records() const
+{
+    return records;
+}
+
+uint64_t CaptureWriter::Bytes() const
+{
+    return bytes;
+}
+
+CaptureReader::CaptureReader() : fd(-1), map(NULL), mapSize(0), segmentSize(0), dataEnd(0), position(0), startNs(0) {}
+
+CaptureReader::~CaptureReader()
+{
+    Close();
+}
+
+/**
+ * @brief Open 打开录制文件(只读映射整个文件)
+ */
+bool CaptureReader::Open(const std::string& path)
+{
+    Close();
+
+    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        cout << "打开录制文件失败 " << path << endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size < CAPTURE_HEADER_SIZE)
+    {
+        Close();
+        return false;
+    }
+
+    mapSize  = static_cast<size_t>(st.st_size);
+    void* mm = mmap(NULL, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (mm == MAP_FAILED)
+    {
+        map = NULL;
+        Close();
+        return false;
+    }
+    map = static_cast<const unsigned char*>(mm);
+    madvise(mm, mapSize, MADV_SEQUENTIAL);
+
+    CaptureFileHeader header;
+    memcpy(&header, map, sizeof(header));
+    if (header.magic != CAPTURE_MAGIC || header.version != CAPTURE_VERSION || header.segmentSize == 0)
+    {
+        cout << "录制文件格式错误 " << path << endl;
+        Close();
+        return false;
+    }
+
+    segmentSize = header.segmentSize;
+    dataEnd     = header.dataEnd < mapSize ? header.dataEnd : mapSize;
+    startNs     = header.startNs;
+    position    = CAPTURE_HEADER_SIZE;
+
+    return true;
+}
+
+void CaptureReader::Close()
+{
+    if (map != NULL)
+    {
+        munmap(const_cast<unsigned char*>(map), mapSize);
+        map = NULL;
+    }
+    if (fd != -1)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * @brief Next 读取下一条记录,数据直接指向映射区,不拷贝
+ * @return      是否还有记录
+ */
+bool CaptureReader::Next(CaptureRecord& record)
+{
+    while (map != NULL && position + sizeof(CaptureRecordHeader) <= dataEnd)
+    {
+        uint64_t inSegment = (position - CAPTURE_HEADER_SIZE) % segmentSize;
+        if (segmentSize - inSegment < sizeof(CaptureRecordHeader))
+        {
+            position += segmentSize - inSegment;
+            continue;
+        }
+
+        CaptureRecordHeader header;
+        memcpy(&header, &map[position], sizeof(header));
+
+        uint64_t next = position + sizeof(header) + CAPTURE_ALIGN(static_cast<size_t>(header.length));
+        if (header.direction == CAPTURE_SKIP)
+        {
+            position = next;
+            continue;
+        }
+        if (position + sizeof(header) + header.length > dataEnd)
+        {
+            break;
+        }
+
+        record.timestampNs = header.timestampNs;
+        record.direction   = static_cast<CaptureDirection>(header.direction);
+        record.data        = &map[position + sizeof(header)];
+        record.length      = header.length;
+
+        position = next;
+        return true;
+    }
+
+    return false;
+}
+
+void CaptureReader::Rewind()
+{
+    position = CAPTURE_HEADER_SIZE;
+}
+
+int64_t CaptureReader::StartNs() const
+{
+    return startNs;
+}
+
+long ReplayCapture(const std::string& path, Uart& uart, ReplaySpeed speed, GroundChassisData& data)
+{
+    CaptureReader reader;
+    if (!reader.Open(path))
+    {
+        return -1;
+    }
+
+    long          replayed = 0;
+    int64_t       firstNs  = 0;
+    int64_t       beginNs  = MonotonicNs();
+    CaptureRecord record;
+
+    while (reader.Next(record))
+    {
+        if (record.direction != CAPTURE_RX)
+        {
+            continue;
+        }
+
+        if (speed == REPLAY_ORIGINAL)
+        {
+            if (replayed == 0)
+            {
+                firstNs = record.timestampNs;
+            }
+
+            int64_t due = beginNs + (record.timestampNs - firstNs);
+            if (due > MonotonicNs())
+            {
+                struct timespec ts;
+                ts.tv_sec  = due / 1000000000LL;
+                ts.tv_nsec = due % 1000000000LL;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            }
+        }
+
+        uart.Decode(record.data, record.length, data);
+        replayed++;
+    }
+
+    return replayed;
+}
@@ -0,0 +1,150 @@
+/**
+ * @file    SerialCapture.h
+ * @brief   串口原始数据录制与回放
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    文件格式: | 文件头(4KB) | 段0 | 段1 | ... |
+ *          每段大小固定且预先分配(fallocate + mmap),段内依次存放记录:
+ *          | 时间戳(8B) | 长度(4B) | 方向(1B) | 保留(3B) | 数据(按8字节对齐) |
+ *          记录不跨段,段尾放不下时写一条跳过记录。录制时每条记录只有一次memcpy,不分配内存,
+ *          文件头中的dataEnd随每条记录更新,程序崩溃时已写入的数据仍可回放。
+ *          分配与映射下一段(fallocate + MAP_POPULATE,16MB时耗时数毫秒)由后台线程在当前段写过一半时完成,
+ *          Append换段时只交换指针,旧段也由后台线程解除映射;后台线程来不及时Append才等待它
+ */
+
+#ifndef SERIALCAPTURE_H
+#define SERIALCAPTURE_H
+
+#include "FrameParser.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+
+#define CAPTURE_MAGIC        0x50414353  ///"SCAP"
+#define CAPTURE_VERSION      1
+#define CAPTURE_HEADER_SIZE  4096
+#define CAPTURE_SEGMENT_SIZE (16 << 20)  ///默认段大小16MB
+
+enum CaptureDirection
+{
+    CAPTURE_RX   = 1,  ///<下位机->上位机
+    CAPTURE_TX   = 2,  ///<上位机->下位机
+    CAPTURE_SKIP = 3   ///<段尾填充
+};
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t segmentSize;
+    uint64_t dataEnd;  ///<最后一条记录之后的文件偏移
+    int64_t  startNs;  ///<开始录制的时刻(MonotonicNs)
+} CaptureFileHeader;
+
+typedef struct
+{
+    int64_t  timestampNs;  ///<MonotonicNs
+    uint32_t length;       ///<数据长度(不含对齐填充)
+    uint8_t  direction;    ///<CaptureDirection
+    uint8_t  reserved[3];
+} CaptureRecordHeader;
+
+class CaptureWriter
+{
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+
+    bool Open(const std::string& path, size_t segmentSize = CAPTURE_SEGMENT_SIZE);
+    void Close();
+    bool IsOpen() const;
+    bool Append(CaptureDirection direction, const unsigned char* data, size_t len, int64_t timestampNs = 0);
+
+    uint64_t Records() const;
+    uint64_t Bytes() const;
+
+private:
+    unsigned char* MapSegment(uint64_t index);
+    void           RequestSegment(uint64_t index);
+    unsigned char* TakeSegment(uint64_t index);
+    void           Prepare();
+
+    int                fd;
+    size_t             segmentSize;
+    CaptureFileHeader* header;        ///<常驻映射的文件头
+    unsigned char*     segment;       ///<当前段
+    uint64_t           segmentIndex;  ///<当前段序号
+    size_t             offset;        ///<当前段内写入位置
+    bool               requested;     ///<是否已请求预先映射下一段
+    uint64_t           records;
+    uint64_t           bytes;
+    std::mutex         lock;  ///<接收线程与发送线程可能同时录制
+
+    ///后台映射线程,以下状态由mapLock保护
+    std::thread             mapper;
+    std::mutex              mapLock;
+    std::condition_variable mapWake;    ///<有新请求、有待解除的映射或需要退出
+    std::condition_variable mapDone;    ///<下一段已映射(或映射失败)
+    uint64_t                wantIndex;  ///<请求映射的段序号,0表示没有请求(段0在Open中直接映射)
+    unsigned char*          next;       ///<已映射好的下一段
+    uint64_t                nextIndex;  ///<next的段序号
+    unsigned char*          retired;    ///<换下来、等待解除映射的段
+    bool                    mapFailed;
+    bool                    stopping;
+};
+
+typedef struct
+{
+    int64_t              timestampNs;
+    CaptureDirection     direction;
+    const unsigned char* data;
+    size_t               length;
+} CaptureRecord;
+
+class CaptureReader
+{
+public:
+    CaptureReader();
+    ~CaptureReader();
+
+    bool Open(const std::string& path);
+    void Close();
+    bool Next(CaptureRecord& record);
+    void Rewind();
+
+    int64_t StartNs() const;
+
+private:
+    int                  fd;
+    const unsigned char* map;
+    size_t               mapSize;
+    uint64_t             segmentSize;
+    uint64_t             dataEnd;
+    uint64_t             position;
+    int64_t              startNs;
+};
+
+enum ReplaySpeed
+{
+    REPLAY_ORIGINAL = 0,  ///<按录制时的时间间隔回放
+    REPLAY_MAX      = 1   ///<尽可能快
+};
+
+class Uart;
+
+/**
+ * @brief ReplayCapture 把录制文件中的接收数据送入Uart::Decode(与GetMode相同的解析路径)
+ * @param path  录制文件
+ * @param uart  用于解析的Uart
+ * @param speed 回放速度
+ * @param data  每解析出新的数据时更新
+ * @return      回放的接收记录数,文件打开失败返回-1
+ */
+long ReplayCapture(const std::string& path, Uart& uart, ReplaySpeed speed, GroundChassisData& data);
+
+#endif  // SERIALCAPTURE_H
@@ -8,16 +8,21 @@
 
 #include "SerialPort.h"
 
-Uart::Uart() {}
+Uart::Uart() : verbose(false), recorder(NULL), protocol(PROTOCOL_V1), txSeq(0), compact(NULL), clock(NULL)
+{
+    parser.SetStats(&stats);
+}
 
 /**
  * @brief GetMode 接收数据
  * @param fd      打开串口的文件句柄
  * @param data    接收的数据
- * @note    buffer：| 数据1 | 数据2 | 无效数据3 | 数据4 | ---> 我们应该获取缓冲区中最新的数据，即数据4，则从后往前校验
- *          | 0x5a | gain_yaw | gain_pitch | mode | color | speed | lob_offset_yaw | lob_offset_pitch |CRC8 check |
+ * @note    | 0x5a | gain_yaw | gain_pitch | mode | color | speed | CRC8 check |
+ *          buffer：| 数据1 | 数据2 | 无效数据3 | 数据4 | ---> 由解析器按顺序校验所有帧,data取最新的数据4;
+ *          被拆分到两次读取中的帧由解析器保留,下次调用时拼接完整
+ * @return  本次读取的字节数,读取失败返回-1
  */
-void Uart::GetMode(int& fd, GroundChassisData& data)
+int Uart::GetMode(int& fd, GroundChassisData& data)
 {
     int bytes;
 
@@ -25,91 +30,239 @@ void Uart::GetMode(int& fd, GroundChassisData& data)
 
     if (bytes == -1)
     {
-        cout << "从串口读取数据失败" << endl;
-        return;
+        if (verbose || errno != EAGAIN)
+        {
+            cout << "从串口读取数据失败" << endl;
+        }
+        return -1;
     }
     else if (bytes == 0)
     {
-        cout << "未从串口读取到数据" << endl;
-        return;
+        if (verbose)
+        {
+            cout << "未从串口读取到数据" << endl;
+        }
+        return 0;
     }
-    else
+    else if (verbose)
     {
         cout << "bytes= " << bytes << endl;
     }
 
-    ///在读取到的数据中从后往前依次进行校验
-    /// 1. bytes-n   :n为总数据长度
-    /// 2. rdata[i+x]:x为有效数据长度+1CRC
-    /// 3. CRC(...,y):y为有效数据长度
-    for (uint8_t i = bytes - 13; i != 0; i--)
+    if (recorder != NULL)
     {
-        if (rdata[i] == 0x5a && rdata[i + 12] == CRC8Check(&rdata[i + 1], 11))
-        {
-            data.gain_yaw.c[0] = rdata[i + 1];
-            data.gain_yaw.c[1] = rdata[i + 2];
-            data.gain_yaw.c[2] = rdata[i + 3];
-            data.gain_yaw.c[3] = rdata[i + 4];
+        recorder->Append(CAPTURE_RX, rdata, static_cast<size_t>(bytes));
+    }
 
-            data.gain_pitch.c[0] = rdata[i + 5];
-            data.gain_pitch.c[1] = rdata[i + 6];
-            data.gain_pitch.c[2] = rdata[i + 7];
-            data.gain_pitch.c[3] = rdata[i + 8];
+    Decode(rdata, static_cast<size_t>(bytes), data);
+    return bytes;
+}
 
-            data.mode  = rdata[i + 9];
-            data.color = rdata[i + 10];
-            data.speed = rdata[i + 11];
+/**
+ * @brief Decode 解析一段接收到的原始数据(GetMode读取之后的路径,回放录制文件时也走这里)
+ * @param buf    原始数据
+ * @param len    数据长度
+ * @param data   解析出新帧时更新为最新的数据
+ */
+void Uart::Decode(const unsigned char* buf, size_t len, GroundChassisData& data)
+{
+    int64_t readNs = MonotonicNs();
+    stats.AddRead(static_cast<uint64_t>(len));
 
-            return;
-        }
+    parser.SetRxTime(readNs);
+    size_t frames = parser.Feed(buf, len);
+    if (frames > 0)
+    {
+        stats.rxLatency.Record(MonotonicNs() - readNs, frames);
     }
+    parser.TakeLatest(data);
+}
+
+/**
+ * @brief UnpackFrame 校验并解析一帧下位机数据
+ * @param frame       帧首地址(指向0x5a帧头,之后至少有RX_FRAME_LEN个字节)
+ * @param data        解析得到的数据
+ * @return            帧头与CRC均正确时返回true,否则data不被修改
+ */
+bool Uart::UnpackFrame(const unsigned char* frame, GroundChassisData& data)
+{
+    return ChassisFrame::Decode(frame, data);
+}
+
+/**
+ * @brief Parser GetMode所用的解析器,用于设置逐帧回调与读取解析统计
+ */
+FrameParser& Uart::Parser()
+{
+    return parser;
 }
 
 /**
  * @brief TransformTarPos 传输数据
  * @param fd              打开串口的文件句柄
  * @param data            发送的数据
+ * @param publishedNs     数据的发布时刻(MonotonicNs),非0时统计发布->写入延迟
  * @note | 0xA5 | Pitch | Yaw | Distance | CRC8 check |
+ *       PROTOCOL_V2下为V2_MSG_HOST消息,字段顺序相同
+ * @return 是否完整写入,失败时errno保留write的错误码
+ */
+bool Uart::TransformTarPos(int& fd, const HostComputerData& data, int64_t publishedNs)
+{
+    size_t len = EncodeTarPos(data, Sdata);
+
+    if (write(fd, Sdata, len) == static_cast<ssize_t>(len))
+    {
+        CommitWrite(Sdata, len, publishedNs);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief EncodeTarPos 按当前协议组一帧上位机数据(V2下序号加1)
+ * @param data         发送的数据
+ * @param frame        输出,至少V2_MAX_FRAME字节
+ * @return             帧长(V2压缩编码协商期间可能附带一条协商请求,到时间时前面附带一条时钟同步请求)
+ */
+size_t Uart::EncodeTarPos(const HostComputerData& data, unsigned char* frame)
+{
+    static_assert(sizeof(Sdata) >= V2_MAX_FRAME, "发送缓冲区小于V2最大帧长");
+
+    ///时钟同步请求排在最前面,t1与实际写出的时刻只差组帧的时间
+    size_t len = 0;
+    if (protocol == PROTOCOL_V2 && clock != NULL && clock->Due(MonotonicNs()))
+    {
+        len = clock->EncodePing(txSeq++, frame);
+    }
+
+    ///帧头、有效数据与CRC8校验位的排列由HostFrame描述
+    if (protocol == PROTOCOL_V2 && compact != NULL)
+    {
+        return len + compact->Encode(data, txSeq, &frame[len]);
+    }
+    if (protocol == PROTOCOL_V2)
+    {
+        return len + EncodeMessageV2<HostPayloadV2>(V2_MSG_HOST, txSeq++, data, &frame[len]);
+    }
+
+    HostFrame::Encode(data, frame);
+    return TX_FRAME_LEN;
+}
+
+/**
+ * @brief CommitWrite 一帧已完整写入串口:录制并计入统计
+ * @param frame       帧
+ * @param len         帧长
+ * @param publishedNs 数据的发布时刻(MonotonicNs),非0时统计发布->写入延迟
+ * @note              自行写串口(如TxScheduler批量writev)时调用
+ */
+void Uart::CommitWrite(const unsigned char* frame, size_t len, int64_t publishedNs)
+{
+    if (recorder != NULL)
+    {
+        recorder->Append(CAPTURE_TX, frame, len);
+    }
+    stats.AddWrite(len);
+    if (publishedNs != 0)
+    {
+        stats.txLatency.Record(MonotonicNs() - publishedNs);
+    }
+}
+
+/**
+ * @brief Stats 收发统计,可在任意线程取快照
+ */
+UartStats& Uart::Stats()
+{
+    return stats;
+}
+
+/**
+ * @brief SetVerbose 是否在每次读取时打印字节数(调试用,会增加热路径延迟)
+ */
+void Uart::SetVerbose(bool verbose)
+{
+    this->verbose = verbose;
+}
+
+/**
+ * @brief SetRecorder 设置录制器,之后每次读到与写出的原始数据都追加到录制文件
+ * @param recorder    已打开的录制器,NULL表示停止录制
  */
-void Uart::TransformTarPos(int& fd, const HostComputerData& data)
+void Uart::SetRecorder(CaptureWriter* recorder)
 {
-    ///帧头
-    Sdata[0] = 0xA5;
-
-    ///有效数据
-    Sdata[1]  = data.pitch.c[0];
-    Sdata[2]  = data.pitch.c[1];
-    Sdata[3]  = data.pitch.c[2];
-    Sdata[4]  = data.pitch.c[3];
-    Sdata[5]  = data.yaw.c[0];
-    Sdata[6]  = data.yaw.c[1];
-    Sdata[7]  = data.yaw.c[2];
-    Sdata[8]  = data.yaw.c[3];
-    Sdata[9]  = data.distance.c[0];
-    Sdata[10] = data.distance.c[1];
-    Sdata[11] = data.distance.c[2];
-    Sdata[12] = data.distance.c[3];
-
-    /// CRC8校验位
-    Sdata[13] = CRC8Check(&Sdata[1], 12);
-
-    write(fd, Sdata, 14);
+    this->recorder = recorder;
+}
+
+/**
+ * @brief SetProtocol 设置收发使用的协议版本(默认PROTOCOL_V1,需与下位机固件一致)
+ */
+void Uart::SetProtocol(ProtocolVersion protocol)
+{
+    this->protocol = protocol;
+    parser.SetProtocol(protocol);
+}
+
+/**
+ * @brief SetCompact 启用上位机数据的压缩编码(仅PROTOCOL_V2,与下位机协商成功后生效)
+ * @param compact    压缩编码链路状态,NULL表示不使用;其OnAccept需注册到接收端的分发表
+ */
+void Uart::SetCompact(CompactLink* compact)
+{
+    this->compact = compact;
+}
+
+/**
+ * @brief SetClockSync 发送目标时每隔CLOCK_PING_INTERVAL_NS附带一条时钟同步请求(仅PROTOCOL_V2)
+ * @param clock        时钟同步状态,NULL表示不发送;其OnPong需注册到接收端的分发表
+ */
+void Uart::SetClockSync(ClockSync* clock)
+{
+    this->clock = clock;
 }
 
 /**
  * @brief InitSerial 初始化串口
  * @param fdcom       打开串口的文件句柄
  * @return
+ * @note  只有UART_DEVICE_0打不开时才改用UART_DEVICE_1;打开后设置属性失败直接返回,不再尝试另一个
  */
 int Uart::InitSerial(int& fdcom)
 {
-    fdcom = open(UART_DEVICE_0, O_RDWR | O_NONBLOCK);  //打开串口文件　读写＆非堵塞
+    const char* device = UART_DEVICE_0;
+    fdcom              = open(device, O_RDWR | O_NONBLOCK | O_NOCTTY);  //打开串口文件　读写＆非堵塞
 
     if (fdcom == -1)
     {
-        fdcom = open(UART_DEVICE_1, O_RDWR | O_NONBLOCK);
+        device = UART_DEVICE_1;
+        fdcom  = open(device, O_RDWR | O_NONBLOCK | O_NOCTTY);
     }
 
+    return SetupSerial(fdcom, device);
+}
+
+/**
+ * @brief InitSerial 打开指定的串口设备并按默认参数初始化
+ * @param fdcom       打开串口的文件句柄
+ * @param device      设备路径,如"/dev/ttyUSB0"或伪终端"/dev/pts/3"
+ * @return
+ */
+int Uart::InitSerial(int& fdcom, const char* device)
+{
+    fdcom = open(device, O_RDWR | O_NONBLOCK | O_NOCTTY);  //打开串口文件　读写＆非堵塞
+
+    return SetupSerial(fdcom, device);
+}
+
+/**
+ * @brief SetupSerial 检查打开结果并按默认参数设置串口
+ * @param fdcom       open的结果,设置失败时关闭并置为-1
+ * @param device      设备路径,只用于打印
+ * @return
+ */
+int Uart::SetupSerial(int& fdcom, const char* device)
+{
     if (fdcom == -1)
     {
         cout << "串口打开失败" << endl;
@@ -117,12 +270,15 @@ int Uart::InitSerial(int& fdcom)
     }
     else
     {
-        cout << "串口打开成功->串口数= " << fdcom << endl;
+        cout << "串口打开成功->" << device << " 串口数= " << fdcom << endl;
     }
 
     //设置串口属性
     if (!SetUart(fdcom, BAUDRATE, 0, 8, 1, 'N'))
     {
+        cout << "串口设置失败->" << device << endl;
+        close(fdcom);
+        fdcom = -1;
         return -1;
     }
 
@@ -135,20 +291,10 @@ int Uart::InitSerial(int& fdcom)
  * @param len       数据长度
  * @return          计算得出的CRC值
  */
-unsigned char Uart::CRC8Check(uint8_t* addr, int len)
+unsigned char Uart::CRC8Check(const uint8_t* addr, int len)
 {
-    unsigned char temp;
-    unsigned char crc = CRC8_INIT;  // CRC8初始值
-
-    ///相当于模2除法求余数
-    for (; len > 0; len--)
-    {
-        temp = *addr++;
-        crc  = crc ^ temp;  //与CRC初始值异或
-        crc  = CRC8_TAB[crc];
-    }
-
-    return crc;  //返回最终校验值
+    ///查找表由ProtocolCrc8在编译期生成
+    return static_cast<unsigned char>(ProtocolCrc8::Compute(addr, static_cast<size_t>(len)));
 }
 
 /**
@@ -190,12 +336,15 @@ bool Uart::SetUart(int fd, int speed, int flow, int databits, int stopbits, int
     {
     case 0:  //不使用流控制
         options.c_cflag &= ~CRTSCTS;
+        options.c_iflag &= ~(IXON | IXOFF | IXANY);
         break;
     case 1:  //使用硬件流控制
         options.c_cflag |= CRTSCTS;
+        options.c_iflag &= ~(IXON | IXOFF | IXANY);
         break;
     case 2:  //使用软件流控制
-        options.c_cflag |= (IXON | IXOFF | IXANY);
+        options.c_cflag &= ~CRTSCTS;
+        options.c_iflag |= (IXON | IXOFF | IXANY);
         break;
     default:
         cout << "设置数据流控制错误" << endl;
@@ -266,8 +415,9 @@ bool Uart::SetUart(int fd, int speed, int flow, int databits, int stopbits, int
         return false;
     }
 
-    options.c_oflag &= ~OPOST;                           //输出标志：设置原始输出
-    options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);  //本地标志：选择原始模式
+    options.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL);  //输入标志：不转换0x0d/0x0a等字节,二进制数据原样接收
+    options.c_oflag &= ~OPOST;                                                        //输出标志：设置原始输出
+    options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);                               //本地标志：选择原始模式
 
     ///设置等待时间和最小接收字符
     /// VTIME=0 如果有数据可用，则read最多返回所要求的字节数
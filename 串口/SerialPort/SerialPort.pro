@@ -1,16 +1,60 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++2a
 CONFIG -= app_bundle
 CONFIG -= qt
 
+# GCC 10需要显式打开协程支持
+*-g++*: QMAKE_CXXFLAGS += -fcoroutines
+
 INCLUDEPATH +=/usr/local/include/
 INCLUDEPATH +=/usr/local/include/opencv4/
 INCLUDEPATH +=/usr/local/include/opencv4/opencv2/
 LIBS += /usr/local/lib/*.so
+LIBS += -lpthread
+LIBS += -lrt
 
 SOURCES += \
+        AsyncUart.cpp \
+        ClockSync.cpp \
+        Cobs.cpp \
+        CompactCodec.cpp \
+        Crc.cpp \
+        EventLoop.cpp \
+        FrameParser.cpp \
+        PortManager.cpp \
+        ProtocolV2.cpp \
+        RealTime.cpp \
+        SerialBridge.cpp \
+        SerialCapture.cpp \
         SerialPort.cpp \
+        ShmChannel.cpp \
+        TxScheduler.cpp \
+        UartReceiver.cpp \
+        UartStats.cpp \
         main.cpp
 
 HEADERS += \
-    SerialPort.h
+    AsyncUart.h \
+    Clock.h \
+    ClockSync.h \
+    Cobs.h \
+    CompactCodec.h \
+    Crc.h \
+    DispatchTable.h \
+    EventLoop.h \
+    FrameParser.h \
+    FrameSchema.h \
+    Mailbox.h \
+    PortManager.h \
+    Protocol.h \
+    ProtocolV2.h \
+    RealTime.h \
+    SerialBridge.h \
+    SerialCapture.h \
+    SerialPort.h \
+    ShmChannel.h \
+    SpscRing.h \
+    Task.h \
+    TxScheduler.h \
+    UartReceiver.h \
+    UartStats.h
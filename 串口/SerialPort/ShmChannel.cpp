@@ -0,0 +1,367 @@
+/**
+ * @file    ShmChannel.cpp
+ * @brief   进程间共享内存通道:定长消息环形缓冲区 + futex唤醒
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "ShmChannel.h"
+#include "Clock.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <iostream>
+#include <limits.h>
+#include <linux/futex.h>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+#define SHM_MAGIC        0x53484d31  ///"SHM1"
+#define SHM_VERSION      1
+#define SHM_MAX_MSG_SIZE 256         ///单条消息最大字节数
+#define SHM_SLOT_WORDS   2           ///槽位头部:序号 + 发布时刻
+
+static size_t RoundUp(size_t value, size_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+static size_t RoundUpPow2(size_t value)
+{
+    size_t n = 1;
+    while (n < value)
+    {
+        n <<= 1;
+    }
+    return n;
+}
+
+static void FutexWait(std::atomic<uint32_t>* addr, uint32_t expected, const struct timespec* timeout)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static void FutexWakeAll(std::atomic<uint32_t>* addr)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+ShmChannel::ShmChannel() : fd(-1), header(NULL), slots(NULL), mapLen(0), words(0), mask(0), cursor(0), lost(0) {}
+
+ShmChannel::~ShmChannel()
+{
+    Close();
+}
+
+/**
+ * @brief Open     打开(不存在时创建)共享内存通道
+ * @param name     名称,以'/'开头,如SHM_HOST_CHANNEL
+ * @param msgSize  消息字节数,不超过SHM_MAX_MSG_SIZE
+ * @param capacity 槽位数,向上取整到2的幂
+ * @return         是否成功;已存在的通道参数不一致或不属于当前用户时失败(删除/dev/shm下的同名文件后重试)
+ * @note           读取位置初始化为当前的最新位置,只收打开之后发布的消息
+ */
+bool ShmChannel::Open(const char* name, size_t msgSize, size_t capacity)
+{
+    if (header != NULL || msgSize == 0 || msgSize > SHM_MAX_MSG_SIZE)
+    {
+        return false;
+    }
+
+    capacity        = RoundUpPow2(capacity);
+    words           = RoundUp(msgSize, 8) / 8;
+    size_t slotSize = RoundUp((SHM_SLOT_WORDS + words) * 8, 64);
+    mapLen          = RoundUp(sizeof(ShmHeader), 64) + capacity * slotSize;
+
+    bool creator = true;
+    fd           = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, SHM_FILE_MODE);
+    if (fd == -1 && errno == EEXIST)
+    {
+        creator = false;
+        fd      = shm_open(name, O_RDWR | O_CLOEXEC, SHM_FILE_MODE);
+    }
+    if (fd == -1)
+    {
+        cout << "打开共享内存失败: " << name << " " << strerror(errno) << endl;
+        return false;
+    }
+
+    ///通道传递的是执行机构的指令:只使用本用户的共享内存,旧版本以0666创建的收紧为SHM_FILE_MODE
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_uid != geteuid())
+    {
+        cout << "共享内存不属于当前用户: " << name << endl;
+        Close();
+        return false;
+    }
+    if ((st.st_mode & 0777 & ~static_cast<mode_t>(SHM_FILE_MODE)) != 0 && fchmod(fd, SHM_FILE_MODE) == -1)
+    {
+        cout << "收紧共享内存权限失败: " << name << " " << strerror(errno) << endl;
+        Close();
+        return false;
+    }
+
+    if (creator && ftruncate(fd, static_cast<off_t>(mapLen)) == -1)
+    {
+        cout << "设置共享内存大小失败: " << strerror(errno) << endl;
+        shm_unlink(name);
+        Close();
+        return false;
+    }
+
+    ///另一端刚创建、尚未设置大小时稍等
+    int64_t deadline = MonotonicNs() + SHM_OPEN_TIMEOUT_NS;
+    while (!creator && fstat(fd, &st) == 0 && st.st_size == 0 && MonotonicNs() < deadline)
+    {
+        usleep(1000);
+    }
+    if (!creator && (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) != mapLen))
+    {
+        cout << "共享内存大小与本端参数不一致: " << name << endl;
+        Close();
+        return false;
+    }
+
+    void* addr = mmap(NULL, mapLen, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        cout << "映射共享内存失败: " << strerror(errno) << endl;
+        Close();
+        return false;
+    }
+    header = static_cast<ShmHeader*>(addr);
+    slots  = static_cast<unsigned char*>(addr) + RoundUp(sizeof(ShmHeader), 64);
+    mask   = capacity - 1;
+
+    if (creator)
+    {
+        ///ftruncate得到的内存全为0,槽位序号0表示从未写入
+        new (header) ShmHeader();
+        header->version  = SHM_VERSION;
+        header->msgSize  = static_cast<uint32_t>(msgSize);
+        header->slotSize = static_cast<uint32_t>(slotSize);
+        header->capacity = capacity;
+        header->magic.store(SHM_MAGIC, std::memory_order_release);
+    }
+    else
+    {
+        while (header->magic.load(std::memory_order_acquire) != SHM_MAGIC && MonotonicNs() < deadline)
+        {
+            usleep(1000);
+        }
+        if (header->magic.load(std::memory_order_acquire) != SHM_MAGIC || header->version != SHM_VERSION || header->msgSize != msgSize ||
+            header->slotSize != slotSize || header->capacity != capacity)
+        {
+            cout << "共享内存格式与本端不一致: " << name << endl;
+            Close();
+            return false;
+        }
+    }
+
+    cursor = header->head.load(std::memory_order_acquire);
+    lost   = 0;
+
+    return true;
+}
+
+/**
+ * @brief Close 解除映射,共享内存本身保留
+ */
+void ShmChannel::Close()
+{
+    if (header != NULL)
+    {
+        munmap(header, mapLen);
+        header = NULL;
+        slots  = NULL;
+    }
+    if (fd != -1)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+bool ShmChannel::IsOpen() const
+{
+    return header != NULL;
+}
+
+/**
+ * @brief Unlink 删除共享内存(两端都不再使用,或需要更换参数时)
+ */
+bool ShmChannel::Unlink(const char* name)
+{
+    return shm_unlink(name) == 0;
+}
+
+std::atomic<uint64_t>* ShmChannel::Slot(uint64_t index) const
+{
+    return reinterpret_cast<std::atomic<uint64_t>*>(slots + (index & mask) * header->slotSize);
+}
+
+/**
+ * @brief Publish 发布一条消息(每个通道只允许一个写者)
+ * @param msg     消息,msgSize字节
+ * @note          不等待读者;有读者在等待时唤醒
+ */
+void ShmChannel::Publish(const void* msg)
+{
+    uint64_t buf[SHM_MAX_MSG_SIZE / 8] = {};
+    memcpy(buf, msg, header->msgSize);
+
+    uint64_t               index = header->head.load(std::memory_order_relaxed);
+    std::atomic<uint64_t>* slot  = Slot(index);
+
+    slot[0].store(2 * index + 1, std::memory_order_relaxed);  //奇数:写入中
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < words; i++)
+    {
+        slot[SHM_SLOT_WORDS + i].store(buf[i], std::memory_order_relaxed);
+    }
+    slot[1].store(static_cast<uint64_t>(MonotonicNs()), std::memory_order_relaxed);
+
+    slot[0].store(2 * index + 2, std::memory_order_release);
+    header->head.store(index + 1, std::memory_order_release);
+    header->producerPid.store(static_cast<uint32_t>(getpid()), std::memory_order_relaxed);
+
+    header->wake.fetch_add(1, std::memory_order_seq_cst);
+    if (header->waiters.load(std::memory_order_seq_cst) > 0)
+    {
+        FutexWakeAll(&header->wake);
+    }
+}
+
+/**
+ * @brief TryRead     读取下一条消息,不等待
+ * @param msg         输出,msgSize字节
+ * @param publishedNs 可选,输出发布时刻(MonotonicNs,两个进程共用同一时钟)
+ * @return            是否读到
+ */
+bool ShmChannel::TryRead(void* msg, int64_t* publishedNs)
+{
+    uint64_t buf[SHM_MAX_MSG_SIZE / 8];
+    uint64_t capacity = mask + 1;
+
+    while (true)
+    {
+        uint64_t head = header->head.load(std::memory_order_acquire);
+        if (cursor >= head)
+        {
+            cursor = head;  //共享内存被删除重建后编号从0开始
+            return false;
+        }
+
+        ///落后超过一圈:跳到最旧的未被覆盖的消息
+        if (head - cursor > capacity)
+        {
+            lost += head - capacity - cursor;
+            cursor = head - capacity;
+        }
+
+        std::atomic<uint64_t>* slot   = Slot(cursor);
+        uint64_t               expect = 2 * cursor + 2;
+        uint64_t               s1     = slot[0].load(std::memory_order_acquire);
+        if (s1 != expect)
+        {
+            lost++;
+            cursor++;
+            continue;
+        }
+
+        for (size_t i = 0; i < words; i++)
+        {
+            buf[i] = slot[SHM_SLOT_WORDS + i].load(std::memory_order_relaxed);
+        }
+        uint64_t stamp = slot[1].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot[0].load(std::memory_order_relaxed) != s1)
+        {
+            ///读取期间被覆盖
+            lost++;
+            cursor++;
+            continue;
+        }
+
+        memcpy(msg, buf, header->msgSize);
+        if (publishedNs != NULL)
+        {
+            *publishedNs = static_cast<int64_t>(stamp);
+        }
+        cursor++;
+        return true;
+    }
+}
+
+/**
+ * @brief Read        读取下一条消息,没有时等待
+ * @param timeoutNs   最长等待时间,小于0表示一直等待
+ * @return            是否读到(超时返回false)
+ */
+bool ShmChannel::Read(void* msg, int64_t timeoutNs, int64_t* publishedNs)
+{
+    if (TryRead(msg, publishedNs))
+    {
+        return true;
+    }
+
+    int64_t deadline = MonotonicNs() + timeoutNs;
+    while (true)
+    {
+        struct timespec  ts;
+        struct timespec* timeout = NULL;
+        if (timeoutNs >= 0)
+        {
+            int64_t left = deadline - MonotonicNs();
+            if (left <= 0)
+            {
+                return false;
+            }
+            ts.tv_sec  = left / 1000000000LL;
+            ts.tv_nsec = left % 1000000000LL;
+            timeout    = &ts;
+        }
+
+        ///先登记为等待者再检查一次,写者在两者之间发布时wake已变化,FUTEX_WAIT立即返回
+        header->waiters.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t wake = header->wake.load(std::memory_order_seq_cst);
+        bool     got  = TryRead(msg, publishedNs);
+        if (!got)
+        {
+            FutexWait(&header->wake, wake, timeout);
+        }
+        header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+        if (got || TryRead(msg, publishedNs))
+        {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief SeekLatest 跳过积压的消息,下一次读取得到当前最新的一条(即使已经读过)
+ * @note  用于重启后只关心当前状态的读者,跳过的消息不计入丢失数
+ */
+void ShmChannel::SeekLatest()
+{
+    uint64_t head = header->head.load(std::memory_order_acquire);
+    cursor        = head > 0 ? head - 1 : 0;
+}
+
+/**
+ * @brief Lost 本端被覆盖而没有读到的消息数
+ */
+uint64_t ShmChannel::Lost() const
+{
+    return lost;
+}
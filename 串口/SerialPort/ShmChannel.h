@@ -0,0 +1,118 @@
+/**
+ * @file    ShmChannel.h
+ * @brief   进程间共享内存通道:定长消息环形缓冲区 + futex唤醒
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    shm_open + mmap得到一段两个进程共享的内存:头部 + capacity个定长槽位。
+ *          单写者、多读者:写者总是写下一个槽位,不等待读者,读者进程卡住或崩溃都不影响写者;
+ *          每个读者各自保存读取位置,落后超过capacity时跳到最旧的未被覆盖的消息并计入丢失数。
+ *          每个槽位是一个seqlock(序号 + 64位原子字),读取时与写入重叠则重读,不需要锁。
+ *          读者无数据时在共享内存中的计数器上futex等待(非PRIVATE,可跨进程),写者只在有读者等待时才调用futex唤醒,
+ *          没有等待者时发布一条消息不产生系统调用。
+ *          共享内存在进程退出后仍然保留,任一端重启后重新Open即可继续收发,不需要另一端配合;
+ *          写者重启时从上次的位置继续编号,读者重启时可用SeekLatest()跳过积压的旧消息。
+ *          序号、时间戳都是64位原子量,要求平台上std::atomic<uint64_t>无锁(x86-64/aarch64满足)。
+ *          通道中是发给下位机的指令,共享内存以SHM_FILE_MODE(0600)创建,视觉进程与串口进程需以同一用户运行;
+ *          Open拒绝其他用户创建的同名共享内存,防止被预先创建并注入目标
+ * @example 视觉进程:
+ *          ShmQueue<HostComputerData> targets;
+ *          targets.Open(SHM_HOST_CHANNEL);
+ *          targets.Publish(data);
+ *          串口进程:
+ *          ShmQueue<HostComputerData> targets;
+ *          targets.Open(SHM_HOST_CHANNEL);
+ *          targets.SeekLatest();
+ *          while (targets.Read(data, 100000000))  //最多等待100ms
+ *              SendMailbox.Publish(data);
+ */
+
+#ifndef SHMCHANNEL_H
+#define SHMCHANNEL_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+#define SHM_HOST_CHANNEL     "/serial_host"     ///视觉进程->串口进程 HostComputerData
+#define SHM_CHASSIS_CHANNEL  "/serial_chassis"  ///串口进程->视觉进程 GroundChassisData
+#define SHM_DEFAULT_CAPACITY 256                ///默认槽位数(2的幂)
+#define SHM_OPEN_TIMEOUT_NS  1000000000LL       ///等待另一端完成初始化的最长时间
+#define SHM_FILE_MODE        0600               ///共享内存的权限:只有同一用户的进程可以读写
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "共享内存中的64位原子量需为无锁实现");
+
+///共享内存头部,两个进程按相同的布局访问
+typedef struct
+{
+    std::atomic<uint32_t> magic;     ///<初始化完成后写入,另一端据此判断可以使用
+    uint32_t              version;   ///<布局版本
+    uint32_t              msgSize;   ///<消息字节数
+    uint32_t              slotSize;  ///<槽位字节数(按缓存行对齐)
+    uint64_t              capacity;  ///<槽位数
+
+    alignas(64) std::atomic<uint64_t> head;  ///<下一条消息的编号(已发布的消息数)
+    std::atomic<uint32_t>             producerPid;
+
+    alignas(64) std::atomic<uint32_t> wake;  ///<每发布一条加1,读者在其上futex等待
+    std::atomic<uint32_t>             waiters;
+} ShmHeader;
+
+class ShmChannel
+{
+public:
+    ShmChannel();
+    ~ShmChannel();
+
+    bool Open(const char* name, size_t msgSize, size_t capacity = SHM_DEFAULT_CAPACITY);
+    void Close();
+    bool IsOpen() const;
+
+    void     Publish(const void* msg);
+    bool     TryRead(void* msg, int64_t* publishedNs = NULL);
+    bool     Read(void* msg, int64_t timeoutNs, int64_t* publishedNs = NULL);
+    void     SeekLatest();
+    uint64_t Lost() const;
+
+    static bool Unlink(const char* name);
+
+private:
+    std::atomic<uint64_t>* Slot(uint64_t index) const;
+
+    int            fd;
+    ShmHeader*     header;
+    unsigned char* slots;
+    size_t         mapLen;
+    size_t         words;   ///<消息占用的64位字数
+    uint64_t       mask;
+    uint64_t       cursor;  ///<本端下一条要读的消息编号
+    uint64_t       lost;    ///<被覆盖而没有读到的消息数
+};
+
+/**
+ * @brief ShmQueue 按类型收发的共享内存通道
+ * @note  T需可平凡复制,且两个进程的定义一致(Open时按sizeof(T)检查)
+ */
+template <typename T>
+class ShmQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "共享内存通道只能传递可平凡复制的类型");
+
+public:
+    bool Open(const char* name, size_t capacity = SHM_DEFAULT_CAPACITY) { return channel.Open(name, sizeof(T), capacity); }
+    void Close() { channel.Close(); }
+    bool IsOpen() const { return channel.IsOpen(); }
+
+    void Publish(const T& msg) { channel.Publish(&msg); }
+    bool TryRead(T& msg, int64_t* publishedNs = NULL) { return channel.TryRead(&msg, publishedNs); }
+    bool Read(T& msg, int64_t timeoutNs, int64_t* publishedNs = NULL) { return channel.Read(&msg, timeoutNs, publishedNs); }
+    void SeekLatest() { channel.SeekLatest(); }
+
+    uint64_t Lost() const { return channel.Lost(); }
+
+private:
+    ShmChannel channel;
+};
+
+#endif  // SHMCHANNEL_H
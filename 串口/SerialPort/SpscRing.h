@@ -0,0 +1,141 @@
+/**
+ * @file    SpscRing.h
+ * @brief   单生产者/单消费者无锁环形缓冲区
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    生产者与消费者各自只写自己的下标,另一方的下标做本地缓存,只有缓存不够用时才重新读取原子量
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+#define CACHE_LINE_SIZE 64
+
+template <typename T>
+class SpscRing
+{
+public:
+    /**
+     * @brief SpscRing 构造
+     * @param capacity 容量,向上取整到2的幂
+     */
+    explicit SpscRing(size_t capacity)
+        : buffer(RoundUp(capacity)), mask(buffer.size() - 1), head(0), tail(0), cachedHead(0), cachedTail(0)
+    {
+    }
+
+    /**
+     * @brief Push 生产者写入一批数据
+     * @param data 数据首地址
+     * @param len  数据个数
+     * @return     实际写入的个数(空间不足时只写入一部分)
+     */
+    size_t Push(const T* data, size_t len)
+    {
+        size_t t    = tail.load(std::memory_order_relaxed);
+        size_t free = buffer.size() - (t - cachedHead);
+        if (free < len)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            free       = buffer.size() - (t - cachedHead);
+        }
+
+        size_t n = len < free ? len : free;
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        size_t offset = t & mask;
+        size_t first  = n < buffer.size() - offset ? n : buffer.size() - offset;
+        memcpy(&buffer[offset], data, first * sizeof(T));
+        memcpy(&buffer[0], data + first, (n - first) * sizeof(T));
+
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * @brief Pop 消费者取出一批数据
+     * @param data 输出缓冲区
+     * @param len  最多取出的个数
+     * @return     实际取出的个数
+     */
+    size_t Pop(T* data, size_t len)
+    {
+        size_t h     = head.load(std::memory_order_relaxed);
+        size_t avail = cachedTail - h;
+        if (avail < len)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            avail      = cachedTail - h;
+        }
+
+        size_t n = len < avail ? len : avail;
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        size_t offset = h & mask;
+        size_t first  = n < buffer.size() - offset ? n : buffer.size() - offset;
+        memcpy(data, &buffer[offset], first * sizeof(T));
+        memcpy(data + first, &buffer[0], (n - first) * sizeof(T));
+
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * @brief Size 当前缓存的数据个数(仅作参考,另一端可能同时在修改)
+     */
+    size_t Size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const
+    {
+        return buffer.size();
+    }
+
+    /**
+     * @brief Storage 底层存储的首地址,与StorageBytes一起用于实时线程开始使用前预先触发缺页(PrefaultMemory)
+     */
+    void* Storage()
+    {
+        return buffer.data();
+    }
+
+    size_t StorageBytes() const
+    {
+        return buffer.size() * sizeof(T);
+    }
+
+private:
+    static size_t RoundUp(size_t n)
+    {
+        size_t cap = 1;
+        while (cap < n)
+        {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    std::vector<T> buffer;
+    const size_t   mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;  ///<消费者下标
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;  ///<生产者下标
+    alignas(CACHE_LINE_SIZE) size_t cachedHead;         ///<生产者缓存的消费者下标
+    alignas(CACHE_LINE_SIZE) size_t cachedTail;         ///<消费者缓存的生产者下标
+};
+
+#endif  // SPSCRING_H
@@ -0,0 +1,120 @@
+/**
+ * @file    Task.h
+ * @brief   C++20协程任务类型
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    Task<T>是惰性的:创建时不执行,被co_await时才开始,结束后直接切换回等待者(对称转移,不增加栈深度)。
+ *          最外层的Task交给EventLoop::Spawn运行。本模块不使用异常,协程内抛出的异常直接终止程序
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+class TaskPromiseBase
+{
+public:
+    ///结束时切换回co_await本任务的协程,没有等待者时挂起
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> self) noexcept
+        {
+            std::coroutine_handle<> next = self.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter        final_suspend() const noexcept { return {}; }
+    void                unhandled_exception() const noexcept { std::terminate(); }
+
+    std::coroutine_handle<> continuation;  ///<等待本任务结束的协程
+};
+
+template <typename T = void>
+class Task
+{
+public:
+    struct promise_type : TaskPromiseBase
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_value(T v) { value = std::move(v); }
+
+        std::optional<T> value;
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+    {
+        handle.promise().continuation = caller;
+        return handle;
+    }
+
+    T await_resume() { return std::move(*handle.promise().value); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <>
+class Task<void>
+{
+public:
+    struct promise_type : TaskPromiseBase
+    {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        void return_void() const noexcept {}
+    };
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+    {
+        handle.promise().continuation = caller;
+        return handle;
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+#endif  // TASK_H
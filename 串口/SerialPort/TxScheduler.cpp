@@ -0,0 +1,333 @@
+/**
+ * @file    TxScheduler.cpp
+ * @brief   定频发送线程:timerfd绝对时刻驱动,按固定频率发送最新的上位机数据
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "TxScheduler.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+
+TxScheduler::TxScheduler(Uart& uart, LatestValue<HostComputerData>& source)
+    : uart(uart), source(source), fd(-1), timerfd(-1), stopfd(-1), running(false), queue(TX_QUEUE_SIZE), pendingHead(0), pendingCount(0), pendingOffset(0), pendingTarget(false), pendingPublishedNs(0), hasLast(false), version(0), realTime(false), rtApplied(false)
+{
+    config.rateHz      = 1000;
+    config.repeatStale = true;
+    memset(&last, 0, sizeof(last));
+    memset(&rtConfig, 0, sizeof(rtConfig));
+    memset(&rtReport, 0, sizeof(rtReport));
+
+    ticks.store(0);
+    sent.store(0);
+    repeated.store(0);
+    coalesced.store(0);
+    missed.store(0);
+    queueOverruns.store(0);
+    shortWrites.store(0);
+}
+
+TxScheduler::~TxScheduler()
+{
+    Stop();
+}
+
+/**
+ * @brief Start  启动发送线程
+ * @param fd     打开串口的文件句柄,关闭仍由调用者负责
+ * @param config 发送频率等参数
+ * @return       是否启动成功
+ */
+bool TxScheduler::Start(int fd, const TxSchedulerConfig& config)
+{
+    if (running.load() || config.rateHz <= 0)
+    {
+        return false;
+    }
+
+    this->fd     = fd;
+    this->config = config;
+    version      = source.Version();  //启动前的发布不计入合并次数
+
+    timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    stopfd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (timerfd == -1 || stopfd == -1)
+    {
+        cout << "创建发送定时器失败" << endl;
+        Stop();
+        return false;
+    }
+
+    running.store(true);
+    rtApplied.store(false);
+    worker = std::thread(&TxScheduler::Run, this);
+
+    ///等发送线程应用完实时配置,返回后RealTime()即为实际结果
+    while (realTime && !rtApplied.load())
+    {
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Stop 停止发送线程
+ */
+void TxScheduler::Stop()
+{
+    ///发送线程每个周期都会检查running,通知写入失败时最多晚一个周期退出
+    running.store(false);
+    if (worker.joinable())
+    {
+        uint64_t one = 1;
+        if (write(stopfd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+        {
+            cout << "通知发送线程退出失败" << endl;
+        }
+        worker.join();
+    }
+
+    if (timerfd != -1)
+    {
+        close(timerfd);
+        timerfd = -1;
+    }
+    if (stopfd != -1)
+    {
+        close(stopfd);
+        stopfd = -1;
+    }
+}
+
+bool TxScheduler::IsRunning() const
+{
+    return running.load();
+}
+
+/**
+ * @brief Enqueue 加入一帧额外发送的数据(如其他V2指令),在下一个周期与目标帧一起写出
+ * @param frame   已编码的帧
+ * @param len     帧长,不超过V2_MAX_FRAME
+ * @return        是否加入成功,队列满时计入queueOverruns
+ * @note          只允许一个生产者线程调用
+ */
+bool TxScheduler::Enqueue(const unsigned char* frame, size_t len)
+{
+    if (len == 0 || len > V2_MAX_FRAME)
+    {
+        return false;
+    }
+
+    TxFrame item;
+    item.length = static_cast<uint16_t>(len);
+    memcpy(item.data, frame, len);
+
+    if (queue.Push(&item, 1) != 1)
+    {
+        queueOverruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Run 发送线程主循环
+ * @note  timerfd的周期由内核维护:处理耗时或线程被抢占不会推迟后面的到期时刻,
+ *        被推迟超过一个周期时一次read得到多次到期,多出的部分记为错过的周期
+ */
+void TxScheduler::Run()
+{
+    if (realTime)
+    {
+        ApplyRealTime(rtConfig, rtReport);
+        PrefaultMemory(pending, sizeof(pending));
+        rtApplied.store(true);
+    }
+
+    int64_t period = static_cast<int64_t>(1e9 / config.rateHz);
+    int64_t first  = MonotonicNs() + period;
+
+    struct itimerspec spec;
+    spec.it_value.tv_sec     = first / 1000000000LL;
+    spec.it_value.tv_nsec    = first % 1000000000LL;
+    spec.it_interval.tv_sec  = period / 1000000000LL;
+    spec.it_interval.tv_nsec = period % 1000000000LL;
+    timerfd_settime(timerfd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+    int64_t       deadline = first;  //下一个到期时刻
+    struct pollfd fds[2];
+    fds[0].fd     = timerfd;
+    fds[0].events = POLLIN;
+    fds[1].fd     = stopfd;
+    fds[1].events = POLLIN;
+
+    while (running.load())
+    {
+        if (poll(fds, 2, -1) == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        uint64_t expirations = 0;
+        if (read(timerfd, &expirations, sizeof(expirations)) != sizeof(expirations) || expirations == 0)
+        {
+            continue;
+        }
+
+        ///只在最近一次到期时发送一次,前面的到期已经错过
+        deadline += static_cast<int64_t>(expirations - 1) * period;
+        Tick(expirations, deadline);
+        deadline += period;
+    }
+
+    running.store(false);
+}
+
+/**
+ * @brief Tick 一个发送周期
+ * @param expirations 本次唤醒对应的到期次数
+ * @param deadline    最近一次到期的时刻
+ */
+void TxScheduler::Tick(uint64_t expirations, int64_t deadline)
+{
+    wakeLatency.Record(MonotonicNs() - deadline);
+    ticks.fetch_add(expirations, std::memory_order_relaxed);
+    if (expirations > 1)
+    {
+        missed.fetch_add(expirations - 1, std::memory_order_relaxed);
+    }
+
+    ///上个周期没写完的部分先写出,写完之前不组新帧,新发布留在邮箱中合并
+    if (pendingHead < pendingCount && !Flush())
+    {
+        shortWrites.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t before = version;
+
+    pendingHead        = 0;
+    pendingCount       = 0;
+    pendingOffset      = 0;
+    pendingTarget      = false;
+    pendingPublishedNs = 0;
+
+    if (source.ReadIfNewer(last, version, &pendingPublishedNs))
+    {
+        coalesced.fetch_add(version - before - 1, std::memory_order_relaxed);
+        hasLast       = true;
+        pendingTarget = true;
+    }
+    else if (hasLast && config.repeatStale)
+    {
+        pendingTarget = true;
+        repeated.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (pendingTarget)
+    {
+        pending[0].length = static_cast<uint16_t>(uart.EncodeTarPos(last, pending[0].data));
+        pendingCount      = 1;
+    }
+    pendingCount += queue.Pop(&pending[pendingCount], TX_BATCH_MAX);
+
+    if (pendingCount > 0 && !Flush())
+    {
+        shortWrites.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Flush 用一次writev写出pending中剩余的部分,完整写出的帧计入发送统计
+ * @return      是否全部写完
+ */
+bool TxScheduler::Flush()
+{
+    struct iovec iov[1 + TX_BATCH_MAX];
+    int          count = 0;
+
+    for (size_t i = pendingHead; i < pendingCount; i++)
+    {
+        size_t skip         = i == pendingHead ? pendingOffset : 0;
+        iov[count].iov_base = &pending[i].data[skip];
+        iov[count].iov_len  = pending[i].length - skip;
+        count++;
+    }
+
+    ssize_t written = writev(fd, iov, count);
+    size_t  done    = written > 0 ? static_cast<size_t>(written) : 0;
+
+    while (pendingHead < pendingCount)
+    {
+        size_t left = pending[pendingHead].length - pendingOffset;
+        if (done < left)
+        {
+            pendingOffset += done;
+            return false;
+        }
+
+        done -= left;
+        bool target = pendingHead == 0 && pendingTarget;
+        uart.CommitWrite(pending[pendingHead].data, pending[pendingHead].length, target ? pendingPublishedNs : 0);
+        if (target)
+        {
+            sent.fetch_add(1, std::memory_order_relaxed);
+        }
+        pendingHead++;
+        pendingOffset = 0;
+    }
+
+    return true;
+}
+
+/**
+ * @brief SetRealTime 启用发送线程的实时配置
+ * @param config      实时配置,没有权限的项会跳过,实际结果见RealTime()
+ * @note              需在Start()之前调用
+ */
+void TxScheduler::SetRealTime(const RealTimeConfig& config)
+{
+    if (!running.load())
+    {
+        realTime = true;
+        rtConfig = config;
+    }
+}
+
+/**
+ * @brief RealTime 发送线程实际得到的实时配置,Start()返回后有效
+ */
+const RealTimeReport& TxScheduler::RealTime() const
+{
+    return rtReport;
+}
+
+/**
+ * @brief Snapshot 取统计快照,可在任意线程调用
+ */
+void TxScheduler::Snapshot(TxSchedulerStats& stats) const
+{
+    stats.ticks         = ticks.load(std::memory_order_relaxed);
+    stats.sent          = sent.load(std::memory_order_relaxed);
+    stats.repeated      = repeated.load(std::memory_order_relaxed);
+    stats.coalesced     = coalesced.load(std::memory_order_relaxed);
+    stats.missed        = missed.load(std::memory_order_relaxed);
+    stats.queueOverruns = queueOverruns.load(std::memory_order_relaxed);
+    stats.shortWrites   = shortWrites.load(std::memory_order_relaxed);
+    wakeLatency.Snapshot(stats.wakeLatency);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file    TxScheduler.h
+ * @brief   定频发送线程:timerfd绝对时刻驱动,按固定频率发送最新的上位机数据
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    timerfd以TFD_TIMER_ABSTIME设置首个到期时刻并按周期重复,周期由内核保持,不随处理时间漂移。
+ *          每个周期从邮箱读一次最新的HostComputerData:两个周期之间多次发布只发送最后一次(合并),
+ *          没有新数据时按配置重发上一帧或跳过。Enqueue()加入的其他帧与目标帧在同一个周期内用一次writev写出。
+ *          内核缓冲区写不下时保留未写出的部分,下个周期先写完它再组新帧:已组好的帧不会被截断或重组,
+ *          V2序号与压缩编码的差分基准因此不会出现缺口;积压期间的新发布照常合并,之后只发送最新的一次。
+ *          统计:错过的周期数(timerfd到期次数大于1)、唤醒延迟、合并次数、队列溢出与内核缓冲区写不下的次数。
+ *          启动后由本线程独占串口的发送端,不要再调用Uart::TransformTarPos。
+ *          SetRealTime()可让发送线程绑定核心/SCHED_FIFO/锁定内存以减小唤醒抖动(spinNs对发送线程无效)
+ * @example TxScheduler scheduler(InfoPort, SendMailbox);
+ *          TxSchedulerConfig config = {1000, true};
+ *          scheduler.Start(fd_serial0, config);
+ */
+
+#ifndef TXSCHEDULER_H
+#define TXSCHEDULER_H
+
+#include "RealTime.h"
+#include "SerialPort.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <thread>
+
+#define TX_QUEUE_SIZE 64  ///额外发送帧队列长度
+#define TX_BATCH_MAX  8   ///每个周期最多写出的额外帧数
+
+typedef struct
+{
+    double rateHz;       ///<发送频率
+    bool   repeatStale;  ///<没有新数据时是否重发上一帧(保持下位机看到的指令间隔恒定)
+} TxSchedulerConfig;
+
+typedef struct
+{
+    uint16_t      length;
+    unsigned char data[V2_MAX_FRAME];
+} TxFrame;
+
+typedef struct
+{
+    uint64_t        ticks;          ///<已处理的周期数
+    uint64_t        sent;           ///<发送的目标帧数
+    uint64_t        repeated;       ///<其中重发上一帧的次数
+    uint64_t        coalesced;      ///<被更新的数据覆盖、没有发出的发布次数
+    uint64_t        missed;         ///<错过的周期数
+    uint64_t        queueOverruns;  ///<Enqueue时队列已满的次数
+    uint64_t        shortWrites;    ///<内核发送缓冲区写不下(EAGAIN或只写入一部分),剩余部分推迟到下个周期的次数
+    LatencySnapshot wakeLatency;    ///<到期时刻->线程开始发送的延迟
+} TxSchedulerStats;
+
+class TxScheduler
+{
+public:
+    TxScheduler(Uart& uart, LatestValue<HostComputerData>& source);
+    ~TxScheduler();
+
+    bool Start(int fd, const TxSchedulerConfig& config);
+    void Stop();
+    bool IsRunning() const;
+    bool Enqueue(const unsigned char* frame, size_t len);
+    void Snapshot(TxSchedulerStats& stats) const;
+    void SetRealTime(const RealTimeConfig& config);
+
+    const RealTimeReport& RealTime() const;
+
+private:
+    void Run();
+    void Tick(uint64_t expirations, int64_t deadline);
+    bool Flush();
+
+    Uart&                          uart;
+    LatestValue<HostComputerData>& source;
+    TxSchedulerConfig              config;
+    int                            fd;
+    int                            timerfd;
+    int                            stopfd;
+    std::thread                    worker;
+    std::atomic<bool>              running;
+
+    SpscRing<TxFrame> queue;                      ///<额外发送的帧,单生产者
+    TxFrame           pending[1 + TX_BATCH_MAX];  ///<本周期要写出的帧:目标帧(如有)在前,额外帧在后
+    size_t            pendingHead;                ///<第一个未写完的帧
+    size_t            pendingCount;               ///<帧数,pendingHead == pendingCount时全部写完
+    size_t            pendingOffset;              ///<pending[pendingHead]已写出的字节数
+    bool              pendingTarget;              ///<pending[0]是否为目标帧
+    int64_t           pendingPublishedNs;         ///<目标帧的发布时刻
+
+    HostComputerData last;     ///<上一次发送的数据
+    bool             hasLast;
+    uint64_t         version;  ///<上一次读到的邮箱版本号
+
+    std::atomic<uint64_t> ticks;
+    std::atomic<uint64_t> sent;
+    std::atomic<uint64_t> repeated;
+    std::atomic<uint64_t> coalesced;
+    std::atomic<uint64_t> missed;
+    std::atomic<uint64_t> queueOverruns;
+    std::atomic<uint64_t> shortWrites;
+    LatencyHistogram      wakeLatency;
+
+    bool              realTime;   ///<是否启用实时配置
+    RealTimeConfig    rtConfig;
+    RealTimeReport    rtReport;   ///<发送线程实际得到的实时配置
+    std::atomic<bool> rtApplied;  ///<发送线程是否已应用实时配置
+};
+
+#endif  // TXSCHEDULER_H
@@ -0,0 +1,412 @@
+/**
+ * @file    UartReceiver.cpp
+ * @brief   串口事件驱动接收线程
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "UartReceiver.h"
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+UartReceiver::UartReceiver(size_t capacity)
+    : fd(-1), epfd(-1), stopfd(-1), readyfd(-1), running(false), ready(false), ring(capacity), stamps(RX_STAMP_SIZE), dropped(0), recorder(NULL), realTime(false),
+      rtApplied(false)
+{
+    parser.SetStats(&stats);
+    memset(&rtConfig, 0, sizeof(rtConfig));
+    memset(&rtReport, 0, sizeof(rtReport));
+
+    ///readyfd在对象的整个生命周期内有效,Stop时可能仍有消费者阻塞在Wait中
+    readyfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+UartReceiver::~UartReceiver()
+{
+    Stop();
+
+    if (readyfd != -1)
+    {
+        close(readyfd);
+    }
+}
+
+/**
+ * @brief Start 接管串口读端并启动接收线程
+ * @param fd    打开串口的文件句柄(需为非阻塞模式,InitSerial默认如此)
+ * @return      是否启动成功
+ * @note        启动后不要再对该fd调用Uart::GetMode,fd的关闭仍由调用者负责
+ */
+bool UartReceiver::Start(int fd)
+{
+    if (running.load())
+    {
+        return false;
+    }
+
+    this->fd = fd;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    epfd   = epoll_create1(EPOLL_CLOEXEC);
+    stopfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epfd == -1 || stopfd == -1 || readyfd == -1)
+    {
+        cout << "创建epoll失败" << endl;
+        Stop();
+        return false;
+    }
+
+    struct epoll_event ev;
+    ev.events  = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        cout << "串口加入epoll失败" << endl;
+        Stop();
+        return false;
+    }
+
+    ev.events  = EPOLLIN;
+    ev.data.fd = stopfd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, stopfd, &ev);
+
+    ///清除上次运行留下的通知
+    uint64_t count = 0;
+    while (read(readyfd, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count)))
+    {
+    }
+    ready.store(false);
+
+    running.store(true);
+    rtApplied.store(false);
+    worker = std::thread(&UartReceiver::Run, this);
+
+    ///等接收线程应用完实时配置,返回后RealTime()即为实际结果
+    while (realTime && !rtApplied.load())
+    {
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Stop 停止接收线程
+ */
+void UartReceiver::Stop()
+{
+    if (worker.joinable())
+    {
+        uint64_t one = 1;
+        if (write(stopfd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+        {
+            ///stopfd是非阻塞eventfd,只有计数溢出时才会失败,此时接收线程已被唤醒
+            cout << "通知接收线程退出失败" << endl;
+        }
+        worker.join();
+    }
+    running.store(false);
+
+    if (epfd != -1)
+    {
+        close(epfd);
+        epfd = -1;
+    }
+    if (stopfd != -1)
+    {
+        close(stopfd);
+        stopfd = -1;
+    }
+}
+
+bool UartReceiver::IsRunning() const
+{
+    return running.load();
+}
+
+/**
+ * @brief Run 接收线程主循环
+ * @note  阻塞在epoll_wait上,串口可读时读到EAGAIN为止,保证内核缓冲区不会堆积。
+ *        启用忙轮询时,每次读到数据后的spinNs内用超时为0的epoll_wait轮询,之后再阻塞
+ */
+void UartReceiver::Run()
+{
+    if (realTime)
+    {
+        ApplyRealTime(rtConfig, rtReport);
+        ///消费者只读取已发布的部分,此时环形缓冲区为空,由生产者逐页写一遍不会与其冲突
+        PrefaultMemory(ring.Storage(), ring.StorageBytes());
+        PrefaultMemory(stamps.Storage(), stamps.StorageBytes());
+        rtApplied.store(true);
+    }
+
+    unsigned char      chunk[RX_CHUNK_SIZE];
+    struct epoll_event events[2];
+    RxStamp            stamp     = {0, 0};  //时间戳入队失败时字节数累加到下一个时间戳
+    int64_t            spinNs    = realTime ? rtConfig.spinNs : 0;
+    int64_t            spinUntil = spinNs < 0 ? INT64_MAX : 0;  //忙轮询截止时刻
+
+    while (true)
+    {
+        int timeout = spinNs != 0 && MonotonicNs() < spinUntil ? 0 : -1;
+        int n       = epoll_wait(epfd, events, 2, timeout);
+        if (n == 0)
+        {
+            continue;
+        }
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        bool stop = false;
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.fd == stopfd)
+            {
+                stop = true;
+                continue;
+            }
+
+            int64_t readNs = MonotonicNs();
+            if (spinNs > 0)
+            {
+                spinUntil = readNs + spinNs;
+            }
+
+            while (true)
+            {
+                ssize_t bytes = read(fd, chunk, sizeof(chunk));
+                if (bytes > 0)
+                {
+                    if (recorder != NULL)
+                    {
+                        recorder->Append(CAPTURE_RX, chunk, static_cast<size_t>(bytes));
+                    }
+
+                    size_t pushed = ring.Push(chunk, static_cast<size_t>(bytes));
+                    if (pushed < static_cast<size_t>(bytes))
+                    {
+                        dropped.fetch_add(static_cast<size_t>(bytes) - pushed, std::memory_order_relaxed);
+                    }
+                    stamp.bytes += pushed;
+                    stats.AddRead(static_cast<uint64_t>(bytes));
+                    continue;
+                }
+                if (bytes == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+
+            if (stamp.bytes > 0)
+            {
+                stamp.readNs = readNs;
+                if (stamps.Push(&stamp, 1) == 1)
+                {
+                    stamp.bytes = 0;
+                    Notify();
+                }
+            }
+
+            ///串口被拔出或对端关闭
+            if (events[i].events & (EPOLLHUP | EPOLLERR))
+            {
+                cout << "串口连接断开" << endl;
+                stop = true;
+            }
+        }
+
+        if (stop)
+        {
+            break;
+        }
+    }
+
+    ///唤醒阻塞在Wait中的消费者,使其看到接收线程已退出
+    running.store(false);
+    Notify();
+}
+
+/**
+ * @brief Notify 通知消费者有新数据
+ * @note  消费者清除ready之前只写一次readyfd,消费者不调用Wait时每次运行最多一次系统调用
+ */
+void UartReceiver::Notify()
+{
+    if (!ready.exchange(true, std::memory_order_seq_cst))
+    {
+        uint64_t one = 1;
+        if (write(readyfd, &one, sizeof(one)) != static_cast<ssize_t>(sizeof(one)))
+        {
+            ready.store(false, std::memory_order_seq_cst);  //写入失败时下次再通知
+        }
+    }
+}
+
+/**
+ * @brief SetRecorder 设置录制器,接收线程读到的每段原始数据都追加到录制文件
+ * @param recorder    已打开的录制器,NULL表示不录制
+ * @note              需在Start()之前调用
+ */
+void UartReceiver::SetRecorder(CaptureWriter* recorder)
+{
+    if (!running.load())
+    {
+        this->recorder = recorder;
+    }
+}
+
+/**
+ * @brief SetRealTime 启用接收线程的实时配置
+ * @param config      实时配置,没有权限的项会跳过,实际结果见RealTime()
+ * @note              需在Start()之前调用
+ */
+void UartReceiver::SetRealTime(const RealTimeConfig& config)
+{
+    if (!running.load())
+    {
+        realTime = true;
+        rtConfig = config;
+    }
+}
+
+/**
+ * @brief RealTime 接收线程实际得到的实时配置,Start()返回后有效
+ */
+const RealTimeReport& UartReceiver::RealTime() const
+{
+    return rtReport;
+}
+
+/**
+ * @brief Read 取出接收到的原始字节
+ * @param buf  输出缓冲区
+ * @param len  最多取出的字节数
+ * @return     实际取出的字节数
+ * @note       仅允许一个消费者线程调用,与GetMode二选一使用(此方式不统计读取->解析延迟)
+ */
+size_t UartReceiver::Read(unsigned char* buf, size_t len)
+{
+    return ring.Pop(buf, len);
+}
+
+/**
+ * @brief Wait      等待接收线程读到新数据
+ * @param timeoutNs 最长等待时间,小于0表示一直等待
+ * @return          有未解析的数据时返回true;超时或接收线程已退出时返回false
+ * @note            仅允许消费者线程调用,返回true后调用GetMode解析;数据可能只是半帧,此时GetMode返回false
+ */
+bool UartReceiver::Wait(int64_t timeoutNs)
+{
+    int64_t deadline = MonotonicNs() + timeoutNs;
+
+    while (true)
+    {
+        if (stamps.Size() > 0)
+        {
+            return true;
+        }
+        if (!running.load())
+        {
+            return false;
+        }
+
+        struct timespec  ts;
+        struct timespec* timeout = NULL;
+        if (timeoutNs >= 0)
+        {
+            int64_t left = deadline - MonotonicNs();
+            if (left <= 0)
+            {
+                return false;
+            }
+            ts.tv_sec  = left / 1000000000LL;
+            ts.tv_nsec = left % 1000000000LL;
+            timeout    = &ts;
+        }
+
+        struct pollfd pfd;
+        pfd.fd     = readyfd;
+        pfd.events = POLLIN;
+        if (ppoll(&pfd, 1, timeout, NULL) > 0)
+        {
+            uint64_t count = 0;
+            if (read(readyfd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count)))
+            {
+                continue;
+            }
+
+            ///先清标志再检查:清除之后写入的数据会重新写readyfd
+            ready.store(false, std::memory_order_seq_cst);
+        }
+    }
+}
+
+/**
+ * @brief GetMode 解析已接收的数据,得到最新的一帧
+ * @param data    接收的数据
+ * @param rxNs    可选,输出该帧被接收线程读到的时刻(MonotonicNs),用于计算数据的年龄
+ * @return        是否解析到新的数据帧
+ * @note          需要逐帧处理时通过Parser().SetCallback()设置回调,回调中可用Parser().RxTime()取读取时刻
+ */
+bool UartReceiver::GetMode(GroundChassisData& data, int64_t* rxNs)
+{
+    unsigned char chunk[RX_CHUNK_SIZE];
+    RxStamp       stamp;
+
+    while (stamps.Pop(&stamp, 1) == 1)
+    {
+        size_t frames = 0;
+        parser.SetRxTime(stamp.readNs);
+        while (stamp.bytes > 0)
+        {
+            size_t n = ring.Pop(chunk, stamp.bytes < sizeof(chunk) ? stamp.bytes : sizeof(chunk));
+            if (n == 0)
+            {
+                break;
+            }
+            frames += parser.Feed(chunk, n);
+            stamp.bytes -= n;
+        }
+
+        if (frames > 0)
+        {
+            stats.rxLatency.Record(MonotonicNs() - stamp.readNs, frames);
+        }
+    }
+
+    return parser.TakeLatest(data, rxNs);
+}
+
+/**
+ * @brief Dropped 环形缓冲区溢出丢弃的字节数
+ */
+size_t UartReceiver::Dropped() const
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Parser 消费者侧解析器,用于设置逐帧回调与读取解析统计
+ */
+FrameParser& UartReceiver::Parser()
+{
+    return parser;
+}
+
+/**
+ * @brief Stats 接收统计,可在任意线程取快照
+ */
+UartStats& UartReceiver::Stats()
+{
+    return stats;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file    UartReceiver.h
+ * @brief   串口事件驱动接收线程
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    接收线程阻塞在epoll上,串口有数据时一次性读空内核缓冲区并写入SPSC环形缓冲区;
+ *          消费者从环形缓冲区取数据解析,不产生任何系统调用;
+ *          需要阻塞等待时调用Wait(),接收线程写入新数据后经eventfd唤醒消费者(消费者未等待时不产生额外的系统调用)。
+ *          SetRealTime()启用实时配置后,接收线程绑定核心/SCHED_FIFO/锁定内存,
+ *          并可在读到数据后先忙轮询一段时间(epoll_wait超时为0)再阻塞,省去调度器唤醒的延迟
+ */
+
+#ifndef UARTRECEIVER_H
+#define UARTRECEIVER_H
+
+#include "RealTime.h"
+#include "SerialPort.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <thread>
+
+#define RX_RING_SIZE  65536  ///接收环形缓冲区大小
+#define RX_CHUNK_SIZE 4096   ///单次read的最大字节数
+#define RX_STAMP_SIZE 4096   ///读取时间戳环形缓冲区大小
+
+///一次唤醒读到的字节数与读取时刻,用于统计读取->解析延迟
+typedef struct
+{
+    size_t  bytes;
+    int64_t readNs;
+} RxStamp;
+
+class UartReceiver
+{
+public:
+    explicit UartReceiver(size_t capacity = RX_RING_SIZE);
+    ~UartReceiver();
+
+    bool   Start(int fd);
+    void   Stop();
+    bool   IsRunning() const;
+    size_t Read(unsigned char* buf, size_t len);
+    bool   Wait(int64_t timeoutNs);
+    bool   GetMode(GroundChassisData& data, int64_t* rxNs = NULL);
+    size_t Dropped() const;
+    void   SetRecorder(CaptureWriter* recorder);
+    void   SetRealTime(const RealTimeConfig& config);
+
+    const RealTimeReport& RealTime() const;
+
+    FrameParser& Parser();
+    UartStats&   Stats();
+
+private:
+    void Run();
+    void Notify();
+
+    int               fd;
+    int               epfd;     ///<epoll句柄
+    int               stopfd;   ///<用于唤醒并结束接收线程的eventfd
+    int               readyfd;  ///<接收线程写入新数据后唤醒消费者的eventfd
+    std::thread       worker;
+    std::atomic<bool> running;
+    std::atomic<bool> ready;  ///<已写过readyfd且消费者尚未清除,避免每次读取都产生系统调用
+
+    SpscRing<unsigned char> ring;
+    SpscRing<RxStamp>       stamps;   ///<与ring中的字节一一对应的读取时间戳
+    std::atomic<size_t>     dropped;  ///<环形缓冲区满时丢弃的字节数
+
+    FrameParser    parser;    ///<消费者侧解析器
+    UartStats      stats;     ///<收发统计
+    CaptureWriter* recorder;  ///<非NULL时在接收线程中录制读到的原始数据
+
+    bool              realTime;   ///<是否启用实时配置
+    RealTimeConfig    rtConfig;
+    RealTimeReport    rtReport;   ///<接收线程实际得到的实时配置
+    std::atomic<bool> rtApplied;  ///<接收线程是否已应用实时配置
+};
+
+#endif  // UARTRECEIVER_H
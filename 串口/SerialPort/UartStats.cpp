@@ -0,0 +1,177 @@
+/**
+ * @file    UartStats.cpp
+ * @brief   串口热路径统计:原子计数器与延迟直方图
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ */
+
+#include "UartStats.h"
+
+/**
+ * @brief Percentile 分位数
+ * @param p          0~1,如0.99
+ * @return           延迟(ns),为所在桶的中值
+ */
+double LatencySnapshot::Percentile(double p) const
+{
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total) + 0.5);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            return static_cast<double>(LatencyHistogram::BucketValue(i));
+        }
+    }
+
+    return static_cast<double>(LatencyHistogram::BucketValue(LATENCY_BUCKETS - 1));
+}
+
+double LatencySnapshot::Mean() const
+{
+    return total == 0 ? 0 : static_cast<double>(sum) / static_cast<double>(total);
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    Reset();
+}
+
+/**
+ * @brief BucketOf 延迟对应的桶
+ */
+int LatencyHistogram::BucketOf(uint64_t ns)
+{
+    if (ns < LATENCY_LINEAR)
+    {
+        return static_cast<int>(ns);
+    }
+
+    int msb    = 63 - __builtin_clzll(ns);
+    int bucket = LATENCY_LINEAR + (msb - LATENCY_SUB_BITS - 1) * (1 << LATENCY_SUB_BITS) + static_cast<int>((ns >> (msb - LATENCY_SUB_BITS)) & ((1 << LATENCY_SUB_BITS) - 1));
+
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+/**
+ * @brief BucketValue 桶的代表值(区间中值)
+ */
+int64_t LatencyHistogram::BucketValue(int bucket)
+{
+    if (bucket < LATENCY_LINEAR)
+    {
+        return bucket;
+    }
+
+    int     group = (bucket - LATENCY_LINEAR) >> LATENCY_SUB_BITS;
+    int     sub   = (bucket - LATENCY_LINEAR) & ((1 << LATENCY_SUB_BITS) - 1);
+    int     shift = group + 1;
+    int64_t lower = static_cast<int64_t>((1 << LATENCY_SUB_BITS) + sub) << shift;
+
+    return lower + (static_cast<int64_t>(1) << shift) / 2;
+}
+
+/**
+ * @brief Record 记录一次(或count次相同的)延迟
+ * @param ns     延迟(ns),负数按0处理
+ */
+void LatencyHistogram::Record(int64_t ns, uint64_t count)
+{
+    uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+
+    counts[BucketOf(v)].fetch_add(count, std::memory_order_relaxed);
+    total.fetch_add(count, std::memory_order_relaxed);
+    sum.fetch_add(v * count, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Snapshot(LatencySnapshot& snap) const
+{
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        snap.counts[i] = counts[i].load(std::memory_order_relaxed);
+    }
+    snap.total = total.load(std::memory_order_relaxed);
+    snap.sum   = sum.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Reset()
+{
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+}
+
+UartStats::UartStats()
+{
+    Reset();
+}
+
+void UartStats::AddRead(uint64_t bytes)
+{
+    bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief AddParsed 累加一次解析的结果(由FrameParser在每次Feed结束时调用)
+ */
+void UartStats::AddParsed(uint64_t frames, uint64_t crcFailures, uint64_t resyncs, uint64_t discarded, uint64_t lost)
+{
+    framesDecoded.fetch_add(frames, std::memory_order_relaxed);
+    this->crcFailures.fetch_add(crcFailures, std::memory_order_relaxed);
+    this->resyncs.fetch_add(resyncs, std::memory_order_relaxed);
+    bytesDiscarded.fetch_add(discarded, std::memory_order_relaxed);
+    framesLost.fetch_add(lost, std::memory_order_relaxed);
+}
+
+void UartStats::AddWrite(uint64_t bytes)
+{
+    txFrames.fetch_add(1, std::memory_order_relaxed);
+    txBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Snapshot 取快照
+ * @note  各计数器分别读取,快照不是严格的同一时刻,但每个值本身是准确的
+ */
+void UartStats::Snapshot(UartStatsSnapshot& snap) const
+{
+    snap.bytesRead      = bytesRead.load(std::memory_order_relaxed);
+    snap.framesDecoded  = framesDecoded.load(std::memory_order_relaxed);
+    snap.crcFailures    = crcFailures.load(std::memory_order_relaxed);
+    snap.resyncs        = resyncs.load(std::memory_order_relaxed);
+    snap.bytesDiscarded = bytesDiscarded.load(std::memory_order_relaxed);
+    snap.framesLost     = framesLost.load(std::memory_order_relaxed);
+    snap.txFrames       = txFrames.load(std::memory_order_relaxed);
+    snap.txBytes        = txBytes.load(std::memory_order_relaxed);
+    rxLatency.Snapshot(snap.rxLatency);
+    txLatency.Snapshot(snap.txLatency);
+}
+
+void UartStats::Reset()
+{
+    bytesRead.store(0, std::memory_order_relaxed);
+    framesDecoded.store(0, std::memory_order_relaxed);
+    crcFailures.store(0, std::memory_order_relaxed);
+    resyncs.store(0, std::memory_order_relaxed);
+    bytesDiscarded.store(0, std::memory_order_relaxed);
+    framesLost.store(0, std::memory_order_relaxed);
+    txFrames.store(0, std::memory_order_relaxed);
+    txBytes.store(0, std::memory_order_relaxed);
+    rxLatency.Reset();
+    txLatency.Reset();
+}
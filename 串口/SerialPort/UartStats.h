@@ -0,0 +1,91 @@
+/**
+ * @file    UartStats.h
+ * @brief   串口热路径统计:原子计数器与延迟直方图
+ * @author  xiadengma
+ * @date    2026.10.16
+ * @version 1.0.0.0
+ * @note    热路径上只有relaxed原子加法,任意线程可随时调用Snapshot()取快照,不加锁。
+ *          延迟直方图为对数-线性分桶(同HDR Histogram思路):每个2的幂区间再分8个子桶,相对误差不超过12.5%
+ */
+
+#ifndef UARTSTATS_H
+#define UARTSTATS_H
+
+#include "Clock.h"
+
+#include <atomic>
+#include <stdint.h>
+
+#define LATENCY_SUB_BITS 3                                                 ///每个2的幂区间的子桶数 = 2^LATENCY_SUB_BITS
+#define LATENCY_LINEAR   (2 << LATENCY_SUB_BITS)                           ///小于该值的延迟逐一计数
+#define LATENCY_BUCKETS  (LATENCY_LINEAR + 44 * (1 << LATENCY_SUB_BITS))  ///最大可记录约2^48ns
+
+typedef struct
+{
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total;  ///<样本数
+    uint64_t sum;    ///<样本和(ns)
+
+    double Percentile(double p) const;
+    double Mean() const;
+} LatencySnapshot;
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void Record(int64_t ns, uint64_t count = 1);
+    void Snapshot(LatencySnapshot& snap) const;
+    void Reset();
+
+    static int     BucketOf(uint64_t ns);
+    static int64_t BucketValue(int bucket);
+
+private:
+    std::atomic<uint64_t> counts[LATENCY_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+};
+
+typedef struct
+{
+    uint64_t        bytesRead;       ///<读取的字节数
+    uint64_t        framesDecoded;   ///<解析出的有效帧数
+    uint64_t        crcFailures;     ///<CRC校验失败次数
+    uint64_t        resyncs;         ///<重新同步次数
+    uint64_t        bytesDiscarded;  ///<丢弃的字节数
+    uint64_t        framesLost;      ///<按V2序号推算的链路丢帧数
+    uint64_t        txFrames;        ///<发送帧数
+    uint64_t        txBytes;         ///<发送字节数
+    LatencySnapshot rxLatency;       ///<读取->解析出帧的延迟
+    LatencySnapshot txLatency;       ///<发布->写入串口的延迟
+} UartStatsSnapshot;
+
+class UartStats
+{
+public:
+    UartStats();
+
+    void AddRead(uint64_t bytes);
+    void AddParsed(uint64_t frames, uint64_t crcFailures, uint64_t resyncs, uint64_t discarded, uint64_t lost = 0);
+    void AddWrite(uint64_t bytes);
+
+    void Snapshot(UartStatsSnapshot& snap) const;
+    void Reset();
+
+    LatencyHistogram rxLatency;
+    LatencyHistogram txLatency;
+
+private:
+    std::atomic<uint64_t> bytesRead;
+    std::atomic<uint64_t> framesDecoded;
+    std::atomic<uint64_t> crcFailures;
+    std::atomic<uint64_t> resyncs;
+    std::atomic<uint64_t> bytesDiscarded;
+    std::atomic<uint64_t> framesLost;
+    std::atomic<uint64_t> txFrames;
+    std::atomic<uint64_t> txBytes;
+};
+
+#endif  // UARTSTATS_H
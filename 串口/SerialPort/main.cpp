@@ -1,42 +1,138 @@
+#include "SerialBridge.h"
 #include "SerialPort.h"
+#include "ShmChannel.h"
+#include "TxScheduler.h"
+#include "UartReceiver.h"
 #include <opencv4/opencv2/opencv.hpp>
+#include <thread>
 
 using namespace std;
 using namespace cv;
 
+#define SERIAL_LOOP_PERIOD_US 1000       ///串口未打开时主循环的休眠时间
+#define SERIAL_RX_WAIT_NS     100000000  ///主循环等待接收线程新数据的最长时间
+#define SERIAL_TX_RATE_HZ     1000       ///向下位机发送的固定频率
+#define SERIAL_REALTIME       0          ///1:收发线程使用实时配置(各占一个核心,换取最小的抖动)
+#define SERIAL_RX_CPU         2          ///实时配置下接收线程绑定的核心
+#define SERIAL_TX_CPU         3          ///实时配置下发送线程绑定的核心
+#define SERIAL_RX_SPIN_NS     200000     ///实时配置下接收线程阻塞前忙轮询的时间(ns)
+#define SERIAL_CLOCK_SYNC     0          ///1:测量往返延迟并估计与下位机的时钟偏差(需下位机使用V2协议并回复V2_MSG_PING)
+#define SERIAL_BRIDGE         0          ///1:把下位机数据逐帧转发给本地订阅者(日志、可视化等)
+#define SERIAL_SHM_IPC        0          ///1:视觉程序作为独立进程运行,通过共享内存交换数据
+#define SERIAL_SHM_WAIT_NS    100000000  ///共享内存桥接线程单次等待的最长时间
+
 Uart InfoPort;          ///<串口
 int  fd_serial0   = 0;  ///<串口设备
 bool serial_state = 0;  ///<串口传输状态量
 
-///信号量名称
-sem_t emptysend;
-sem_t senddata;
-sem_t emptyimage;
-sem_t image;
+ClockSync         SerialClock;       ///<上下位机时钟同步,视觉线程可取估计值做延迟补偿
+MessageDispatcher SerialDispatcher;  ///<V2消息分发
+
+///视觉线程与串口线程之间的数据交换:各自按自己的节奏运行,互不阻塞
+LatestValue<HostComputerData>  SendMailbox;     ///<传输给下位机的数据
+LatestValue<GroundChassisData> ReceiveMailbox;  ///<接受下位机的数据
+
+///视觉程序为独立进程时的数据交换:视觉进程崩溃或重启不影响串口收发
+ShmQueue<HostComputerData>  HostChannel;     ///<视觉进程->串口进程
+ShmQueue<GroundChassisData> ChassisChannel;  ///<串口进程->视觉进程
+
+/**
+ * @brief ShmBridge 把视觉进程发布的最新目标转交给发送线程
+ * @note  打开时跳过积压的旧目标;视觉进程未运行时按超时空转
+ */
+static void ShmBridge()
+{
+    HostComputerData data;
+    HostChannel.SeekLatest();
 
-HostComputerData  SendData;     ///<传输给下位机的数据
-GroundChassisData ReceiveData;  ///<接受下位机的数据
+    while (1)
+    {
+        if (HostChannel.Read(data, SERIAL_SHM_WAIT_NS))
+        {
+            SendMailbox.Publish(data);
+        }
+    }
+}
 
 int main()
 {
     serial_state = InfoPort.InitSerial(fd_serial0) + 1;  //初始化串口
 
-    while (1)
+    UartReceiver receiver;
+    SerialBridge bridge;
+    TxScheduler  scheduler(InfoPort, SendMailbox);  //定频发送SendMailbox中最新的目标
+    if (serial_state)
     {
-        //        if (1)  //调试使用
-        if (serial_state)
+        TxSchedulerConfig txConfig = {SERIAL_TX_RATE_HZ, true};
+        if (SERIAL_REALTIME)
+        {
+            RealTimeConfig rxRealTime = {SERIAL_RX_CPU, RT_DEFAULT_PRIORITY, true, SERIAL_RX_SPIN_NS};
+            RealTimeConfig txRealTime = {SERIAL_TX_CPU, RT_DEFAULT_PRIORITY, true, 0};
+            receiver.SetRealTime(rxRealTime);
+            scheduler.SetRealTime(txRealTime);
+        }
+
+        if (SERIAL_CLOCK_SYNC)
         {
-            ///数据传输信号量 等待处理完毕 开始传输
-            sem_wait(&senddata);
+            InfoPort.SetProtocol(PROTOCOL_V2);
+            receiver.Parser().SetProtocol(PROTOCOL_V2);
+            SerialDispatcher.Register(V2_MSG_PONG, ClockSync::OnPong, &SerialClock);
+            receiver.Parser().SetDispatcher(&SerialDispatcher);
+            SerialClock.SetParser(&receiver.Parser());  //以回复被接收线程读到的时刻为t4
+            InfoPort.SetClockSync(&SerialClock);         //发送线程随目标帧定期附带请求
+        }
 
-            ///串口接收数据
-            InfoPort.GetMode(fd_serial0, ReceiveData);
+        if (SERIAL_BRIDGE && bridge.Start())
+        {
+            receiver.Parser().SetCallback(SerialBridge::OnFrame, &bridge);  //在解析线程中入队,不等待订阅者
+        }
 
-            ///传输数据给下位机
-            InfoPort.TransformTarPos(fd_serial0, SendData);
+        receiver.Start(fd_serial0);
+        scheduler.Start(fd_serial0, txConfig);
 
-            ///数据传输信号量 传输完毕
-            sem_post(&emptysend);
+        if (SERIAL_REALTIME)
+        {
+            PrintRealTimeReport("串口接收线程", receiver.RealTime());
+            PrintRealTimeReport("串口发送线程", scheduler.RealTime());
+        }
+    }
+
+    if (SERIAL_SHM_IPC)
+    {
+        if (HostChannel.Open(SHM_HOST_CHANNEL) && ChassisChannel.Open(SHM_CHASSIS_CHANNEL))
+        {
+            std::thread(ShmBridge).detach();
+        }
+        else
+        {
+            cout << "共享内存通道打开失败,视觉进程的数据将无法送达" << endl;
+        }
+    }
+
+    GroundChassisData receiveData;
+
+    while (1)
+    {
+        //        if (1)  //调试使用
+        if (serial_state)
+        {
+            ///阻塞到接收线程读到新数据,解析出的新帧立即发布给视觉线程
+            if (receiver.Wait(SERIAL_RX_WAIT_NS) && receiver.GetMode(receiveData))
+            {
+                ReceiveMailbox.Publish(receiveData);
+                if (ChassisChannel.IsOpen())
+                {
+                    ChassisChannel.Publish(receiveData);
+                }
+            }
+            else if (!receiver.IsRunning())
+            {
+                usleep(SERIAL_LOOP_PERIOD_US);  //接收线程已退出(串口断开),避免空转
+            }
+        }
+        else
+        {
+            usleep(SERIAL_LOOP_PERIOD_US);
         }
     }
 
@@ -0,0 +1,10 @@
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += ../ImageTools
+
+SOURCES += \
+        ../ImageTools/ImageKernels.cpp \
+        main.cpp
@@ -0,0 +1,226 @@
+/**
+ * ImageTool逐像素循环的微基准:每个函数的标量版本与本机支持的各SIMD版本对比
+ * 用法: ImageBench [rows=2160] [cols=3840] [repeat=20]
+ * 数据为4K单通道灰度/聚类标签/浮点与BGR图像,BGR的Mat端带行尾填充(模拟ROI);Sobel测竖直与水平两部分合计(不含并行);
+ * 每项先校验与标量版本逐位一致,再取repeat次中最快的一次,打印耗时(ms)与相对标量的加速比
+ */
+
+#include "ImageKernels.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+#define BENCH_CLUSTERS 4   ///KMeans默认的聚类数
+#define BENCH_ROW_PAD  64  ///BGR图像每行的填充字节
+
+typedef struct
+{
+    size_t rows;
+    size_t cols;
+    int    repeat;
+
+    vector<unsigned char> gray;
+    vector<int>           labels;
+    vector<unsigned char> lut;
+    vector<float>         samples;
+    vector<unsigned char> bgr;   ///<连续的BGR缓冲区
+    size_t                step;  ///<带填充的Mat行步长
+} BenchData;
+
+static double NowMs()
+{
+    return chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename Fn>
+static double BestOf(int repeat, Fn fn)
+{
+    double best = 1e30;
+    for (int r = 0; r < repeat; ++r)
+    {
+        double start = NowMs();
+        fn();
+        double elapsed = NowMs() - start;
+        if (elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+static void Report(const char* name, const ImageKernels& k, double ms, double scalarMs, bool same)
+{
+    cout << left << setw(12) << name << setw(8) << k.name << right << fixed << setprecision(3) << setw(10) << ms << " ms" << setprecision(2) << setw(8)
+         << scalarMs / ms << "x" << (same ? "" : "  结果不一致!") << endl;
+}
+
+static bool Bench(const BenchData& d, const ImageKernels& k, const ImageKernels& scalar)
+{
+    size_t n  = d.rows * d.cols;
+    bool   ok = true;
+
+    ///FillImageByOneGray
+    {
+        vector<unsigned char> ref(n), out(n);
+        unsigned char         gray = 97;
+        scalar.fillEqual(d.gray.data(), ref.data(), n, gray);
+        double scalarMs = BestOf(d.repeat, [&] { scalar.fillEqual(d.gray.data(), ref.data(), n, gray); });
+        double ms       = BestOf(d.repeat, [&] { k.fillEqual(d.gray.data(), out.data(), n, gray); });
+        bool   same     = memcmp(ref.data(), out.data(), n) == 0;
+        Report("fillEqual", k, ms, scalarMs, same);
+        ok = ok && same;
+    }
+
+    ///GrayToFloat32
+    {
+        vector<float> ref(n), out(n);
+        double        scalarMs = BestOf(d.repeat, [&] { scalar.u8ToF32(d.gray.data(), ref.data(), n); });
+        double        ms       = BestOf(d.repeat, [&] { k.u8ToF32(d.gray.data(), out.data(), n); });
+        bool          same     = memcmp(ref.data(), out.data(), n * sizeof(float)) == 0;
+        Report("u8ToF32", k, ms, scalarMs, same);
+        ok = ok && same;
+    }
+
+    ///KMeansToGray
+    {
+        vector<unsigned char> ref(n), out(n);
+        int                   lutSize  = static_cast<int>(d.lut.size());
+        double                scalarMs = BestOf(d.repeat, [&] { scalar.lookup(d.labels.data(), d.lut.data(), lutSize, ref.data(), n); });
+        double                ms       = BestOf(d.repeat, [&] { k.lookup(d.labels.data(), d.lut.data(), lutSize, out.data(), n); });
+        bool                  same     = memcmp(ref.data(), out.data(), n) == 0;
+        Report("lookup", k, ms, scalarMs, same);
+        ok = ok && same;
+    }
+
+    ///GetMingGray(按行链式调用,与ImageTool中相同)
+    {
+        float ref = 0, out = 0;
+        auto  run = [&](const ImageKernels& kernels, float& min) {
+            min = 255;
+            for (size_t i = 0; i < d.rows; ++i)
+            {
+                min = kernels.minF32(d.samples.data() + i * d.cols, d.cols, min);
+            }
+        };
+        double scalarMs = BestOf(d.repeat, [&] { run(scalar, ref); });
+        double ms       = BestOf(d.repeat, [&] { run(k, out); });
+        bool   same     = memcmp(&ref, &out, sizeof(float)) == 0;
+        Report("minF32", k, ms, scalarMs, same);
+        ok = ok && same;
+    }
+
+    ///BufToMat / MatToBuf
+    {
+        vector<unsigned char> mat(d.step * d.rows, 0), matRef(d.step * d.rows, 0);
+        vector<unsigned char> buf(n * 3), bufRef(n * 3);
+        size_t                bufStep = d.cols * 3;
+        int                   rows    = static_cast<int>(d.rows);
+        int                   cols    = static_cast<int>(d.cols);
+
+        double scalarMs = BestOf(d.repeat, [&] { scalar.copyBgr(d.bgr.data(), bufStep, matRef.data(), d.step, rows, cols); });
+        double ms       = BestOf(d.repeat, [&] { k.copyBgr(d.bgr.data(), bufStep, mat.data(), d.step, rows, cols); });
+        bool   same     = memcmp(mat.data(), matRef.data(), mat.size()) == 0;
+        Report("BufToMat", k, ms, scalarMs, same);
+        ok = ok && same;
+
+        scalarMs = BestOf(d.repeat, [&] { scalar.copyBgr(matRef.data(), d.step, bufRef.data(), bufStep, rows, cols); });
+        ms       = BestOf(d.repeat, [&] { k.copyBgr(mat.data(), d.step, buf.data(), bufStep, rows, cols); });
+        same     = memcmp(buf.data(), bufRef.data(), buf.size()) == 0 && memcmp(buf.data(), d.bgr.data(), buf.size()) == 0;
+        Report("MatToBuf", k, ms, scalarMs, same);
+        ok = ok && same;
+    }
+
+    ///Sobel(各幅值合成方式,竖直与水平部分合计)
+    {
+        const GradientMode    modes[] = {GRADIENT_OR, GRADIENT_AVERAGE, GRADIENT_L1, GRADIENT_L2};
+        const char*           names[] = {"sobelOr", "sobelAvg", "sobelL1", "sobelL2"};
+        vector<short>         v(d.cols + 2), dv(d.cols + 2);
+        vector<unsigned char> ref(n), out(n);
+
+        auto run = [&](const ImageKernels& kernels, GradientMode mode, vector<unsigned char>& dst) {
+            unsigned long long sum = 0;
+            for (size_t i = 1; i + 1 < d.rows; ++i)
+            {
+                const unsigned char* row = d.gray.data() + i * d.cols;
+                kernels.sobelRows(row - d.cols, row, row + d.cols, v.data() + 1, dv.data() + 1, d.cols);
+                v[0]           = v[2];
+                dv[0]          = dv[2];
+                v[d.cols + 1]  = v[d.cols - 1];
+                dv[d.cols + 1] = dv[d.cols - 1];
+                sum += kernels.gradientRow(v.data() + 1, dv.data() + 1, d.cols, mode, dst.data() + i * d.cols);
+            }
+            return sum;
+        };
+
+        for (int m = 0; m < 4; ++m)
+        {
+            unsigned long long refSum = 0, outSum = 0;
+            double             scalarMs = BestOf(d.repeat, [&] { refSum = run(scalar, modes[m], ref); });
+            double             ms       = BestOf(d.repeat, [&] { outSum = run(k, modes[m], out); });
+            bool               same     = memcmp(ref.data(), out.data(), n) == 0 && refSum == outSum;
+            Report(names[m], k, ms, scalarMs, same);
+            ok = ok && same;
+        }
+    }
+
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchData d;
+    d.rows   = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 2160;
+    d.cols   = argc > 2 ? static_cast<size_t>(atoi(argv[2])) : 3840;
+    d.repeat = argc > 3 ? atoi(argv[3]) : 20;
+    d.step   = d.cols * 3 + BENCH_ROW_PAD;
+
+    size_t                           n = d.rows * d.cols;
+    mt19937                          rng(1);
+    uniform_int_distribution<int>    byte(0, 255);
+    uniform_int_distribution<int>    label(0, BENCH_CLUSTERS - 1);
+    uniform_real_distribution<float> value(0.0f, 255.0f);
+
+    d.gray.resize(n);
+    d.labels.resize(n);
+    d.samples.resize(n);
+    d.bgr.resize(n * 3);
+    for (size_t i = 0; i < n; ++i)
+    {
+        d.gray[i]    = static_cast<unsigned char>(byte(rng));
+        d.labels[i]  = label(rng);
+        d.samples[i] = value(rng);
+    }
+    for (size_t i = 0; i < d.bgr.size(); ++i)
+    {
+        d.bgr[i] = static_cast<unsigned char>(byte(rng));
+    }
+    const float centers[BENCH_CLUSTERS] = {31.7f, 88.2f, 142.9f, 217.4f};
+    for (int i = 0; i < BENCH_CLUSTERS; ++i)
+    {
+        d.lut.push_back(static_cast<unsigned char>(centers[i]));
+    }
+
+    const ImageKernels& scalar = *KernelsFor(SIMD_SCALAR);
+    cout << "图像 " << d.cols << "x" << d.rows << ",重复 " << d.repeat << " 次取最快,自动选择: " << BestKernels().name << endl;
+
+    bool            ok       = true;
+    const SimdLevel levels[] = {SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_NEON};
+    for (SimdLevel level : levels)
+    {
+        const ImageKernels* k = KernelsFor(level);
+        if (k != NULL)
+        {
+            ok = Bench(d, *k, scalar) && ok;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,372 @@
+#include "FocusMeasure.h"
+#include "Gradient.h"
+#include "opencv4/opencv2/imgproc.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+#define FOCUS_STRIPE_ROWS 64  ///单幅评价时每段的行数
+
+FocusMeasure::FocusMeasure() {}
+
+/**
+ * @brief FocusMeasure::AccumulateSpan 累加一行中[x0, x1)列的各度量
+ * @param v Sobel竖直平滑(上 + 2 * 中 + 下),下标-1与cols可访问
+ * @param d Sobel竖直差分(下 - 上),同v
+ * @param c 当前行,同v
+ * @note 上 + 下 = v - 2 * 中,拉普拉斯与改进拉普拉斯都由v和当前行得到,不再读上下两行
+ */
+void FocusMeasure::AccumulateSpan(const short* v, const short* d, const uchar* c, int x0, int x1, int cols, Sums& sums)
+{
+    int64_t tenengrad = 0, lapSum = 0, lapSquare = 0, brenner = 0, modLap = 0;
+
+    for (int x = x0; x < x1; ++x)
+    {
+        int gx     = v[x + 1] - v[x - 1];
+        int gy     = d[x - 1] + 2 * d[x] + d[x + 1];
+        int center = c[x];
+        int lr     = c[x - 1] + c[x + 1];
+        int lap    = v[x] + lr - 6 * center;
+        int mh     = 2 * center - lr;
+        int mv     = 4 * center - v[x];
+
+        tenengrad += gx * gx + gy * gy;
+        lapSum += lap;
+        lapSquare += lap * lap;
+        modLap += (mh < 0 ? -mh : mh) + (mv < 0 ? -mv : mv);
+    }
+
+    int end = std::min(x1, cols - 2);
+    for (int x = x0; x < end; ++x)
+    {
+        int diff = c[x + 2] - c[x];
+        brenner += diff * diff;
+    }
+
+    sums.tenengrad += tenengrad;
+    sums.lapSum += lapSum;
+    sums.lapSquare += lapSquare;
+    sums.brenner += brenner;
+    sums.modLap += modLap;
+    sums.pixels += x1 - x0;
+    sums.brennerPixels += std::max(0, end - x0);
+}
+
+/**
+ * @brief FocusMeasure::GrayOf 取8位灰度图
+ * @param buffer 转换结果的缓存,尺寸不变时复用
+ * @return 单通道8位图返回image本身,3/4通道返回转换后的buffer,其他类型返回NULL
+ */
+const cv::Mat* FocusMeasure::GrayOf(const cv::Mat& image, cv::Mat& buffer)
+{
+    if (image.empty())
+    {
+        return NULL;
+    }
+
+    switch (image.type())
+    {
+    case CV_8UC1:
+        return &image;
+    case CV_8UC3:
+        cv::cvtColor(image, buffer, cv::COLOR_BGR2GRAY);
+        return &buffer;
+    case CV_8UC4:
+        cv::cvtColor(image, buffer, cv::COLOR_BGRA2GRAY);
+        return &buffer;
+    default:
+        return NULL;
+    }
+}
+
+/**
+ * @brief FocusMeasure::Prepare 按行宽与分块数准备缓冲并清零累加量,容量足够时不分配
+ */
+void FocusMeasure::Prepare(Scratch& scratch, int cols, size_t tiles)
+{
+    size_t width = static_cast<size_t>(cols) + 2;
+    scratch.v.resize(width);
+    scratch.d.resize(width);
+    scratch.c.resize(width);
+
+    scratch.sums.resize(tiles);
+    memset(scratch.sums.data(), 0, sizeof(Sums) * tiles);
+}
+
+/**
+ * @brief FocusMeasure::Accumulate 累加[begin, end)行
+ * @param xs 分块的列边界,tilesX + 1个
+ * @note scratch.sums只保存这几行覆盖的分块行,从第begin行所在的分块行开始
+ */
+void FocusMeasure::Accumulate(const cv::Mat& gray, int begin, int end, const int* xs, int tilesX, int tilesY, Scratch& scratch)
+{
+    int         cols   = gray.cols;
+    SobelBorder border = IsolatedBorder(gray);
+    short*      v      = scratch.v.data();
+    short*      d      = scratch.d.data();
+    uchar*      c      = scratch.c.data();
+    int64_t     first  = static_cast<int64_t>(begin) * tilesY / gray.rows;
+
+    for (int y = begin; y < end; ++y)
+    {
+        SobelRow(gray, y, border, v, d);
+
+        const uchar* row = gray.ptr<uchar>(y);
+        memcpy(c + 1, row, static_cast<size_t>(cols));
+        c[0]        = row[border.left];
+        c[cols + 1] = row[border.right];
+
+        Sums* tileRow = &scratch.sums[static_cast<size_t>(static_cast<int64_t>(y) * tilesY / gray.rows - first) * tilesX];
+        for (int t = 0; t < tilesX; ++t)
+        {
+            AccumulateSpan(v + 1, d + 1, c + 1, xs[t], xs[t + 1], cols, tileRow[t]);
+        }
+    }
+}
+
+/**
+ * @brief FocusMeasure::Finish 由累加量得到各度量
+ */
+FocusScores FocusMeasure::Finish(const Sums& sums)
+{
+    FocusScores scores = {0, 0, 0, 0};
+    if (sums.pixels > 0)
+    {
+        double n                 = static_cast<double>(sums.pixels);
+        double lapMean           = static_cast<double>(sums.lapSum) / n;
+        scores.tenengrad         = static_cast<double>(sums.tenengrad) / n;
+        scores.laplacianVar      = static_cast<double>(sums.lapSquare) / n - lapMean * lapMean;
+        scores.modifiedLaplacian = static_cast<double>(sums.modLap) / n;
+    }
+    if (sums.brennerPixels > 0)
+    {
+        scores.brenner = static_cast<double>(sums.brenner) / static_cast<double>(sums.brennerPixels);
+    }
+
+    return scores;
+}
+
+/**
+ * @brief FocusMeasure::TileRows 第[begin, end)行覆盖的分块行数
+ */
+size_t FocusMeasure::TileRows(int begin, int end, int rows, int tilesY)
+{
+    int64_t first = static_cast<int64_t>(begin) * tilesY / rows;
+    int64_t last  = static_cast<int64_t>(end - 1) * tilesY / rows;
+    return static_cast<size_t>(last - first + 1);
+}
+
+/**
+ * @brief FocusMeasure::Run 按行分段并行累加,再合并各段
+ * @note 每段只为自己覆盖的分块行(通常1~2行)保存累加量,合并时再放到整个网格中
+ */
+bool FocusMeasure::Run(const cv::Mat& gray, int tilesX, int tilesY, std::vector<FocusScores>& tiles, FocusScores* total)
+{
+    size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+    int    count     = (gray.rows + FOCUS_STRIPE_ROWS - 1) / FOCUS_STRIPE_ROWS;
+
+    xs.resize(static_cast<size_t>(tilesX) + 1);
+    for (int t = 0; t <= tilesX; ++t)
+    {
+        xs[t] = static_cast<int>(static_cast<int64_t>(t) * gray.cols / tilesX);
+    }
+
+    if (stripes.size() < static_cast<size_t>(count))
+    {
+        stripes.resize(static_cast<size_t>(count));
+    }
+
+    cv::parallel_for_(cv::Range(0, count), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s)
+        {
+            int begin = s * FOCUS_STRIPE_ROWS;
+            int end   = std::min(gray.rows, begin + FOCUS_STRIPE_ROWS);
+            Prepare(stripes[s], gray.cols, TileRows(begin, end, gray.rows, tilesY) * tilesX);
+            Accumulate(gray, begin, end, xs.data(), tilesX, tilesY, stripes[s]);
+        }
+    });
+
+    ///各段按起始分块行合并到整个网格
+    grid.resize(tileCount);
+    memset(grid.data(), 0, sizeof(Sums) * tileCount);
+    Sums* merged = grid.data();
+    for (int s = 0; s < count; ++s)
+    {
+        int         begin = s * FOCUS_STRIPE_ROWS;
+        int         end   = std::min(gray.rows, begin + FOCUS_STRIPE_ROWS);
+        size_t      size  = TileRows(begin, end, gray.rows, tilesY) * tilesX;
+        Sums*       dst   = merged + static_cast<size_t>(static_cast<int64_t>(begin) * tilesY / gray.rows) * tilesX;
+        const Sums* part  = stripes[s].sums.data();
+        for (size_t t = 0; t < size; ++t)
+        {
+            dst[t].tenengrad += part[t].tenengrad;
+            dst[t].lapSum += part[t].lapSum;
+            dst[t].lapSquare += part[t].lapSquare;
+            dst[t].brenner += part[t].brenner;
+            dst[t].modLap += part[t].modLap;
+            dst[t].pixels += part[t].pixels;
+            dst[t].brennerPixels += part[t].brennerPixels;
+        }
+    }
+
+    Sums all;
+    memset(&all, 0, sizeof(all));
+    tiles.resize(tileCount);
+    for (size_t t = 0; t < tileCount; ++t)
+    {
+        tiles[t] = Finish(merged[t]);
+
+        all.tenengrad += merged[t].tenengrad;
+        all.lapSum += merged[t].lapSum;
+        all.lapSquare += merged[t].lapSquare;
+        all.brenner += merged[t].brenner;
+        all.modLap += merged[t].modLap;
+        all.pixels += merged[t].pixels;
+        all.brennerPixels += merged[t].brennerPixels;
+    }
+
+    if (total != NULL)
+    {
+        *total = Finish(all);
+    }
+
+    return true;
+}
+
+/**
+ * @brief FocusMeasure::Measure 评价整幅图
+ * @param image 8位1/3/4通道图
+ * @param out 各度量
+ * @return 图像为空或类型不支持时返回false
+ */
+bool FocusMeasure::Measure(const cv::Mat& image, FocusScores& out)
+{
+    return this->Measure(image, cv::Rect(0, 0, image.cols, image.rows), out);
+}
+
+/**
+ * @brief FocusMeasure::Measure 评价一个ROI
+ * @param roi 评价区域,需在图像内
+ */
+bool FocusMeasure::Measure(const cv::Mat& image, const cv::Rect& roi, FocusScores& out)
+{
+    return this->MeasureTiles(image, roi, 1, 1, tileScores, &out);
+}
+
+/**
+ * @brief FocusMeasure::MeasureTiles 把ROI分成tilesX×tilesY块分别评价
+ * @param tiles 输出,按行优先排列的各块度量
+ * @param total 非NULL时输出整个ROI的度量
+ * @return 图像类型不支持、ROI不在图像内或分块数大于ROI尺寸时返回false
+ * @note 各块宽高相差不超过一个像素;彩色输入只转换ROI部分
+ */
+bool FocusMeasure::MeasureTiles(const cv::Mat& image, const cv::Rect& roi, int tilesX, int tilesY, std::vector<FocusScores>& tiles, FocusScores* total)
+{
+    if (image.empty() || tilesX <= 0 || tilesY <= 0 || roi.width < tilesX || roi.height < tilesY)
+    {
+        return false;
+    }
+    if (roi.x < 0 || roi.y < 0 || roi.x + roi.width > image.cols || roi.y + roi.height > image.rows)
+    {
+        return false;
+    }
+
+    cv::Mat        view = image(roi);
+    const cv::Mat* src  = GrayOf(view, gray);
+    if (src == NULL)
+    {
+        return false;
+    }
+
+    return this->Run(*src, tilesX, tilesY, tiles, total);
+}
+
+/**
+ * @brief FocusMeasure::Rank 并行评价一组图像,按指定度量从高到低取前topK个
+ * @param frames 图像序列,尺寸可以不同
+ * @param topK 返回的个数,<= 0时返回全部
+ * @param out 输出,按得分从高到低(同分按下标)
+ * @return frames为空时返回false
+ * @note 按工作单元(线程数)而不是按帧并行,每个单元复用自己的缓冲;无法评价的帧得分为-1
+ */
+bool FocusMeasure::Rank(const std::vector<cv::Mat>& frames, FocusMetric metric, int topK, std::vector<FocusRank>& out)
+{
+    int count = static_cast<int>(frames.size());
+    if (count == 0)
+    {
+        out.clear();
+        return false;
+    }
+
+    int units = std::max(1, std::min(cv::getNumThreads(), count));
+    if (workers.size() < static_cast<size_t>(units))
+    {
+        workers.resize(static_cast<size_t>(units));
+    }
+    ranks.resize(static_cast<size_t>(count));
+
+    cv::parallel_for_(cv::Range(0, units), [&](const cv::Range& range) {
+        for (int w = range.start; w < range.end; ++w)
+        {
+            Scratch& scratch = workers[w];
+            for (int f = w; f < count; f += units)
+            {
+                FocusRank&     rank = ranks[f];
+                const cv::Mat* src  = GrayOf(frames[f], scratch.gray);
+                rank.index          = f;
+                rank.score          = -1;
+                memset(&rank.scores, 0, sizeof(rank.scores));
+                if (src == NULL)
+                {
+                    continue;
+                }
+
+                int xs[2] = {0, src->cols};
+                Prepare(scratch, src->cols, 1);
+                Accumulate(*src, 0, src->rows, xs, 1, 1, scratch);
+                rank.scores = Finish(scratch.sums[0]);
+                rank.score  = Value(rank.scores, metric);
+            }
+        }
+    });
+
+    int k = topK <= 0 || topK > count ? count : topK;
+    std::partial_sort(ranks.begin(), ranks.begin() + k, ranks.end(), [](const FocusRank& a, const FocusRank& b) { return a.score > b.score || (a.score == b.score && a.index < b.index); });
+    out.assign(ranks.begin(), ranks.begin() + k);
+
+    return true;
+}
+
+/**
+ * @brief FocusMeasure::Value 取指定度量
+ */
+double FocusMeasure::Value(const FocusScores& scores, FocusMetric metric)
+{
+    switch (metric)
+    {
+    case FOCUS_TENENGRAD:
+        return scores.tenengrad;
+    case FOCUS_LAPLACIAN_VAR:
+        return scores.laplacianVar;
+    case FOCUS_BRENNER:
+        return scores.brenner;
+    default:
+        return scores.modifiedLaplacian;
+    }
+}
+
+/**
+ * @brief FocusMeasure::ToMap 分块结果转为tilesY×tilesX的CV_64FC1清晰度分布图
+ */
+void FocusMeasure::ToMap(const std::vector<FocusScores>& tiles, int tilesX, int tilesY, FocusMetric metric, cv::Mat& map)
+{
+    map.create(tilesY, tilesX, CV_64FC1);
+    for (int i = 0; i < tilesY; ++i)
+    {
+        double* mdata = map.ptr<double>(i);
+        for (int j = 0; j < tilesX; ++j)
+        {
+            mdata[j] = Value(tiles[static_cast<size_t>(i) * tilesX + j], metric);
+        }
+    }
+}
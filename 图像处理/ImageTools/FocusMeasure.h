@@ -0,0 +1,99 @@
+#ifndef FOCUSMEASURE_H
+#define FOCUSMEASURE_H
+
+#include "opencv4/opencv2/core.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * 图像清晰度(对焦质量)评价
+ * 一次遍历同时得到四种常用度量,可按N×M分块得到清晰度分布图,也可只评价一个ROI:
+ *   Tenengrad        :mean(Gx^2 + Gy^2),Gx/Gy为3x3 Sobel
+ *   LaplacianVar     :var(L),L为3x3拉普拉斯(与cv::Laplacian的ksize=1相同)
+ *   Brenner          :mean((I(x+2, y) - I(x, y))^2)
+ *   ModifiedLaplacian:mean(|2I - I左 - I右| + |2I - I上 - I下|)
+ * 遍历方式与Gradient相同:竖直方向的Sobel部分写入两行int16缓冲,再逐像素累加各度量,按行分段并行;
+ * ROI的边缘按图像边缘处理(BORDER_REFLECT_101),分块之间使用真实的相邻像素。
+ * 单通道8位图直接计算;3/4通道先把ROI部分转灰度(转换结果缓存在对象内)。
+ * 所有中间缓冲保存在FocusMeasure对象中,同尺寸的图像第二次起不再分配内存;对象不是线程安全的,每个线程各用一个。
+ */
+
+enum FocusMetric
+{
+    FOCUS_TENENGRAD          = 0,
+    FOCUS_LAPLACIAN_VAR      = 1,
+    FOCUS_BRENNER            = 2,
+    FOCUS_MODIFIED_LAPLACIAN = 3
+};
+
+typedef struct
+{
+    double tenengrad;
+    double laplacianVar;
+    double brenner;
+    double modifiedLaplacian;
+} FocusScores;
+
+typedef struct
+{
+    int         index;   ///<在输入序列中的下标
+    double      score;   ///<排序所用度量的值
+    FocusScores scores;  ///<全部度量
+} FocusRank;
+
+class FocusMeasure
+{
+public:
+    FocusMeasure();
+
+    bool Measure(const cv::Mat& image, FocusScores& out);
+    bool Measure(const cv::Mat& image, const cv::Rect& roi, FocusScores& out);
+    bool MeasureTiles(const cv::Mat& image, const cv::Rect& roi, int tilesX, int tilesY, std::vector<FocusScores>& tiles, FocusScores* total = NULL);
+    bool Rank(const std::vector<cv::Mat>& frames, FocusMetric metric, int topK, std::vector<FocusRank>& out);
+
+    static double Value(const FocusScores& scores, FocusMetric metric);
+    static void   ToMap(const std::vector<FocusScores>& tiles, int tilesX, int tilesY, FocusMetric metric, cv::Mat& map);
+
+private:
+    ///一个分块的累加量
+    typedef struct
+    {
+        int64_t tenengrad;
+        int64_t lapSum;
+        int64_t lapSquare;
+        int64_t brenner;
+        int64_t modLap;
+        int64_t pixels;
+        int64_t brennerPixels;
+    } Sums;
+
+    ///一段行(或批量评价中的一个工作单元)独占的缓冲
+    typedef struct
+    {
+        std::vector<short> v;     ///<竖直平滑,两端各留一个边界元素
+        std::vector<short> d;     ///<竖直差分
+        std::vector<uchar> c;     ///<当前行,两端各留一个边界元素
+        std::vector<Sums>  sums;  ///<覆盖的分块行的累加量
+        cv::Mat            gray;  ///<彩色输入转换后的灰度图(仅批量评价使用)
+    } Scratch;
+
+    static const cv::Mat* GrayOf(const cv::Mat& image, cv::Mat& buffer);
+    static void           Prepare(Scratch& scratch, int cols, size_t tiles);
+    static size_t         TileRows(int begin, int end, int rows, int tilesY);
+    static void           AccumulateSpan(const short* v, const short* d, const uchar* c, int x0, int x1, int cols, Sums& sums);
+    static void           Accumulate(const cv::Mat& gray, int begin, int end, const int* xs, int tilesX, int tilesY, Scratch& scratch);
+    static FocusScores    Finish(const Sums& sums);
+
+    bool Run(const cv::Mat& gray, int tilesX, int tilesY, std::vector<FocusScores>& tiles, FocusScores* total);
+
+    cv::Mat                  gray;        ///<彩色输入转换后的灰度图
+    std::vector<Scratch>     stripes;     ///<单幅评价时每段行一份
+    std::vector<Scratch>     workers;     ///<批量评价时每个工作单元一份
+    std::vector<int>         xs;          ///<分块的列边界
+    std::vector<Sums>        grid;        ///<各段合并后的分块累加量
+    std::vector<FocusScores> tileScores;  ///<Measure的单个分块结果
+    std::vector<FocusRank>   ranks;       ///<Rank的全部结果
+};
+
+#endif  // FOCUSMEASURE_H
@@ -0,0 +1,177 @@
+#include "Gradient.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#define GRADIENT_STRIPE_ROWS 32  ///并行时每段的行数
+
+/**
+ * @brief Reflect101 与BORDER_REFLECT_101相同的越界下标映射(只处理越界一个像素)
+ */
+int Reflect101(int i, int n)
+{
+    if (n == 1)
+    {
+        return 0;
+    }
+    if (i < 0)
+    {
+        return -i;
+    }
+    if (i >= n)
+    {
+        return 2 * n - 2 - i;
+    }
+    return i;
+}
+
+/**
+ * @brief ParentBorder 与cv::Sobel默认边界相同:ROI外有父图像的像素时读取真实像素,只在父图像边缘按BORDER_REFLECT_101反射
+ */
+SobelBorder ParentBorder(const cv::Mat& gray)
+{
+    cv::Size  whole;
+    cv::Point ofs;
+    gray.locateROI(whole, ofs);
+
+    SobelBorder border;
+    border.top    = Reflect101(ofs.y - 1, whole.height) - ofs.y;
+    border.bottom = Reflect101(ofs.y + gray.rows, whole.height) - ofs.y;
+    border.left   = Reflect101(ofs.x - 1, whole.width) - ofs.x;
+    border.right  = Reflect101(ofs.x + gray.cols, whole.width) - ofs.x;
+    return border;
+}
+
+/**
+ * @brief IsolatedBorder 按gray自身的边缘反射,不读取ROI以外的像素
+ */
+SobelBorder IsolatedBorder(const cv::Mat& gray)
+{
+    SobelBorder border;
+    border.top    = Reflect101(-1, gray.rows);
+    border.bottom = Reflect101(gray.rows, gray.rows);
+    border.left   = Reflect101(-1, gray.cols);
+    border.right  = Reflect101(gray.cols, gray.cols);
+    return border;
+}
+
+/**
+ * @brief SobelRow 计算第row行Sobel的竖直部分
+ * @param border 越过gray边缘时读取的行列,由ParentBorder或IsolatedBorder得到
+ * @param v 行缓冲,cols + 2个元素;v[1..cols]为该行的竖直平滑,v[0]与v[cols + 1]为左右边界
+ * @param d 行缓冲,同v,为竖直差分
+ */
+void SobelRow(const cv::Mat& gray, int row, const SobelBorder& border, short* v, short* d)
+{
+    int    cols = gray.cols;
+    int    up   = row == 0 ? border.top : row - 1;
+    int    down = row == gray.rows - 1 ? border.bottom : row + 1;
+    size_t step = gray.step;
+
+    ///ROI左右两侧有父图像的像素时一并计算,不再反射
+    int lo = border.left < 0 ? -1 : 0;
+    int hi = border.right >= cols ? cols + 1 : cols;
+
+    const uchar* base = gray.ptr<uchar>(0);
+    BestKernels().sobelRows(base + up * static_cast<ptrdiff_t>(step) + lo, base + row * static_cast<ptrdiff_t>(step) + lo, base + down * static_cast<ptrdiff_t>(step) + lo, v + 1 + lo,
+                            d + 1 + lo, static_cast<size_t>(hi - lo));
+
+    v[0]        = v[border.left + 1];
+    d[0]        = d[border.left + 1];
+    v[cols + 1] = v[border.right + 1];
+    d[cols + 1] = d[border.right + 1];
+}
+
+/**
+ * @brief GradientRows 计算[begin, end)行的梯度幅值
+ * @param dst 结果图,NULL时只求和
+ * @param v 行缓冲,cols + 2个元素
+ * @param d 行缓冲,同v
+ * @return 这些行的幅值之和
+ */
+static unsigned long long GradientRows(const cv::Mat& gray, const SobelBorder& border, cv::Mat* dst, GradientMode mode, int begin, int end, short* v, short* d)
+{
+    const ImageKernels& kernels = BestKernels();
+    unsigned long long  sum     = 0;
+
+    for (int i = begin; i < end; ++i)
+    {
+        SobelRow(gray, i, border, v, d);
+        sum += kernels.gradientRow(v + 1, d + 1, static_cast<size_t>(gray.cols), mode, dst != NULL ? dst->ptr<uchar>(i) : NULL);
+    }
+
+    return sum;
+}
+
+/**
+ * @brief GradientPass 按行分段并行计算整幅图
+ * @return 全图幅值之和
+ * @note 行缓冲为每个线程各一份、只增不减,同尺寸的图像第二次起不再分配内存
+ */
+static unsigned long long GradientPass(const cv::Mat& gray, cv::Mat* dst, GradientMode mode)
+{
+    int                             stripes = (gray.rows + GRADIENT_STRIPE_ROWS - 1) / GRADIENT_STRIPE_ROWS;
+    SobelBorder                     border  = ParentBorder(gray);
+    std::atomic<unsigned long long> sum(0);
+
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        static thread_local std::vector<short> buf;
+        size_t                                 width = static_cast<size_t>(gray.cols) + 2;
+        if (buf.size() < 2 * width)
+        {
+            buf.resize(2 * width);
+        }
+        short* v = buf.data();
+        short* d = buf.data() + width;
+
+        unsigned long long partial = 0;
+        for (int s = range.start; s < range.end; ++s)
+        {
+            int begin = s * GRADIENT_STRIPE_ROWS;
+            int end   = std::min(gray.rows, begin + GRADIENT_STRIPE_ROWS);
+            partial += GradientRows(gray, border, dst, mode, begin, end, v, d);
+        }
+        sum.fetch_add(partial, std::memory_order_relaxed);
+    });
+
+    return sum.load();
+}
+
+/**
+ * @brief GradientMagnitude 梯度幅值图
+ * @param gray 8位单通道图
+ * @param dst 结果图,CV_8UC1,与gray同尺寸
+ * @param mode 幅值合成方式
+ * @note gray为空或不是CV_8UC1时dst置空
+ */
+void GradientMagnitude(const cv::Mat& gray, cv::Mat& dst, GradientMode mode)
+{
+    if (gray.empty() || gray.type() != CV_8UC1)
+    {
+        dst.release();
+        return;
+    }
+
+    ///dst与gray共享数据时不能原地计算(后一行要用到前一行的原值)
+    cv::Mat out = dst.data == gray.data ? cv::Mat(gray.size(), CV_8UC1) : dst;
+    out.create(gray.size(), CV_8UC1);
+    GradientPass(gray, &out, mode);
+    dst = out;
+}
+
+/**
+ * @brief GradientScore 梯度幅值的均值,不生成图像
+ * @param gray 8位单通道图
+ * @param mode 幅值合成方式,GRADIENT_AVERAGE即原CalcTenengrad的度量
+ * @return gray为空或不是CV_8UC1时返回0
+ */
+double GradientScore(const cv::Mat& gray, GradientMode mode)
+{
+    if (gray.empty() || gray.type() != CV_8UC1)
+    {
+        return 0;
+    }
+
+    return static_cast<double>(GradientPass(gray, NULL, mode)) / static_cast<double>(gray.total());
+}
@@ -0,0 +1,34 @@
+#ifndef GRADIENT_H
+#define GRADIENT_H
+
+#include "ImageKernels.h"
+#include "opencv4/opencv2/core.hpp"
+
+/**
+ * 单遍的3x3 Sobel梯度
+ * 逐行滑动三行窗口:竖直部分(1 2 1平滑与上下差分)写入两行int16缓冲,水平部分直接得到Gx/Gy并合成幅值,
+ * 中间结果只有两行int16,始终在L1缓存中;按行分段并行,每段独立维护自己的缓冲。
+ * 边界与cv::Sobel的默认边界(BORDER_REFLECT_101)相同,8位输入的Gx/Gy不超过±1020,int16不会溢出,
+ * 因此GRADIENT_OR/GRADIENT_AVERAGE与原来CV_64F + convertScaleAbs + bitwise_or/addWeighted的结果逐像素一致。
+ * 输入为ROI时与cv::Sobel相同:ROI边缘外的一行/一列取父图像中真实的相邻像素,只在父图像的边缘反射;
+ * 需要按ROI自身边缘反射(相当于BORDER_ISOLATED)时用IsolatedBorder
+ */
+
+///SobelRow在第-1行/第rows行、第-1列/第cols列读取的下标(相对gray,-1与rows/cols表示ROI外父图像中的像素)
+typedef struct
+{
+    int top;
+    int bottom;
+    int left;
+    int right;
+} SobelBorder;
+
+void   GradientMagnitude(const cv::Mat& gray, cv::Mat& dst, GradientMode mode);
+double GradientScore(const cv::Mat& gray, GradientMode mode);
+
+int         Reflect101(int i, int n);
+SobelBorder ParentBorder(const cv::Mat& gray);
+SobelBorder IsolatedBorder(const cv::Mat& gray);
+void        SobelRow(const cv::Mat& gray, int row, const SobelBorder& border, short* v, short* d);
+
+#endif  // GRADIENT_H
@@ -0,0 +1,157 @@
+#include "HistKMeans.h"
+
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+#define HIST_STRIPE_ROWS 64  ///并行统计时每段的行数
+
+/**
+ * @brief GrayHistogram 并行统计8位单通道图的直方图
+ * @param src 灰度图,可以不连续(ROI)
+ * @param hist 输出,各灰度级的像素数
+ * @note 按行分段,每段统计到自己的局部直方图,最后合并,段之间没有共享写入
+ */
+void GrayHistogram(const cv::Mat& src, uint64_t hist[HIST_BINS])
+{
+    memset(hist, 0, sizeof(uint64_t) * HIST_BINS);
+
+    int stripes = (src.rows + HIST_STRIPE_ROWS - 1) / HIST_STRIPE_ROWS;
+    if (stripes <= 0)
+    {
+        return;
+    }
+
+    std::vector<uint32_t> partial(static_cast<size_t>(stripes) * HIST_BINS, 0);
+
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s)
+        {
+            uint32_t* local = &partial[static_cast<size_t>(s) * HIST_BINS];
+            int       end   = std::min(src.rows, (s + 1) * HIST_STRIPE_ROWS);
+
+            for (int i = s * HIST_STRIPE_ROWS; i < end; ++i)
+            {
+                const uchar* idata = src.ptr<uchar>(i);
+                for (int j = 0; j < src.cols; ++j)
+                {
+                    local[idata[j]]++;
+                }
+            }
+        }
+    });
+
+    for (int s = 0; s < stripes; ++s)
+    {
+        const uint32_t* local = &partial[static_cast<size_t>(s) * HIST_BINS];
+        for (int k = 0; k < HIST_BINS; ++k)
+        {
+            hist[k] += local[k];
+        }
+    }
+}
+
+/**
+ * @brief HistKMeans 对直方图做精确的一维K聚类
+ * @param hist 直方图
+ * @param clusterCount 要求的类数
+ * @param result 输出
+ * @return 直方图为空或类数不合法时返回false
+ * @note 只对出现过的m个灰度级做动态规划:cost[c][j]为前j个灰度级分成c类的最小平方误差和,
+ *       区间误差由前缀和O(1)求出,总计算量O(K*m^2),m <= 256
+ */
+bool HistKMeans(const uint64_t hist[HIST_BINS], int clusterCount, HistKMeansResult& result)
+{
+    memset(&result, 0, sizeof(result));
+
+    int    values[HIST_BINS];         ///出现过的灰度级
+    double w[HIST_BINS + 1]   = {0};  ///前缀和:权重、一阶矩、二阶矩
+    double wx[HIST_BINS + 1]  = {0};
+    double wxx[HIST_BINS + 1] = {0};
+
+    int m = 0;
+    for (int v = 0; v < HIST_BINS; ++v)
+    {
+        if (hist[v] > 0)
+        {
+            double n   = static_cast<double>(hist[v]);
+            values[m]  = v;
+            w[m + 1]   = w[m] + n;
+            wx[m + 1]  = wx[m] + n * v;
+            wxx[m + 1] = wxx[m] + n * v * v;
+            m++;
+        }
+    }
+
+    if (m == 0 || clusterCount <= 0)
+    {
+        return false;
+    }
+
+    int k = clusterCount < m ? clusterCount : m;
+
+    ///第i..j-1个灰度级(0起)归为一类的平方误差和
+    auto sse = [&](int i, int j) {
+        double sw  = w[j] - w[i];
+        double swx = wx[j] - wx[i];
+        double err = (wxx[j] - wxx[i]) - swx * swx / sw;
+        return err > 0 ? err : 0.0;
+    };
+
+    std::vector<double> cost(static_cast<size_t>(k + 1) * (m + 1), 0);
+    std::vector<int>    split(static_cast<size_t>(k + 1) * (m + 1), 0);
+
+    for (int j = 1; j <= m; ++j)
+    {
+        cost[1 * (m + 1) + j] = sse(0, j);
+    }
+
+    for (int c = 2; c <= k; ++c)
+    {
+        for (int j = c; j <= m; ++j)
+        {
+            double best = -1;
+            int    from = c - 1;
+            for (int i = c - 1; i < j; ++i)
+            {
+                double candidate = cost[(c - 1) * (m + 1) + i] + sse(i, j);
+                if (best < 0 || candidate < best)
+                {
+                    best = candidate;
+                    from = i;
+                }
+            }
+            cost[c * (m + 1) + j]  = best;
+            split[c * (m + 1) + j] = from;
+        }
+    }
+
+    ///回溯各类的边界,得到中心与查找表
+    int bounds[HIST_BINS + 1];
+    bounds[k] = m;
+    for (int c = k; c >= 2; --c)
+    {
+        bounds[c - 1] = split[c * (m + 1) + bounds[c]];
+    }
+    bounds[0] = 0;
+
+    result.count = k;
+    for (int c = 0; c < k; ++c)
+    {
+        int first = bounds[c];
+        int last  = bounds[c + 1];
+
+        result.centers[c] = static_cast<float>((wx[last] - wx[first]) / (w[last] - w[first]));
+
+        ///没有出现的灰度级以相邻两个出现过的灰度的中点为界归类,使查找表对任意输入都有定义
+        int lo = c == 0 ? 0 : (values[first - 1] + values[first]) / 2 + 1;
+        int hi = c == k - 1 ? HIST_BINS - 1 : (values[last - 1] + values[last]) / 2;
+        for (int v = lo; v <= hi; ++v)
+        {
+            result.labels[v] = static_cast<uchar>(c);
+            result.lut[v]    = static_cast<uchar>(result.centers[c]);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef HISTKMEANS_H
+#define HISTKMEANS_H
+
+#include "opencv4/opencv2/core.hpp"
+
+#include <stdint.h>
+
+/**
+ * 8位灰度图的一维K聚类
+ * 灰度只有256种取值,先并行统计一次直方图,再对256个带权的灰度级聚类:
+ * 一维K聚类的最优解中每一类都是一段连续的灰度,用动态规划精确求出使类内平方误差和最小的分段,
+ * 结果不依赖初始中心和尝试次数;最后得到每个灰度级到类中心灰度的查找表。
+ * 除直方图统计外,时间和内存都与分辨率无关
+ */
+
+#define HIST_BINS 256
+
+typedef struct
+{
+    int   count;               ///<实际类数,不同灰度值少于要求的类数时会变少
+    float centers[HIST_BINS];  ///<各类中心(带权平均灰度),按灰度从小到大
+    uchar labels[HIST_BINS];   ///<每个灰度级所属的类
+    uchar lut[HIST_BINS];      ///<每个灰度级对应的类中心灰度(取整方式与static_cast<uchar>相同)
+} HistKMeansResult;
+
+void GrayHistogram(const cv::Mat& src, uint64_t hist[HIST_BINS]);
+bool HistKMeans(const uint64_t hist[HIST_BINS], int clusterCount, HistKMeansResult& result);
+
+#endif  // HISTKMEANS_H
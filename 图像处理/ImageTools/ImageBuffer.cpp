@@ -0,0 +1,189 @@
+#include "ImageBuffer.h"
+
+#include <stdint.h>
+#include <utility>
+
+/**
+ * Adopt的缓冲区的归还方式,保存在UMatData::userdata中
+ */
+typedef struct
+{
+    unsigned char* data;
+    BufferRelease  release;
+    void*          user;
+} Adoption;
+
+/**
+ * 只负责归还Adopt的缓冲区:Mat的引用计数降到0时OpenCV经UMatData::currAllocator调用unmap -> deallocate
+ * 不分配内存
+ */
+class AdoptAllocator : public cv::MatAllocator
+{
+public:
+    cv::UMatData* allocate(int, const int*, int, void*, size_t*, cv::AccessFlag, cv::UMatUsageFlags) const override
+    {
+        return NULL;
+    }
+
+    bool allocate(cv::UMatData*, cv::AccessFlag, cv::UMatUsageFlags) const override
+    {
+        return false;
+    }
+
+    void deallocate(cv::UMatData* u) const override
+    {
+        if (u == NULL)
+        {
+            return;
+        }
+
+        Adoption* adoption = static_cast<Adoption*>(u->userdata);
+        adoption->release(adoption->data, adoption->user);
+        delete adoption;
+        delete u;
+    }
+
+    ///进程内唯一的实例,不析构:静态对象析构后仍可能有Mat释放
+    static const AdoptAllocator* Instance()
+    {
+        static const AdoptAllocator* instance = new AdoptAllocator;
+        return instance;
+    }
+};
+
+ImageBuffer::ImageBuffer() : owner(false) {}
+
+ImageBuffer::~ImageBuffer()
+{
+    this->Reset();
+}
+
+ImageBuffer::ImageBuffer(ImageBuffer&& other) : view(std::move(other.view)), owner(other.owner)
+{
+    other.view  = cv::Mat();
+    other.owner = false;
+}
+
+ImageBuffer& ImageBuffer::operator=(ImageBuffer&& other)
+{
+    if (this != &other)
+    {
+        this->Reset();
+
+        view  = std::move(other.view);
+        owner = other.owner;
+
+        other.view  = cv::Mat();
+        other.owner = false;
+    }
+
+    return *this;
+}
+
+/**
+ * @brief ImageBuffer::CheckLayout 检查外部缓冲区能否不复制地表示为Mat
+ * @param data 缓冲区
+ * @param rows 行
+ * @param cols 列
+ * @param type Mat类型,如CV_8UC3
+ * @param step 行步长(字节),0表示行间无填充;检查通过时改为实际步长
+ * @return 指针非空、类型合法、尺寸为正、步长不小于一行像素且是通道字节数的整数倍、rows * step不溢出
+ */
+bool ImageBuffer::CheckLayout(const void* data, int rows, int cols, int type, size_t& step)
+{
+    if (data == NULL || rows <= 0 || cols <= 0 || type < 0 || type != CV_MAT_TYPE(type))
+    {
+        return false;
+    }
+
+    size_t elemSize  = CV_ELEM_SIZE(type);
+    size_t elemSize1 = elemSize / CV_MAT_CN(type);
+    size_t minStep   = static_cast<size_t>(cols) * elemSize;
+    size_t actual    = step == 0 ? minStep : step;
+
+    if (actual < minStep || actual % elemSize1 != 0 || actual > SIZE_MAX / static_cast<size_t>(rows))
+    {
+        return false;
+    }
+
+    step = actual;
+    return true;
+}
+
+/**
+ * @brief ImageBuffer::Borrow 借用外部缓冲区
+ * @return 布局不合法时返回false,原有内容保持不变
+ */
+bool ImageBuffer::Borrow(unsigned char* data, int rows, int cols, int type, size_t step)
+{
+    if (!CheckLayout(data, rows, cols, type, step))
+    {
+        return false;
+    }
+
+    this->Reset();
+    view = cv::Mat(rows, cols, type, data, step);
+
+    return true;
+}
+
+/**
+ * @brief ImageBuffer::Adopt 接管外部缓冲区
+ * @param release 归还函数,不能为NULL;在最后一个引用该缓冲区的Mat释放时调用
+ * @param user 传给release的参数
+ * @return 布局不合法时返回false,此时所有权仍在调用方
+ * @note 由View()复制出的Mat(包括ROI)同样持有所有权,ImageBuffer先于它们析构时缓冲区不会被归还
+ */
+bool ImageBuffer::Adopt(unsigned char* data, int rows, int cols, int type, size_t step, BufferRelease release, void* user)
+{
+    if (release == NULL || !CheckLayout(data, rows, cols, type, step))
+    {
+        return false;
+    }
+
+    this->Reset();
+
+    Adoption* adoption = new Adoption;
+    adoption->data     = data;
+    adoption->release  = release;
+    adoption->user     = user;
+
+    cv::UMatData* u = new cv::UMatData(AdoptAllocator::Instance());
+    u->data         = data;
+    u->origdata     = data;
+    u->size         = static_cast<size_t>(rows) * step;
+    u->userdata     = adoption;
+    u->refcount     = 1;  //view持有的引用
+
+    ///只挂在UMatData上,Mat::allocator保持默认,复制出的Mat重新create()时不会走到这里
+    view   = cv::Mat(rows, cols, type, data, step);
+    view.u = u;
+    owner  = true;
+
+    return true;
+}
+
+/**
+ * @brief ImageBuffer::Reset 解除包装
+ * @note Adopt的缓冲区只释放本对象的引用,没有其他Mat引用时随即归还
+ */
+void ImageBuffer::Reset()
+{
+    view.release();
+    owner = false;
+}
+
+const cv::Mat& ImageBuffer::View() const
+{
+    return view;
+}
+
+bool ImageBuffer::IsOwner() const
+{
+    return owner;
+}
+
+bool ImageBuffer::Empty() const
+{
+    return view.empty();
+}
@@ -0,0 +1,44 @@
+#ifndef IMAGEBUFFER_H
+#define IMAGEBUFFER_H
+
+#include "opencv4/opencv2/core.hpp"
+
+/**
+ * 把相机/驱动给出的外部缓冲区包装成cv::Mat头,不复制像素
+ * Borrow:只借用,缓冲区由调用方管理,需保证在ImageBuffer及其派生的Mat头使用期间有效;
+ * Adopt:接管所有权,所有权挂在Mat的引用计数上(UMatData + 专用MatAllocator):
+ *        View()及其浅拷贝、ROI都持有引用,ImageBuffer析构、Reset或重新包装只释放自己的引用,
+ *        最后一个引用消失时才调用release归还(如把帧还给驱动队列),release可能在任意持有引用的线程中调用。
+ * Borrow得到的Mat头不持有所有权,需要在缓冲区失效后继续使用时先clone()
+ */
+
+///归还外部缓冲区,data为Adopt时传入的指针
+typedef void (*BufferRelease)(unsigned char* data, void* user);
+
+class ImageBuffer
+{
+public:
+    ImageBuffer();
+    ~ImageBuffer();
+    ImageBuffer(ImageBuffer&& other);
+    ImageBuffer& operator=(ImageBuffer&& other);
+
+    bool Borrow(unsigned char* data, int rows, int cols, int type, size_t step = 0);
+    bool Adopt(unsigned char* data, int rows, int cols, int type, size_t step, BufferRelease release, void* user);
+    void Reset();
+
+    const cv::Mat& View() const;
+    bool           IsOwner() const;
+    bool           Empty() const;
+
+    static bool CheckLayout(const void* data, int rows, int cols, int type, size_t& step);
+
+private:
+    ImageBuffer(const ImageBuffer&);
+    ImageBuffer& operator=(const ImageBuffer&);
+
+    cv::Mat view;   ///<指向外部缓冲区的Mat头,Adopt时持有一个引用
+    bool    owner;  ///<是否由Adopt得到
+};
+
+#endif  // IMAGEBUFFER_H
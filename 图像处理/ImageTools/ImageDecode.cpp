@@ -0,0 +1,336 @@
+#include "ImageDecode.h"
+#include "opencv4/opencv2/imgcodecs.hpp"
+
+#include <string.h>
+
+#define PROBE_HEAD_SIZE 32    ///识别格式并解析PNG/BMP所需的字节数
+#define PROBE_EXIF_SIZE 4096  ///APP1段最多读取的字节数,IFD0通常紧跟在TIFF头之后
+
+DecodeOptions DefaultDecodeOptions()
+{
+    DecodeOptions options = {DECODE_COLOR, 1};
+    return options;
+}
+
+/**
+ * @brief DecodeFlags 解码选项对应的imdecode/imread标志
+ * @return 缩小倍数不是1、2、4、8时返回-1;DECODE_UNCHANGED不含缩小,需解码后自行缩小
+ */
+int DecodeFlags(const DecodeOptions& options)
+{
+    if (options.scale != 1 && options.scale != 2 && options.scale != 4 && options.scale != 8)
+    {
+        return -1;
+    }
+
+    if (options.color == DECODE_UNCHANGED)
+    {
+        return cv::IMREAD_UNCHANGED;
+    }
+
+    bool gray = options.color == DECODE_GRAY;
+    switch (options.scale)
+    {
+    case 2:
+        return gray ? cv::IMREAD_REDUCED_GRAYSCALE_2 : cv::IMREAD_REDUCED_COLOR_2;
+    case 4:
+        return gray ? cv::IMREAD_REDUCED_GRAYSCALE_4 : cv::IMREAD_REDUCED_COLOR_4;
+    case 8:
+        return gray ? cv::IMREAD_REDUCED_GRAYSCALE_8 : cv::IMREAD_REDUCED_COLOR_8;
+    default:
+        return gray ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+    }
+}
+
+/**
+ * @brief ScaleFor 在结果不小于minWidth×minHeight的前提下选最大的缩小倍数
+ * @return 1、2、4或8;信息无效时返回1
+ * @note 缩小后的尺寸按向上取整计算,与libjpeg一致
+ */
+int ScaleFor(const ImageInfo& info, int minWidth, int minHeight)
+{
+    const int scales[] = {8, 4, 2};
+    for (int scale : scales)
+    {
+        if ((info.width + scale - 1) / scale >= minWidth && (info.height + scale - 1) / scale >= minHeight)
+        {
+            return scale;
+        }
+    }
+
+    return 1;
+}
+
+static unsigned int Be16(const unsigned char* p)
+{
+    return (static_cast<unsigned int>(p[0]) << 8) | p[1];
+}
+
+static unsigned int Be32(const unsigned char* p)
+{
+    return (Be16(p) << 16) | Be16(p + 2);
+}
+
+static unsigned int Le16(const unsigned char* p)
+{
+    return (static_cast<unsigned int>(p[1]) << 8) | p[0];
+}
+
+static unsigned int Le32(const unsigned char* p)
+{
+    return (Le16(p + 2) << 16) | Le16(p);
+}
+
+/**
+ * @brief ExifOrientation 从APP1段(去掉长度后的内容)中取EXIF方向
+ * @return 1~8,没有或格式不对时返回1
+ */
+static int ExifOrientation(const unsigned char* seg, size_t len)
+{
+    if (len < 14 || memcmp(seg, "Exif\0\0", 6) != 0)
+    {
+        return 1;
+    }
+
+    const unsigned char* tiff = seg + 6;
+    size_t               size = len - 6;
+    bool                 le   = tiff[0] == 'I' && tiff[1] == 'I';
+    if (!le && !(tiff[0] == 'M' && tiff[1] == 'M'))
+    {
+        return 1;
+    }
+
+    unsigned int ifd = le ? Le32(tiff + 4) : Be32(tiff + 4);
+    if (static_cast<size_t>(ifd) + 2 > size)
+    {
+        return 1;
+    }
+
+    unsigned int count = le ? Le16(tiff + ifd) : Be16(tiff + ifd);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        size_t entry = static_cast<size_t>(ifd) + 2 + 12 * static_cast<size_t>(i);
+        if (entry + 12 > size)
+        {
+            break;
+        }
+
+        const unsigned char* p   = tiff + entry;
+        unsigned int         tag = le ? Le16(p) : Be16(p);
+        if (tag == 0x0112)
+        {
+            unsigned int value = le ? Le16(p + 8) : Be16(p + 8);
+            return value >= 1 && value <= 8 ? static_cast<int>(value) : 1;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief ProbeJpeg 逐段跳过直到SOF,只读取段头与APP1
+ * @note 段之间可能有填充的0xFF;SOS之前没有SOF视为无效
+ */
+static bool ProbeJpeg(ProbeRead read, void* ctx, ImageInfo& info)
+{
+    unsigned char seg[PROBE_EXIF_SIZE];
+    size_t        offset = 2;
+
+    info.orientation = 1;
+
+    for (;;)
+    {
+        unsigned char marker[2];
+        if (read(ctx, offset, marker, 2) != 2 || marker[0] != 0xFF)
+        {
+            return false;
+        }
+        if (marker[1] == 0xFF)
+        {
+            offset++;
+            continue;
+        }
+
+        unsigned char m = marker[1];
+        offset += 2;
+        if (m == 0x01 || (m >= 0xD0 && m <= 0xD7))
+        {
+            continue;
+        }
+        if (m == 0xD9 || m == 0xDA)
+        {
+            return false;
+        }
+
+        unsigned char lenBytes[2];
+        if (read(ctx, offset, lenBytes, 2) != 2)
+        {
+            return false;
+        }
+        size_t len = Be16(lenBytes);
+        if (len < 2)
+        {
+            return false;
+        }
+
+        bool sof = m >= 0xC0 && m <= 0xCF && m != 0xC4 && m != 0xC8 && m != 0xCC;
+        if (sof || m == 0xE1)
+        {
+            size_t body = len - 2;
+            if (body > sizeof(seg))
+            {
+                body = sizeof(seg);
+            }
+            if (read(ctx, offset + 2, seg, body) != body)
+            {
+                return false;
+            }
+
+            if (m == 0xE1)
+            {
+                if (info.orientation == 1)
+                {
+                    info.orientation = ExifOrientation(seg, body);
+                }
+            }
+            else
+            {
+                if (body < 6)
+                {
+                    return false;
+                }
+
+                info.format   = IMAGE_JPEG;
+                info.depth    = seg[0];
+                info.height   = static_cast<int>(Be16(seg + 1));
+                info.width    = static_cast<int>(Be16(seg + 3));
+                info.channels = seg[5];
+
+                ///方向5~8需要转置,OpenCV默认按EXIF方向旋转
+                if (info.orientation >= 5)
+                {
+                    int width   = info.width;
+                    info.width  = info.height;
+                    info.height = width;
+                }
+
+                return info.width > 0 && info.height > 0;
+            }
+        }
+
+        offset += len;
+    }
+}
+
+static bool ProbePng(const unsigned char* head, size_t size, ImageInfo& info)
+{
+    if (size < 29 || memcmp(head + 12, "IHDR", 4) != 0)
+    {
+        return false;
+    }
+
+    static const int channels[7] = {1, 0, 3, 3, 2, 0, 4};  ///按颜色类型:灰度/-/RGB/调色板/灰度+α/-/RGBA
+    unsigned int     colorType   = head[25];
+
+    info.format      = IMAGE_PNG;
+    info.width       = static_cast<int>(Be32(head + 16));
+    info.height      = static_cast<int>(Be32(head + 20));
+    info.depth       = head[24];
+    info.channels    = colorType < 7 ? channels[colorType] : 0;
+    info.orientation = 1;
+
+    return info.width > 0 && info.height > 0 && info.channels > 0;
+}
+
+static bool ProbeBmp(const unsigned char* head, size_t size, ImageInfo& info)
+{
+    if (size < 26)
+    {
+        return false;
+    }
+
+    unsigned int dib = Le32(head + 14);
+    int          bits;
+    if (dib == 12)
+    {
+        info.width  = static_cast<int>(Le16(head + 18));
+        info.height = static_cast<int>(Le16(head + 20));
+        bits        = static_cast<int>(Le16(head + 24));
+    }
+    else if (dib >= 40 && size >= 30)
+    {
+        int height  = static_cast<int>(Le32(head + 22));
+        info.width  = static_cast<int>(Le32(head + 18));
+        info.height = height < 0 ? -height : height;  //负数表示自上而下存储
+        bits        = static_cast<int>(Le16(head + 28));
+    }
+    else
+    {
+        return false;
+    }
+
+    info.format      = IMAGE_BMP;
+    info.depth       = 8;
+    info.channels    = bits == 32 ? 4 : 3;  //调色板图解码后为3通道
+    info.orientation = 1;
+
+    return info.width > 0 && info.height > 0;
+}
+
+/**
+ * @brief ProbeImage 只解析文件头,取图像尺寸与通道数
+ * @param read 按偏移读取的函数,用于文件时只读取用到的部分
+ * @param ctx 传给read
+ * @param info 输出
+ * @return 格式不支持或文件头不完整时返回false
+ */
+bool ProbeImage(ProbeRead read, void* ctx, ImageInfo& info)
+{
+    memset(&info, 0, sizeof(info));
+
+    unsigned char head[PROBE_HEAD_SIZE];
+    size_t        size = read(ctx, 0, head, sizeof(head));
+
+    if (size >= 3 && head[0] == 0xFF && head[1] == 0xD8 && head[2] == 0xFF)
+    {
+        return ProbeJpeg(read, ctx, info);
+    }
+    if (size >= 8 && memcmp(head, "\x89PNG\r\n\x1a\n", 8) == 0)
+    {
+        return ProbePng(head, size, info);
+    }
+    if (size >= 2 && head[0] == 'B' && head[1] == 'M')
+    {
+        return ProbeBmp(head, size, info);
+    }
+
+    return false;
+}
+
+typedef struct
+{
+    const unsigned char* data;
+    size_t               size;
+} ProbeBuffer;
+
+static size_t ReadBuffer(void* ctx, size_t offset, unsigned char* dst, size_t n)
+{
+    const ProbeBuffer* buf = static_cast<const ProbeBuffer*>(ctx);
+    if (offset >= buf->size)
+    {
+        return 0;
+    }
+
+    size_t count = buf->size - offset < n ? buf->size - offset : n;
+    memcpy(dst, buf->data + offset, count);
+    return count;
+}
+
+/**
+ * @brief ProbeImage 解析内存中的图像文件头
+ */
+bool ProbeImage(const unsigned char* data, size_t size, ImageInfo& info)
+{
+    ProbeBuffer buf = {data, size};
+    return ProbeImage(ReadBuffer, &buf, info);
+}
@@ -0,0 +1,55 @@
+#ifndef IMAGEDECODE_H
+#define IMAGEDECODE_H
+
+#include <stddef.h>
+
+/**
+ * 解码选项与图像头解析
+ * JPEG在IDCT阶段就能按1/2、1/4、1/8输出(libjpeg的scale_denom,OpenCV通过IMREAD_REDUCED_*使用),
+ * 解码量按面积减少,比全尺寸解码后再缩小快数倍;同时指定灰度时只解码亮度分量,省去颜色转换。
+ * PNG/BMP等格式没有这种能力,OpenCV会在全尺寸解码后缩小,结果尺寸相同但没有速度收益。
+ * ProbeImage只解析文件头(JPEG的SOF段、PNG的IHDR块、BMP的信息头),不解码像素,用于事先选择缩放比例或筛选图像
+ */
+
+enum DecodeColor
+{
+    DECODE_COLOR     = 0,  ///<3通道BGR(原imdecode(..., 1))
+    DECODE_GRAY      = 1,  ///<单通道灰度
+    DECODE_UNCHANGED = 2   ///<保持原通道数与位深,缩小时在解码后进行
+};
+
+enum ImageFormat
+{
+    IMAGE_UNKNOWN = 0,
+    IMAGE_JPEG    = 1,
+    IMAGE_PNG     = 2,
+    IMAGE_BMP     = 3
+};
+
+typedef struct
+{
+    DecodeColor color;
+    int         scale;  ///<缩小倍数:1、2、4、8
+} DecodeOptions;
+
+typedef struct
+{
+    ImageFormat format;
+    int         width;        ///<按EXIF方向旋转后的宽度,与OpenCV默认解码结果一致
+    int         height;       ///<同上
+    int         channels;     ///<文件中存储的通道数(JPEG的分量数、PNG按颜色类型、BMP按位数)
+    int         depth;        ///<每通道位数
+    int         orientation;  ///<JPEG的EXIF方向(1~8),没有时为1
+} ImageInfo;
+
+///从offset处读取最多n字节,返回实际读到的字节数
+typedef size_t (*ProbeRead)(void* ctx, size_t offset, unsigned char* dst, size_t n);
+
+DecodeOptions DefaultDecodeOptions();
+int           DecodeFlags(const DecodeOptions& options);
+int           ScaleFor(const ImageInfo& info, int minWidth, int minHeight);
+
+bool ProbeImage(const unsigned char* data, size_t size, ImageInfo& info);
+bool ProbeImage(ProbeRead read, void* ctx, ImageInfo& info);
+
+#endif  // IMAGEDECODE_H
@@ -0,0 +1,633 @@
+#include "ImageKernels.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IMAGEKERNELS_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define IMAGEKERNELS_NEON 1
+#endif
+
+#define LOOKUP_SHUFFLE_MAX 16  ///查表项数不超过16时用字节重排指令一次查16个
+
+/**
+ * @brief MinFixZero 最小值为0时按顺序找出第一个0,保证±0的符号与逐元素比较一致
+ * @note  逐元素比较时等于当前最小值的元素不会替换它;各通道分别比较后再合并时,最小值相同只可能是+0与-0
+ */
+static float MinFixZero(const float* src, size_t n, float init, float result)
+{
+    if (result != 0.0f || init == 0.0f)
+    {
+        return result == 0.0f ? init : result;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (src[i] == 0.0f)
+        {
+            return src[i];
+        }
+    }
+
+    return result;
+}
+
+// ---------------------------------------------------------------- 标量
+
+static void FillEqualScalar(const unsigned char* src, unsigned char* dst, size_t n, unsigned char gray)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (gray != src[i])
+        {
+            dst[i] = 0;
+        }
+        else
+        {
+            dst[i] = 255;
+        }
+    }
+}
+
+static void U8ToF32Scalar(const unsigned char* src, float* dst, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        dst[i] = src[i];
+    }
+}
+
+static void LookupScalar(const int* labels, const unsigned char* lut, int lutSize, unsigned char* dst, size_t n)
+{
+    (void)lutSize;
+    for (size_t i = 0; i < n; ++i)
+    {
+        dst[i] = lut[labels[i]];
+    }
+}
+
+static float MinF32Scalar(const float* src, size_t n, float init)
+{
+    float min = init;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (min > src[i])
+        {
+            min = src[i];
+        }
+    }
+    return min;
+}
+
+static void CopyBgrScalar(const unsigned char* src, size_t srcStep, unsigned char* dst, size_t dstStep, int rows, int cols)
+{
+    for (int i = 0; i < rows; ++i)
+    {
+        const unsigned char* idata = src + i * srcStep;
+        unsigned char*       pdata = dst + i * dstStep;
+
+        for (int j = 0; j < cols; ++j)
+        {
+            pdata[3 * j]     = idata[3 * j];
+            pdata[3 * j + 1] = idata[3 * j + 1];
+            pdata[3 * j + 2] = idata[3 * j + 2];
+        }
+    }
+}
+
+/**
+ * @brief CopyBgrRows 按行复制,两端都没有行尾填充时整块复制
+ * @note  memcpy在libc中已按CPU向量化,比逐像素复制三个字节快一个数量级
+ */
+static void CopyBgrRows(const unsigned char* src, size_t srcStep, unsigned char* dst, size_t dstStep, int rows, int cols)
+{
+    size_t rowBytes = static_cast<size_t>(cols) * 3;
+    if (srcStep == rowBytes && dstStep == rowBytes)
+    {
+        memcpy(dst, src, rowBytes * static_cast<size_t>(rows));
+        return;
+    }
+
+    for (int i = 0; i < rows; ++i)
+    {
+        memcpy(dst + i * dstStep, src + i * srcStep, rowBytes);
+    }
+}
+
+static void SobelRowsScalar(const unsigned char* r0, const unsigned char* r1, const unsigned char* r2, short* v, short* d, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        v[i] = static_cast<short>(r0[i] + 2 * r1[i] + r2[i]);
+        d[i] = static_cast<short>(r2[i] - r0[i]);
+    }
+}
+
+static unsigned char Saturate(int x)
+{
+    return static_cast<unsigned char>(x > 255 ? 255 : x);
+}
+
+/**
+ * @brief Magnitude 单个像素的幅值,SIMD版本的尾部也用它
+ * @note  AVERAGE:和为奇数时商q + 0.5取偶数,即q为奇数时进一
+ */
+static unsigned char Magnitude(int gx, int gy, GradientMode mode)
+{
+    int ax = gx < 0 ? -gx : gx;
+    int ay = gy < 0 ? -gy : gy;
+
+    switch (mode)
+    {
+    case GRADIENT_OR:
+        return static_cast<unsigned char>(Saturate(ax) | Saturate(ay));
+    case GRADIENT_AVERAGE:
+    {
+        int sum = Saturate(ax) + Saturate(ay);
+        int q   = sum >> 1;
+        return static_cast<unsigned char>(q + (sum & q & 1));
+    }
+    case GRADIENT_L1:
+        return Saturate(ax + ay);
+    default:
+        return Saturate(static_cast<int>(lrintf(sqrtf(static_cast<float>(gx * gx + gy * gy)))));
+    }
+}
+
+static unsigned long long GradientRowScalar(const short* v, const short* d, size_t n, GradientMode mode, unsigned char* dst)
+{
+    unsigned long long sum = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        int           gx = v[i + 1] - v[i - 1];
+        int           gy = d[i - 1] + 2 * d[i] + d[i + 1];
+        unsigned char m  = Magnitude(gx, gy, mode);
+        if (dst != NULL)
+        {
+            dst[i] = m;
+        }
+        sum += m;
+    }
+    return sum;
+}
+
+#if defined(IMAGEKERNELS_X86)
+
+// ---------------------------------------------------------------- SSE2
+
+static void FillEqualSse2(const unsigned char* src, unsigned char* dst, size_t n, unsigned char gray)
+{
+    const __m128i g = _mm_set1_epi8(static_cast<char>(gray));
+    size_t        i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cmpeq_epi8(v, g));  //相等为0xFF,否则为0
+    }
+    FillEqualScalar(src + i, dst + i, n - i, gray);
+}
+
+static void U8ToF32Sse2(const unsigned char* src, float* dst, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t        i    = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+    }
+    U8ToF32Scalar(src + i, dst + i, n - i);
+}
+
+static float MinF32Sse2(const float* src, size_t n, float init)
+{
+    ///_mm_min_ps(x, m)即 x < m ? x : m,与逐元素比较的取舍相同(NaN不会被选中)
+    __m128 m = _mm_set1_ps(init);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        m = _mm_min_ps(_mm_loadu_ps(src + i), m);
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, m);
+    float result = MinF32Scalar(lanes, 4, init);
+    result       = MinF32Scalar(src + i, n - i, result);
+
+    return MinFixZero(src, n, init, result);
+}
+
+static void SobelRowsSse2(const unsigned char* r0, const unsigned char* r1, const unsigned char* r2, short* v, short* d, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t        i    = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r0 + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r1 + i));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(r2 + i));
+
+        __m128i alo = _mm_unpacklo_epi8(a, zero), ahi = _mm_unpackhi_epi8(a, zero);
+        __m128i blo = _mm_unpacklo_epi8(b, zero), bhi = _mm_unpackhi_epi8(b, zero);
+        __m128i clo = _mm_unpacklo_epi8(c, zero), chi = _mm_unpackhi_epi8(c, zero);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i), _mm_add_epi16(_mm_add_epi16(alo, clo), _mm_slli_epi16(blo, 1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(v + i + 8), _mm_add_epi16(_mm_add_epi16(ahi, chi), _mm_slli_epi16(bhi, 1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_sub_epi16(clo, alo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i + 8), _mm_sub_epi16(chi, ahi));
+    }
+    SobelRowsScalar(r0 + i, r1 + i, r2 + i, v + i, d + i, n - i);
+}
+
+static __m128i AbsEpi16Sse2(__m128i x)
+{
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+///8个像素的round(sqrt(gx^2 + gy^2)),结果为int16
+static __m128i L2Epi16Sse2(__m128i gx, __m128i gy)
+{
+    __m128i lo = _mm_unpacklo_epi16(gx, gy);
+    __m128i hi = _mm_unpackhi_epi16(gx, gy);
+    __m128i rl = _mm_cvtps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo))));  //默认舍入模式为就近取偶,与lrintf相同
+    __m128i rh = _mm_cvtps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi))));
+    return _mm_packs_epi32(rl, rh);
+}
+
+static unsigned long long GradientRowSse2(const short* v, const short* d, size_t n, GradientMode mode, unsigned char* dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi8(1);
+    __m128i       acc  = _mm_setzero_si128();
+    size_t        i    = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i gx[2], gy[2];
+        for (int h = 0; h < 2; ++h)
+        {
+            const short* pv = v + i + 8 * h;
+            const short* pd = d + i + 8 * h;
+            __m128i      dl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pd - 1));
+            __m128i      dc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pd));
+            __m128i      dr = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pd + 1));
+
+            gx[h] = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pv + 1)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pv - 1)));
+            gy[h] = _mm_add_epi16(_mm_add_epi16(dl, dr), _mm_slli_epi16(dc, 1));
+        }
+
+        __m128i m;
+        if (mode == GRADIENT_L2)
+        {
+            m = _mm_packus_epi16(L2Epi16Sse2(gx[0], gy[0]), L2Epi16Sse2(gx[1], gy[1]));
+        }
+        else
+        {
+            __m128i axl = AbsEpi16Sse2(gx[0]), axh = AbsEpi16Sse2(gx[1]);
+            __m128i ayl = AbsEpi16Sse2(gy[0]), ayh = AbsEpi16Sse2(gy[1]);
+            if (mode == GRADIENT_L1)
+            {
+                m = _mm_packus_epi16(_mm_add_epi16(axl, ayl), _mm_add_epi16(axh, ayh));
+            }
+            else
+            {
+                __m128i ax = _mm_packus_epi16(axl, axh);
+                __m128i ay = _mm_packus_epi16(ayl, ayh);
+                if (mode == GRADIENT_OR)
+                {
+                    m = _mm_or_si128(ax, ay);
+                }
+                else
+                {
+                    ///avg = (a + b + 1) >> 1;和为奇数且avg为奇数时减一,即五成双
+                    __m128i avg = _mm_avg_epu8(ax, ay);
+                    m           = _mm_sub_epi8(avg, _mm_and_si128(_mm_and_si128(_mm_xor_si128(ax, ay), avg), one));
+                }
+            }
+        }
+
+        if (dst != NULL)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), m);
+        }
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(m, zero));
+    }
+
+    unsigned long long lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return lanes[0] + lanes[1] + GradientRowScalar(v + i, d + i, n - i, mode, dst != NULL ? dst + i : NULL);
+}
+
+// ---------------------------------------------------------------- AVX2
+
+__attribute__((target("avx2"))) static void FillEqualAvx2(const unsigned char* src, unsigned char* dst, size_t n, unsigned char gray)
+{
+    const __m256i g = _mm256_set1_epi8(static_cast<char>(gray));
+    size_t        i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cmpeq_epi8(v, g));
+    }
+    FillEqualScalar(src + i, dst + i, n - i, gray);
+}
+
+__attribute__((target("avx2"))) static void U8ToF32Avx2(const unsigned char* src, float* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(a)));
+        _mm256_storeu_ps(dst + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(a, 8))));
+        _mm256_storeu_ps(dst + i + 16, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(b)));
+        _mm256_storeu_ps(dst + i + 24, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(b, 8))));
+    }
+    U8ToF32Scalar(src + i, dst + i, n - i);
+}
+
+/**
+ * @brief LookupAvx2 查表项不超过16时,16个标签压成字节后用pshufb一次查出
+ */
+__attribute__((target("avx2"))) static void LookupAvx2(const int* labels, const unsigned char* lut, int lutSize, unsigned char* dst, size_t n)
+{
+    if (lutSize > LOOKUP_SHUFFLE_MAX)
+    {
+        LookupScalar(labels, lut, lutSize, dst, n);
+        return;
+    }
+
+    unsigned char table[16] = {0};
+    memcpy(table, lut, static_cast<size_t>(lutSize));
+    const __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i* p   = reinterpret_cast<const __m128i*>(labels + i);
+        __m128i        lo  = _mm_packs_epi32(_mm_loadu_si128(p), _mm_loadu_si128(p + 1));
+        __m128i        hi  = _mm_packs_epi32(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3));
+        __m128i        idx = _mm_packus_epi16(lo, hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(t, idx));
+    }
+    LookupScalar(labels + i, lut, lutSize, dst + i, n - i);
+}
+
+__attribute__((target("avx2"))) static float MinF32Avx2(const float* src, size_t n, float init)
+{
+    __m256 m = _mm256_set1_ps(init);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        m = _mm256_min_ps(_mm256_loadu_ps(src + i), m);
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, m);
+    float result = MinF32Scalar(lanes, 8, init);
+    result       = MinF32Scalar(src + i, n - i, result);
+
+    return MinFixZero(src, n, init, result);
+}
+
+#endif  // IMAGEKERNELS_X86
+
+#if defined(IMAGEKERNELS_NEON)
+
+// ---------------------------------------------------------------- NEON
+
+static void FillEqualNeon(const unsigned char* src, unsigned char* dst, size_t n, unsigned char gray)
+{
+    const uint8x16_t g = vdupq_n_u8(gray);
+    size_t           i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        vst1q_u8(dst + i, vceqq_u8(vld1q_u8(src + i), g));
+    }
+    FillEqualScalar(src + i, dst + i, n - i, gray);
+}
+
+static void U8ToF32Neon(const unsigned char* src, float* dst, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16_t v  = vld1q_u8(src + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+        vst1q_f32(dst + i + 8, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+        vst1q_f32(dst + i + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+    }
+    U8ToF32Scalar(src + i, dst + i, n - i);
+}
+
+static void LookupNeon(const int* labels, const unsigned char* lut, int lutSize, unsigned char* dst, size_t n)
+{
+    if (lutSize > LOOKUP_SHUFFLE_MAX)
+    {
+        LookupScalar(labels, lut, lutSize, dst, n);
+        return;
+    }
+
+    unsigned char table[16] = {0};
+    memcpy(table, lut, static_cast<size_t>(lutSize));
+    const uint8x16_t t = vld1q_u8(table);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        int16x8_t  lo  = vcombine_s16(vqmovn_s32(vld1q_s32(labels + i)), vqmovn_s32(vld1q_s32(labels + i + 4)));
+        int16x8_t  hi  = vcombine_s16(vqmovn_s32(vld1q_s32(labels + i + 8)), vqmovn_s32(vld1q_s32(labels + i + 12)));
+        uint8x16_t idx = vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi));
+        vst1q_u8(dst + i, vqtbl1q_u8(t, idx));
+    }
+    LookupScalar(labels + i, lut, lutSize, dst + i, n - i);
+}
+
+static float MinF32Neon(const float* src, size_t n, float init)
+{
+    ///vminq_f32遇到NaN会返回NaN,改用比较+选择,与逐元素比较一致
+    float32x4_t m = vdupq_n_f32(init);
+    size_t      i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t x = vld1q_f32(src + i);
+        m             = vbslq_f32(vcltq_f32(x, m), x, m);
+    }
+
+    float lanes[4];
+    vst1q_f32(lanes, m);
+    float result = MinF32Scalar(lanes, 4, init);
+    result       = MinF32Scalar(src + i, n - i, result);
+
+    return MinFixZero(src, n, init, result);
+}
+
+static void SobelRowsNeon(const unsigned char* r0, const unsigned char* r1, const unsigned char* r2, short* v, short* d, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        uint8x16_t a = vld1q_u8(r0 + i);
+        uint8x16_t b = vld1q_u8(r1 + i);
+        uint8x16_t c = vld1q_u8(r2 + i);
+
+        vst1q_s16(v + i, vreinterpretq_s16_u16(vaddq_u16(vaddl_u8(vget_low_u8(a), vget_low_u8(c)), vshll_n_u8(vget_low_u8(b), 1))));
+        vst1q_s16(v + i + 8, vreinterpretq_s16_u16(vaddq_u16(vaddl_u8(vget_high_u8(a), vget_high_u8(c)), vshll_n_u8(vget_high_u8(b), 1))));
+        vst1q_s16(d + i, vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(c), vget_low_u8(a))));
+        vst1q_s16(d + i + 8, vreinterpretq_s16_u16(vsubl_u8(vget_high_u8(c), vget_high_u8(a))));
+    }
+    SobelRowsScalar(r0 + i, r1 + i, r2 + i, v + i, d + i, n - i);
+}
+
+static int16x8_t L2S16Neon(int16x8_t gx, int16x8_t gy)
+{
+    int32x4_t lo = vmlal_s16(vmull_s16(vget_low_s16(gx), vget_low_s16(gx)), vget_low_s16(gy), vget_low_s16(gy));
+    int32x4_t hi = vmlal_s16(vmull_s16(vget_high_s16(gx), vget_high_s16(gx)), vget_high_s16(gy), vget_high_s16(gy));
+    int32x4_t rl = vcvtnq_s32_f32(vsqrtq_f32(vcvtq_f32_s32(lo)));
+    int32x4_t rh = vcvtnq_s32_f32(vsqrtq_f32(vcvtq_f32_s32(hi)));
+    return vcombine_s16(vqmovn_s32(rl), vqmovn_s32(rh));
+}
+
+static unsigned long long GradientRowNeon(const short* v, const short* d, size_t n, GradientMode mode, unsigned char* dst)
+{
+    const uint8x16_t   one = vdupq_n_u8(1);
+    unsigned long long sum = 0;
+    size_t             i   = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        int16x8_t gx[2], gy[2];
+        for (int h = 0; h < 2; ++h)
+        {
+            const short* pv = v + i + 8 * h;
+            const short* pd = d + i + 8 * h;
+
+            gx[h] = vsubq_s16(vld1q_s16(pv + 1), vld1q_s16(pv - 1));
+            gy[h] = vaddq_s16(vaddq_s16(vld1q_s16(pd - 1), vld1q_s16(pd + 1)), vshlq_n_s16(vld1q_s16(pd), 1));
+        }
+
+        uint8x16_t m;
+        if (mode == GRADIENT_L2)
+        {
+            m = vcombine_u8(vqmovun_s16(L2S16Neon(gx[0], gy[0])), vqmovun_s16(L2S16Neon(gx[1], gy[1])));
+        }
+        else
+        {
+            int16x8_t axl = vabsq_s16(gx[0]), axh = vabsq_s16(gx[1]);
+            int16x8_t ayl = vabsq_s16(gy[0]), ayh = vabsq_s16(gy[1]);
+            if (mode == GRADIENT_L1)
+            {
+                m = vcombine_u8(vqmovun_s16(vaddq_s16(axl, ayl)), vqmovun_s16(vaddq_s16(axh, ayh)));
+            }
+            else
+            {
+                uint8x16_t ax = vcombine_u8(vqmovun_s16(axl), vqmovun_s16(axh));
+                uint8x16_t ay = vcombine_u8(vqmovun_s16(ayl), vqmovun_s16(ayh));
+                if (mode == GRADIENT_OR)
+                {
+                    m = vorrq_u8(ax, ay);
+                }
+                else
+                {
+                    uint8x16_t avg = vrhaddq_u8(ax, ay);
+                    m              = vsubq_u8(avg, vandq_u8(vandq_u8(veorq_u8(ax, ay), avg), one));
+                }
+            }
+        }
+
+        if (dst != NULL)
+        {
+            vst1q_u8(dst + i, m);
+        }
+        sum += vaddlvq_u8(m);
+    }
+
+    return sum + GradientRowScalar(v + i, d + i, n - i, mode, dst != NULL ? dst + i : NULL);
+}
+
+#endif  // IMAGEKERNELS_NEON
+
+static const ImageKernels scalarKernels = {SIMD_SCALAR, "scalar", FillEqualScalar, U8ToF32Scalar, LookupScalar, MinF32Scalar, CopyBgrScalar, SobelRowsScalar, GradientRowScalar};
+
+#if defined(IMAGEKERNELS_X86)
+static const ImageKernels sse2Kernels = {SIMD_SSE2, "sse2", FillEqualSse2, U8ToF32Sse2, LookupScalar, MinF32Sse2, CopyBgrRows, SobelRowsSse2, GradientRowSse2};
+///梯度部分以16个像素为单位做饱和打包,256位的打包指令按128位分道交错,收益不大,沿用SSE2版本
+static const ImageKernels avx2Kernels = {SIMD_AVX2, "avx2", FillEqualAvx2, U8ToF32Avx2, LookupAvx2, MinF32Avx2, CopyBgrRows, SobelRowsSse2, GradientRowSse2};
+#endif
+#if defined(IMAGEKERNELS_NEON)
+static const ImageKernels neonKernels = {SIMD_NEON, "neon", FillEqualNeon, U8ToF32Neon, LookupNeon, MinF32Neon, CopyBgrRows, SobelRowsNeon, GradientRowNeon};
+#endif
+
+/**
+ * @brief KernelsFor 指定指令集的实现
+ * @return           本机(编译目标或CPU)不支持时返回NULL
+ */
+const ImageKernels* KernelsFor(SimdLevel level)
+{
+    switch (level)
+    {
+    case SIMD_SCALAR:
+        return &scalarKernels;
+#if defined(IMAGEKERNELS_X86)
+    case SIMD_SSE2:
+        return &sse2Kernels;
+    case SIMD_AVX2:
+        return __builtin_cpu_supports("avx2") ? &avx2Kernels : NULL;
+#endif
+#if defined(IMAGEKERNELS_NEON)
+    case SIMD_NEON:
+        return &neonKernels;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+static const ImageKernels* SelectKernels()
+{
+    const char* forced = getenv("IMAGETOOLS_SIMD");
+    if (forced != NULL)
+    {
+        const SimdLevel levels[] = {SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2, SIMD_NEON};
+        for (SimdLevel level : levels)
+        {
+            const ImageKernels* kernels = KernelsFor(level);
+            if (kernels != NULL && strcmp(forced, kernels->name) == 0)
+            {
+                return kernels;
+            }
+        }
+    }
+
+    const SimdLevel preferred[] = {SIMD_AVX2, SIMD_NEON, SIMD_SSE2};
+    for (SimdLevel level : preferred)
+    {
+        const ImageKernels* kernels = KernelsFor(level);
+        if (kernels != NULL)
+        {
+            return kernels;
+        }
+    }
+
+    return &scalarKernels;
+}
+
+/**
+ * @brief BestKernels 本机可用的最快实现,第一次调用时选定
+ */
+const ImageKernels& BestKernels()
+{
+    static const ImageKernels* kernels = SelectKernels();
+    return *kernels;
+}
@@ -0,0 +1,57 @@
+#ifndef IMAGEKERNELS_H
+#define IMAGEKERNELS_H
+
+#include <stddef.h>
+
+/**
+ * 逐像素循环的向量化实现
+ * 每个函数都有逐元素的标量版本与SIMD版本,两者结果逐位一致;运行时按CPU支持的指令集选择一次。
+ * x86-64:SSE2(所有CPU都支持)/AVX2(运行时检测,由target属性单独编译,不需要改编译选项);aarch64:NEON。
+ * 环境变量IMAGETOOLS_SIMD=scalar|sse2|avx2|neon可强制使用指定的实现(不支持时退回自动选择),用于对比与排查
+ */
+
+enum SimdLevel
+{
+    SIMD_SCALAR = 0,
+    SIMD_SSE2   = 1,
+    SIMD_AVX2   = 2,
+    SIMD_NEON   = 3
+};
+
+///梯度幅值的合成方式,Gx/Gy为3x3 Sobel结果
+enum GradientMode
+{
+    GRADIENT_OR      = 0,  ///<sat(|Gx|) | sat(|Gy|),与convertScaleAbs + bitwise_or相同
+    GRADIENT_AVERAGE = 1,  ///<(sat(|Gx|) + sat(|Gy|)) / 2,四舍六入五成双,与convertScaleAbs + addWeighted(0.5, 0.5)相同
+    GRADIENT_L1      = 2,  ///<sat(|Gx| + |Gy|)
+    GRADIENT_L2      = 3   ///<sat(round(sqrt(Gx^2 + Gy^2)))
+};
+
+typedef struct
+{
+    SimdLevel   level;
+    const char* name;
+
+    ///dst[i] = src[i] == gray ? 255 : 0
+    void (*fillEqual)(const unsigned char* src, unsigned char* dst, size_t n, unsigned char gray);
+    ///u8ToF32/lookup/minF32:KMeans改为在直方图上聚类(HistKMeans)后不再调用,只服务于公开的ImageTool::KMeansToGray
+    ///与私有的GrayToFloat32/GetMingGray,保留SIMD版本供这些接口的调用者及ImageBench对比使用
+    ///dst[i] = (float)src[i]
+    void (*u8ToF32)(const unsigned char* src, float* dst, size_t n);
+    ///dst[i] = lut[labels[i]],要求0 <= labels[i] < lutSize
+    void (*lookup)(const int* labels, const unsigned char* lut, int lutSize, unsigned char* dst, size_t n);
+    ///从init开始依次取更小的值(与 if (min > x) min = x 相同,忽略NaN)
+    float (*minF32)(const float* src, size_t n, float init);
+    ///复制rows行、每行cols个BGR像素,两端的行步长可以不同
+    void (*copyBgr)(const unsigned char* src, size_t srcStep, unsigned char* dst, size_t dstStep, int rows, int cols);
+    ///Sobel的竖直部分:v[i] = r0[i] + 2 * r1[i] + r2[i], d[i] = r2[i] - r0[i],r0/r1/r2为相邻三行
+    void (*sobelRows)(const unsigned char* r0, const unsigned char* r1, const unsigned char* r2, short* v, short* d, size_t n);
+    ///Sobel的水平部分并合成幅值:Gx = v[i+1] - v[i-1], Gy = d[i-1] + 2 * d[i] + d[i+1],要求v/d的下标-1与n可访问;
+    ///dst为NULL时只求和,返回本行幅值之和
+    unsigned long long (*gradientRow)(const short* v, const short* d, size_t n, GradientMode mode, unsigned char* dst);
+} ImageKernels;
+
+const ImageKernels& BestKernels();
+const ImageKernels* KernelsFor(SimdLevel level);
+
+#endif  // IMAGEKERNELS_H
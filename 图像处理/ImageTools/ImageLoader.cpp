@@ -0,0 +1,184 @@
+#include "ImageLoader.h"
+#include "opencv4/opencv2/imgcodecs.hpp"
+#include "opencv4/opencv2/imgproc.hpp"
+
+#include <chrono>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief ReadAll 把文件读入本线程的复用缓冲区
+ * @return 缓冲区,失败时返回NULL
+ */
+static const unsigned char* ReadAll(int fd, size_t size)
+{
+    static thread_local std::vector<unsigned char> buffer;
+    if (buffer.size() < size)
+    {
+        buffer.resize(size);
+    }
+
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = pread(fd, buffer.data() + done, size - done, static_cast<off_t>(done));
+        if (n <= 0)
+        {
+            return NULL;
+        }
+        done += static_cast<size_t>(n);
+    }
+
+    return buffer.data();
+}
+
+/**
+ * @brief Decode 解码到dst
+ * @note IMREAD_UNCHANGED没有对应的缩小标志,先解码到本线程的中间图,再缩小到dst
+ */
+static bool Decode(const cv::Mat& buf, int flags, const DecodeOptions& options, cv::Mat& dst)
+{
+    if (options.color == DECODE_UNCHANGED && options.scale > 1)
+    {
+        static thread_local cv::Mat full;
+        cv::imdecode(buf, flags, &full);
+        if (full.empty())
+        {
+            return false;
+        }
+
+        cv::Size size((full.cols + options.scale - 1) / options.scale, (full.rows + options.scale - 1) / options.scale);
+        cv::resize(full, dst, size, 0, 0, cv::INTER_AREA);
+        return true;
+    }
+
+    cv::imdecode(buf, flags, &dst);
+    return !dst.empty();
+}
+
+/**
+ * @brief DecodeImage 解码内存中的图像文件内容
+ * @param data 文件内容
+ * @param size 字节数
+ * @param dst 输出
+ * @param options 颜色与缩小倍数
+ * @param stats 非NULL时输出解码耗时与字节数(ioNs置0,由调用方填写)
+ * @param reuse 同LoadImage
+ * @return 选项不合法或解码失败时返回false;reuse为false时dst不被修改,为true时dst可能已被释放
+ */
+bool DecodeImage(const unsigned char* data, size_t size, cv::Mat& dst, const DecodeOptions& options, LoadStats* stats, bool reuse)
+{
+    int flags = DecodeFlags(options);
+    if (flags == -1 || data == NULL || size == 0 || size > INT_MAX)
+    {
+        return false;
+    }
+
+    int64_t start    = NowNs();
+    uchar*  previous = reuse ? dst.data : NULL;
+
+    ///imdecode只读取缓冲区,const_cast仅为构造Mat头
+    cv::Mat buf(1, static_cast<int>(size), CV_8UC1, const_cast<unsigned char*>(data));
+    bool    result;
+    if (reuse)
+    {
+        result = Decode(buf, flags, options, dst);
+    }
+    else
+    {
+        cv::Mat fresh;
+        result = Decode(buf, flags, options, fresh);
+        if (result)
+        {
+            dst = fresh;
+        }
+    }
+
+    if (stats != NULL)
+    {
+        stats->ioNs     = 0;
+        stats->decodeNs = NowNs() - start;
+        stats->bytes    = size;
+        stats->reused   = result && previous != NULL && dst.data == previous;
+    }
+
+    return result;
+}
+
+/**
+ * @brief LoadImage 加载并解码一幅图像
+ * @param path 文件路径
+ * @param dst 输出
+ * @param options 颜色与缩小倍数
+ * @param mode 读取方式
+ * @param stats 非NULL时输出计时
+ * @param reuse 为true时解码到dst原有的内存(尺寸、类型相同时),与dst共享数据的Mat会被覆盖;为false时总是新分配
+ * @return 文件打不开、选项不合法或解码失败时返回false;reuse为false时dst不被修改,为true时dst可能已被释放
+ */
+bool LoadImage(const char* path, cv::Mat& dst, const DecodeOptions& options, LoadMode mode, LoadStats* stats, bool reuse)
+{
+    if (DecodeFlags(options) == -1)
+    {
+        return false;
+    }
+
+    int64_t start = NowNs();
+    int     fd    = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size > INT_MAX)
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t               size   = static_cast<size_t>(st.st_size);
+    const unsigned char* data   = NULL;
+    void*                mapped = MAP_FAILED;
+    if (mode == LOAD_MMAP)
+    {
+        mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            data = static_cast<const unsigned char*>(mapped);
+        }
+    }
+    else
+    {
+        data = ReadAll(fd, size);
+    }
+    close(fd);
+
+    if (data == NULL)
+    {
+        return false;
+    }
+
+    int64_t loaded = NowNs();
+    bool    result = DecodeImage(data, size, dst, options, stats, reuse);
+
+    if (mapped != MAP_FAILED)
+    {
+        munmap(mapped, size);
+    }
+
+    if (stats != NULL)
+    {
+        stats->ioNs = loaded - start;
+    }
+
+    return result;
+}
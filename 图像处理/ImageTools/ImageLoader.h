@@ -0,0 +1,38 @@
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include "ImageDecode.h"
+#include "opencv4/opencv2/core.hpp"
+
+#include <stdint.h>
+
+/**
+ * 无复制的图像加载
+ * 文件内容不经过QByteArray/std::vector,直接交给imdecode:
+ *   LOAD_READ:读入本线程的复用缓冲区(只增不减),批量加载时不再反复分配;
+ *   LOAD_MMAP:映射文件(MAP_POPULATE,映射时即完成读取),适合大文件,省去一次内核到用户态的复制。
+ * 默认每次解码到新分配的Mat,失败时不修改dst(原OpenImage在文件能打开但解码失败时会把image置为空),调用方保留的浅拷贝不受影响;
+ * reuse为true时解码写入dst原有的内存(尺寸与类型相同时,imdecode的dst参数),批量加载同尺寸图像时输出也不再分配,
+ * 但与dst共享数据的其他Mat(浅拷贝、包装外部缓冲区的Mat)会被覆盖,失败时dst可能已被释放,只在确认dst独占内存时使用。
+ * 读取与解码分别计时,便于判断瓶颈在磁盘还是解码。
+ * DecodeImage只做解码,用于已在内存中的内容(如Qt资源文件)
+ */
+
+enum LoadMode
+{
+    LOAD_READ = 0,
+    LOAD_MMAP = 1
+};
+
+typedef struct
+{
+    int64_t ioNs;      ///<打开、读取(或映射)文件的时间
+    int64_t decodeNs;  ///<解码(含缩小)的时间
+    size_t  bytes;     ///<文件大小
+    bool    reused;    ///<是否解码到了调用方原有的内存中
+} LoadStats;
+
+bool DecodeImage(const unsigned char* data, size_t size, cv::Mat& dst, const DecodeOptions& options, LoadStats* stats = NULL, bool reuse = false);
+bool LoadImage(const char* path, cv::Mat& dst, const DecodeOptions& options, LoadMode mode = LOAD_READ, LoadStats* stats = NULL, bool reuse = false);
+
+#endif  // IMAGELOADER_H
@@ -1,4 +1,9 @@
 #include "ImageTools.h"
+#include "Gradient.h"
+#include "HistKMeans.h"
+#include "ImageKernels.h"
+
+#include <QElapsedTimer>
 
 ImageTool::ImageTool() {}
 
@@ -56,9 +61,16 @@ void ImageTool::Open(const cv::Mat& src, cv::Mat& dst, int param)
  * @brief ImageTool::Sobel Sobel算子
  * @param src 原图像
  * @param dst 结果图
+ * @note 8位灰度图走单遍的int16梯度(Gradient),结果与下面的多遍实现一致
  */
 void ImageTool::Sobel(const cv::Mat& src, cv::Mat& dst)
 {
+    if (src.type() == CV_8UC1)
+    {
+        GradientMagnitude(src, dst, GRADIENT_OR);
+        return;
+    }
+
     cv::Mat sobelx;
     cv::Mat sobelAbsGradx;
     cv::Sobel(src, sobelx, CV_64F, 1, 0);
@@ -74,23 +86,28 @@ void ImageTool::Sobel(const cv::Mat& src, cv::Mat& dst)
 
 /**
  * @brief ImageTool::KMeans K聚类
- * @param src 原图像
+ * @param src 原图像(8位灰度)
  * @param dst 结果图
  * @param clusterCount 聚类的类别数
+ * @note 在灰度直方图上求精确的一维K聚类(HistKMeans),再用查找表得到聚类灰度图,
+ *       不再为每个像素生成浮点样本和标签
  */
 void ImageTool::KMeans(const cv::Mat& src, cv::Mat& dst, int clusterCount)
 {
-    cv::Mat samples(src.cols * src.rows, 1, CV_32FC1);
-    this->GrayToFloat32(src, samples);
+    uint64_t hist[HIST_BINS];
+    GrayHistogram(src, hist);
 
-    cv::Mat labels(src.cols * src.rows, 1, CV_32FC1);
-    cv::Mat centers(clusterCount, 1, samples.type());
-    cv::kmeans(samples, clusterCount, labels, cv::TermCriteria(TermCriteria::EPS + TermCriteria::COUNT, 10, 1.0), 3, cv::KMEANS_PP_CENTERS, centers);
+    HistKMeansResult km;
+    if (!HistKMeans(hist, clusterCount, km))
+    {
+        dst = cv::Mat::zeros(src.size(), CV_8UC1);
+        return;
+    }
 
-    cv::Mat kmImage(src.size(), src.type());
-    this->KMeansToGray(labels, centers, kmImage);
+    cv::Mat kmImage;
+    cv::LUT(src, cv::Mat(1, HIST_BINS, CV_8UC1, km.lut), kmImage);
 
-    uchar minGray = static_cast<uchar>(this->GetMingGray(centers));
+    uchar minGray = static_cast<uchar>(km.centers[0]);
 
     cv::Mat mdImage;
     cv::medianBlur(kmImage, mdImage, 5);
@@ -140,21 +157,17 @@ void ImageTool::RiddlerCalvard(const cv::Mat& src, cv::Mat& dst)
  */
 void ImageTool::FillImageByOneGray(const cv::Mat& src, cv::Mat& dst, uchar gray)
 {
+    const ImageKernels& kernels = BestKernels();
+
+    if (src.isContinuous() && dst.isContinuous())
+    {
+        kernels.fillEqual(src.ptr<uchar>(0), dst.ptr<uchar>(0), src.total(), gray);
+        return;
+    }
+
     for (int i = 0; i < src.rows; ++i)
     {
-        const uchar* idata = src.ptr<uchar>(i);
-        uchar*       pdata = dst.ptr<uchar>(i);
-        for (int j = 0; j < src.cols; ++j)
-        {
-            if (gray != idata[j])
-            {
-                pdata[j] = 0;
-            }
-            else
-            {
-                pdata[j] = 255;
-            }
-        }
+        kernels.fillEqual(src.ptr<uchar>(i), dst.ptr<uchar>(i), static_cast<size_t>(src.cols), gray);
     }
 }
 
@@ -165,14 +178,12 @@ void ImageTool::FillImageByOneGray(const cv::Mat& src, cv::Mat& dst, uchar gray)
  */
 void ImageTool::GrayToFloat32(const cv::Mat& src, cv::Mat& dst)
 {
+    const ImageKernels& kernels = BestKernels();
+    float*              pdata   = dst.ptr<float>(0);
+
     for (int i = 0; i < src.rows; ++i)
     {
-        const uchar* idata = src.ptr<uchar>(i);
-        float*       pdata = dst.ptr<float>(0);
-        for (int j = 0; j < src.cols; ++j)
-        {
-            pdata[i * src.cols + j] = idata[j];
-        }
+        kernels.u8ToF32(src.ptr<uchar>(i), pdata + static_cast<size_t>(i) * src.cols, static_cast<size_t>(src.cols));
     }
 }
 
@@ -181,20 +192,24 @@ void ImageTool::GrayToFloat32(const cv::Mat& src, cv::Mat& dst)
  * @param labels
  * @param centers
  * @param dst
+ * @note 先把每个聚类中心转成灰度得到查找表,逐像素只剩一次查表
  */
 void ImageTool::KMeansToGray(const cv::Mat& labels, const cv::Mat& centers, cv::Mat& dst)
 {
-    const float* centerData = centers.ptr<float>(0);
+    const ImageKernels& kernels    = BestKernels();
+    const float*        centerData = centers.ptr<float>(0);
+    int                 lutSize    = static_cast<int>(centers.total());
 
+    vector<uchar> lut(static_cast<size_t>(lutSize));
+    for (int k = 0; k < lutSize; ++k)
+    {
+        lut[k] = static_cast<uchar>(centerData[k]);
+    }
+
+    const int* srcRow = labels.ptr<int>(0);
     for (int i = 0; i < dst.rows; ++i)
     {
-        const int* srcRow = labels.ptr<int>(0);
-        uchar*     dstRow = dst.ptr<uchar>(i);
-        for (int j = 0; j < dst.cols; ++j)
-        {
-            float gray = centerData[srcRow[i * dst.cols + j]];
-            dstRow[j]  = static_cast<uchar>(gray);
-        }
+        kernels.lookup(srcRow + static_cast<size_t>(i) * dst.cols, lut.data(), lutSize, dst.ptr<uchar>(i), static_cast<size_t>(dst.cols));
     }
 }
 
@@ -205,18 +220,12 @@ void ImageTool::KMeansToGray(const cv::Mat& labels, const cv::Mat& centers, cv::
  */
 float ImageTool::GetMingGray(const cv::Mat& mat)
 {
+    const ImageKernels& kernels = BestKernels();
+
     float min = 255;
     for (int i = 0; i < mat.rows; ++i)
     {
-        const float* idata = mat.ptr<float>(i);
-
-        for (int j = 0; j < mat.cols; ++j)
-        {
-            if (min > idata[j])
-            {
-                min = idata[j];
-            }
-        }
+        min = kernels.minF32(mat.ptr<float>(i), static_cast<size_t>(mat.cols), min);
     }
 
     return min;
@@ -241,53 +250,105 @@ void ImageTool::PrintMat(const cv::Mat& mat)
     }
 }
 
+/**
+ * @brief ImageTool::WrapBuf 把BGR缓存区包装成图片,不复制
+ * @param buf 缓存区,需在dst使用期间有效
+ * @param rows 行
+ * @param cols 列
+ * @param dst 结果图,与buf共享数据
+ * @param step 行步长(字节),0表示行间无填充
+ * @return 布局不合法时返回false,dst不变
+ * @note 需要接管缓冲区所有权(如帧用完后还给驱动)时使用ImageBuffer::Adopt
+ */
+bool ImageTool::WrapBuf(unsigned char* buf, int rows, int cols, cv::Mat& dst, size_t step)
+{
+    bool result = false;
+    if (ImageBuffer::CheckLayout(buf, rows, cols, CV_8UC3, step))
+    {
+        dst    = cv::Mat(rows, cols, CV_8UC3, buf, step);
+        result = true;
+    }
+
+    return result;
+}
+
+/**
+ * @brief BufOverlaps Mat的数据区是否与BGR缓存区有重叠
+ * @param step 缓存区行步长,已由CheckLayout确定
+ */
+static bool BufOverlaps(const cv::Mat& mat, const unsigned char* buf, int rows, int cols, size_t step)
+{
+    if (mat.empty())
+    {
+        return false;
+    }
+
+    const unsigned char* bufEnd = buf + static_cast<size_t>(rows - 1) * step + static_cast<size_t>(cols) * 3;
+    return mat.datastart < bufEnd && buf < mat.dataend;
+}
+
 /**
  * @brief ImageTool::BufToMat 读取缓存区图片
  * @param buf 缓存区
  * @param rows 行
  * @param cols 列
- * @param dst 结果图
+ * @param dst 结果图,尺寸或类型不符时重新分配
+ * @param step 缓存区行步长(字节),0表示行间无填充
+ * @note dst已经是buf的包装(WrapBuf)且步长相同时不复制;dst与buf有其他重叠(步长不同、是其中一部分)时
+ *       改为复制到新分配的图,不写入buf
  */
-void ImageTool::BufToMat(const unsigned char* buf, int rows, int cols, cv::Mat& dst)
+void ImageTool::BufToMat(const unsigned char* buf, int rows, int cols, cv::Mat& dst, size_t step)
 {
-    for (int i = 0; i < rows; ++i)
+    if (!ImageBuffer::CheckLayout(buf, rows, cols, CV_8UC3, step))
     {
-        uchar* idata = dst.ptr<uchar>(i);
+        return;
+    }
 
-        for (int j = 0; j < cols; ++j)
-        {
-            int index        = i * cols + j;
-            idata[3 * j]     = buf[3 * index];
-            idata[3 * j + 1] = buf[3 * index + 1];
-            idata[3 * j + 2] = buf[3 * index + 2];
-        }
+    if (dst.data == buf && dst.rows == rows && dst.cols == cols && dst.type() == CV_8UC3 && dst.step == step)
+    {
+        return;
+    }
+
+    if (BufOverlaps(dst, buf, rows, cols, step))
+    {
+        cv::Mat fresh(rows, cols, CV_8UC3);
+        BestKernels().copyBgr(buf, step, fresh.ptr<uchar>(0), fresh.step, rows, cols);
+        dst = fresh;
+        return;
     }
+
+    dst.create(rows, cols, CV_8UC3);
+    BestKernels().copyBgr(buf, step, dst.ptr<uchar>(0), dst.step, rows, cols);
 }
 
 /**
  * @brief ImageTool::MatToBuf 图片存入缓存区
- * @param src 输入图
+ * @param src 输入图,需为CV_8UC3
  * @param buf 缓存区
  * @param rows 行
  * @param cols 列
- * @return
+ * @param step 缓存区行步长(字节),0表示行间无填充
+ * @return 尺寸、类型或缓存区布局不符时返回false
+ * @note src是buf的包装(WrapBuf)且步长相同时不复制;src与buf有其他重叠时先复制到临时图
  */
-bool ImageTool::MatToBuf(const cv::Mat& src, unsigned char* buf, int rows, int cols)
+bool ImageTool::MatToBuf(const cv::Mat& src, unsigned char* buf, int rows, int cols, size_t step)
 {
     bool result = false;
-    if (src.rows == rows && src.cols == cols)
+    if (src.rows == rows && src.cols == cols && src.type() == CV_8UC3 && ImageBuffer::CheckLayout(buf, rows, cols, CV_8UC3, step))
     {
-        for (int i = 0; i < rows; ++i)
+        if (src.data == buf && src.step == step)
+        {
+            return true;
+        }
+
+        if (BufOverlaps(src, buf, rows, cols, step))
         {
-            const uchar* idata = src.ptr<uchar>(i);
-
-            for (int j = 0; j < cols; ++j)
-            {
-                int index          = i * cols + j;
-                buf[3 * index]     = idata[3 * j];
-                buf[3 * index + 1] = idata[3 * j + 1];
-                buf[3 * index + 2] = idata[3 * j + 2];
-            }
+            cv::Mat temp = src.clone();
+            BestKernels().copyBgr(temp.ptr<uchar>(0), temp.step, buf, step, rows, cols);
+        }
+        else
+        {
+            BestKernels().copyBgr(src.ptr<uchar>(0), src.step, buf, step, rows, cols);
         }
 
         result = true;
@@ -373,17 +434,79 @@ void ImageTool::ToPoints(int* points, int pointsNum, vector<cv::Point>& edge)
  */
 void ImageTool::OpenImage(const QString& fileName, cv::Mat& image)
 {
+    this->OpenImage(fileName, image, DefaultDecodeOptions());
+}
+
+/**
+ * @brief ImageTool::OpenImage 按指定颜色与缩小倍数解码
+ * @param fileName 文件名
+ * @param image 图像,每次解码到新分配的内存
+ * @param options 解码选项,如{DECODE_GRAY, 4}直接得到1/4尺寸的灰度图
+ * @param stats 非NULL时输出读取与解码各自的耗时
+ * @return 文件打不开、选项不合法或解码失败时返回false,此时image不被修改
+ * @note JPEG的缩小在IDCT阶段完成,比解码后再ToGray/resize快数倍;可先用ProbeImage与ScaleFor选择倍数。
+ *       文件读入本线程复用的缓冲区后直接解码(LoadImage),不再经过QByteArray和std::vector两次复制;
+ *       Qt资源(":/...")不在文件系统上,仍经QFile读入后解码;需要复用输出内存时直接调用LoadImage(..., reuse = true)
+ */
+bool ImageTool::OpenImage(const QString& fileName, cv::Mat& image, const DecodeOptions& options, LoadStats* stats)
+{
+    if (fileName.startsWith(QLatin1Char(':')))
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QFile file(fileName);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+        QByteArray bytes = file.readAll();
+        file.close();
+
+        qint64 ioNs   = timer.nsecsElapsed();
+        bool   result = DecodeImage(reinterpret_cast<const unsigned char*>(bytes.constData()), static_cast<size_t>(bytes.size()), image, options, stats);
+        if (stats != NULL)
+        {
+            stats->ioNs = ioNs;
+        }
+
+        return result;
+    }
+
+    ///与QFile解析路径的方式一致
+    return LoadImage(QFile::encodeName(fileName).constData(), image, options, LOAD_READ, stats);
+}
+
+static size_t ReadFileAt(void* ctx, size_t offset, unsigned char* dst, size_t n)
+{
+    QFile* file = static_cast<QFile*>(ctx);
+    if (!file->seek(static_cast<qint64>(offset)))
+    {
+        return 0;
+    }
+
+    qint64 count = file->read(reinterpret_cast<char*>(dst), static_cast<qint64>(n));
+    return count > 0 ? static_cast<size_t>(count) : 0;
+}
+
+/**
+ * @brief ImageTool::ProbeImage 只读取文件头,取图像尺寸与通道数
+ * @param fileName 文件名
+ * @param info 输出
+ * @return 文件打不开或格式不支持(JPEG/PNG/BMP以外)时返回false
+ * @note JPEG逐段跳到SOF,只读取段头与EXIF,不读取压缩数据
+ */
+bool ImageTool::ProbeImage(const QString& fileName, ImageInfo& info)
+{
+    bool  result = false;
     QFile file(fileName);
     if (file.open(QIODevice::ReadOnly))
     {
-        QByteArray        byteArray = file.readAll();
-        std::vector<char> data(byteArray.data(), byteArray.data() + byteArray.size());
-        image = cv::imdecode(cv::Mat(data), 1);
-
+        result = ::ProbeImage(ReadFileAt, &file, info);
         file.close();
     }
 
-    //    cv::resize(image, image, cv::Size(1500, 1000));
+    return result;
 }
 
 /**
@@ -411,28 +534,18 @@ void ImageTool::SaveImage(const QString& fileName, const cv::Mat& image)
 
 /**
  * @brief ImageTool::CalcTenengrad 计算图像清晰度
- * @param image 图像
+ * @param image 图像,灰度图不再转换
  * @return
+ * @note 分块、ROI、其他清晰度度量与批量排序见FocusMeasure
  */
 double ImageTool::CalcTenengrad(const cv::Mat& image)
 {
-    cv::Mat grayImage;
-    this->ToGray(image, grayImage);
-
-    cv::Mat sobelx;
-    cv::Mat sobelAbsGradx;
-    cv::Sobel(grayImage, sobelx, CV_64F, 1, 0);
-    cv::convertScaleAbs(sobelx, sobelAbsGradx);
-
-    cv::Mat sobely;
-    cv::Mat sobelAbsGrady;
-    cv::Sobel(grayImage, sobely, CV_64F, 0, 1);
-    cv::convertScaleAbs(sobely, sobelAbsGrady);
-
-    cv::Mat weightedDst;
-    cv::addWeighted(sobelAbsGradx, 0.5, sobelAbsGrady, 0.5, 0, weightedDst);
-
-    double meas = cv::mean(weightedDst)[0];
+    cv::Mat grayImage = image;
+    if (image.type() != CV_8UC1)
+    {
+        this->ToGray(image, grayImage);
+    }
 
-    return meas;
+    ///(|Gx| + |Gy|) / 2的均值,单遍计算,不生成中间图像
+    return GradientScore(grayImage, GRADIENT_AVERAGE);
 }
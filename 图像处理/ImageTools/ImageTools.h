@@ -9,6 +9,10 @@
 #include <QFileInfo>
 #include <QTextCodec>
 
+#include "ImageBuffer.h"
+#include "ImageDecode.h"
+#include "ImageLoader.h"
+
 #define MAX_EDGE_POINT_NUM 65535
 
 using namespace std;
@@ -37,11 +41,14 @@ public:
 
     // type transfer
     void ToPoints(int* points, int pointsNum, vector<cv::Point>& edge);
-    void BufToMat(const unsigned char* buf, int rows, int cols, cv::Mat& dst);
-    bool MatToBuf(const cv::Mat& src, unsigned char* buf, int rows, int cols);
+    bool WrapBuf(unsigned char* buf, int rows, int cols, cv::Mat& dst, size_t step = 0);
+    void BufToMat(const unsigned char* buf, int rows, int cols, cv::Mat& dst, size_t step = 0);
+    bool MatToBuf(const cv::Mat& src, unsigned char* buf, int rows, int cols, size_t step = 0);
 
     // file operations
     void OpenImage(const QString& fileName, cv::Mat& image);
+    bool OpenImage(const QString& fileName, cv::Mat& image, const DecodeOptions& options, LoadStats* stats = NULL);
+    bool ProbeImage(const QString& fileName, ImageInfo& info);
     void SaveImage(const QString& fileName, const cv::Mat& image);
 
     double CalcTenengrad(const cv::Mat& image);
@@ -22,10 +22,24 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+        FocusMeasure.cpp \
+        Gradient.cpp \
+        HistKMeans.cpp \
+        ImageBuffer.cpp \
+        ImageDecode.cpp \
+        ImageKernels.cpp \
+        ImageLoader.cpp \
         ImageTools.cpp \
         main.cpp
 
 HEADERS += \
+    FocusMeasure.h \
+    Gradient.h \
+    HistKMeans.h \
+    ImageBuffer.h \
+    ImageDecode.h \
+    ImageKernels.h \
+    ImageLoader.h \
     ImageTools.h
 
 # Default rules for deployment.